@@ -0,0 +1,262 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "chunkqueue.h"
+
+#include <QMutexLocker>
+#include <algorithm>
+#include <cstdio>
+#ifdef Q_OS_WIN
+#include <windows.h>
+#else
+#include <cerrno>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+namespace {
+// Delay after which the command reader checks if the queue was aborted, in milliseconds
+const int inputPollInterval = 200;
+
+/** @brief Wait until the standard input can be read
+ *  @returns 1 if it can be read, 0 on timeout and -1 if it was closed */
+int waitForInput()
+{
+#ifdef Q_OS_WIN
+    DWORD available = 0;
+    if (!PeekNamedPipe(GetStdHandle(STD_INPUT_HANDLE), nullptr, 0, nullptr, &available, nullptr)) {
+        return -1;
+    }
+    if (available == 0) {
+        Sleep(inputPollInterval);
+        return 0;
+    }
+    return 1;
+#else
+    struct pollfd input = {STDIN_FILENO, POLLIN, 0};
+    int ret = poll(&input, 1, inputPollInterval);
+    if (ret < 0) {
+        return errno == EINTR ? 0 : -1;
+    }
+    return ret == 0 ? 0 : 1;
+#endif
+}
+
+/** @brief Read the available data of the standard input, returns 0 when it was closed */
+qint64 readInput(char *buffer, qint64 size)
+{
+#ifdef Q_OS_WIN
+    DWORD count = 0;
+    if (!ReadFile(GetStdHandle(STD_INPUT_HANDLE), buffer, DWORD(size), &count, nullptr)) {
+        return 0;
+    }
+    return qint64(count);
+#else
+    return qint64(read(STDIN_FILENO, buffer, size_t(size)));
+#endif
+}
+} // namespace
+
+ChunkQueue::ChunkQueue(const QDir &baseFolder, const QString &extension, int chunkSize, const QString &scene)
+    : m_baseFolder(baseFolder)
+    , m_extension(extension)
+    , m_chunkSize(qMax(1, chunkSize))
+    , m_scene(scene)
+    , m_generation(0)
+    , m_playhead(-1)
+    , m_aborted(false)
+    , m_closed(false)
+    , m_idleReported(false)
+{
+}
+
+std::vector<int> ChunkQueue::expandChunks(const QStringList &chunks) const
+{
+    std::vector<int> frames;
+    for (const QString &chunk : chunks) {
+        if (chunk.contains(QLatin1Char('-'))) {
+            int rangeStart = chunk.section(QLatin1Char('-'), 0, 0).toInt();
+            int rangeEnd = chunk.section(QLatin1Char('-'), 1, 1).toInt();
+            for (int currentFrame = rangeStart;; currentFrame += m_chunkSize) {
+                frames.push_back(currentFrame);
+                if (currentFrame >= rangeEnd) {
+                    break;
+                }
+            }
+        } else {
+            frames.push_back(chunk.toInt());
+        }
+    }
+    return frames;
+}
+
+int ChunkQueue::distance(int chunk) const
+{
+    if (m_playhead < 0) {
+        return chunk;
+    }
+    return chunk > m_playhead ? chunk - m_playhead : qMax(0, m_playhead - chunk - m_chunkSize + 1);
+}
+
+bool ChunkQueue::isQueued(int chunk) const
+{
+    return std::find(m_pending.begin(), m_pending.end(), chunk) != m_pending.end();
+}
+
+void ChunkQueue::addChunks(const std::vector<int> &chunks)
+{
+    QMutexLocker lock(&m_mutex);
+    for (int chunk : chunks) {
+        if (m_running.count(chunk) == 0 && m_done.count(chunk) == 0 && !isQueued(chunk)) {
+            m_pending.push_back(chunk);
+        }
+    }
+    if (!m_pending.empty()) {
+        m_idleReported = false;
+        m_chunksAvailable.wakeAll();
+    }
+}
+
+void ChunkQueue::invalidate(const std::vector<int> &chunks)
+{
+    QMutexLocker lock(&m_mutex);
+    for (int chunk : chunks) {
+        auto running = m_running.find(chunk);
+        if (running != m_running.end()) {
+            // Will be queued again when the worker finishes it
+            running->second = true;
+            continue;
+        }
+        if (m_done.erase(chunk) > 0) {
+            // Rendered with an outdated scene
+            m_baseFolder.remove(QStringLiteral("%1.%2").arg(chunk).arg(m_extension));
+        }
+        if (!isQueued(chunk)) {
+            m_pending.push_back(chunk);
+        }
+    }
+    if (!m_pending.empty()) {
+        m_idleReported = false;
+        m_chunksAvailable.wakeAll();
+    }
+}
+
+void ChunkQueue::setPlayhead(int frame)
+{
+    QMutexLocker lock(&m_mutex);
+    m_playhead = frame;
+}
+
+bool ChunkQueue::take(int &chunk, QString &scene, int &generation)
+{
+    QMutexLocker lock(&m_mutex);
+    while (!m_aborted && m_pending.empty()) {
+        if (m_closed) {
+            return false;
+        }
+        reportIdle(false);
+        m_chunksAvailable.wait(&m_mutex);
+    }
+    if (m_aborted) {
+        return false;
+    }
+    auto closest = std::min_element(m_pending.begin(), m_pending.end(), [this](int a, int b) { return distance(a) < distance(b); });
+    chunk = *closest;
+    m_pending.erase(closest);
+    m_running[chunk] = false;
+    scene = m_scene;
+    generation = m_generation;
+    return true;
+}
+
+bool ChunkQueue::finish(int chunk)
+{
+    QMutexLocker lock(&m_mutex);
+    auto running = m_running.find(chunk);
+    bool stale = running != m_running.end() && running->second;
+    m_running.erase(chunk);
+    if (stale) {
+        m_pending.push_back(chunk);
+        m_chunksAvailable.wakeOne();
+        return false;
+    }
+    m_done.insert(chunk);
+    return true;
+}
+
+void ChunkQueue::close()
+{
+    QMutexLocker lock(&m_mutex);
+    m_closed = true;
+    m_chunksAvailable.wakeAll();
+}
+
+void ChunkQueue::abort()
+{
+    QMutexLocker lock(&m_mutex);
+    m_aborted = true;
+    m_chunksAvailable.wakeAll();
+}
+
+void ChunkQueue::reportIdle(bool force)
+{
+    if (m_closed || !m_pending.empty() || !m_running.empty() || (m_idleReported && !force)) {
+        return;
+    }
+    m_idleReported = true;
+    fprintf(stderr, "IDLE\n");
+}
+
+void ChunkQueue::readCommands()
+{
+    // Don't block on the input, so that an abort stops the reader too
+    QByteArray pending;
+    char buffer[4096];
+    while (!aborted()) {
+        int ready = waitForInput();
+        if (ready == 0) {
+            continue;
+        }
+        qint64 count = ready > 0 ? readInput(buffer, sizeof(buffer)) : 0;
+        if (count <= 0) {
+            break;
+        }
+        pending.append(buffer, int(count));
+        int eol;
+        while ((eol = pending.indexOf('\n')) >= 0) {
+            processCommand(QString::fromUtf8(pending.left(eol)).trimmed());
+            pending.remove(0, eol + 1);
+        }
+    }
+    close();
+}
+
+bool ChunkQueue::aborted() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_aborted;
+}
+
+void ChunkQueue::processCommand(const QString &command)
+{
+    const QString value = command.section(QLatin1Char(':'), 1);
+    if (command.startsWith(QLatin1String("SCENE:"))) {
+        QMutexLocker lock(&m_mutex);
+        m_scene = value;
+        m_generation++;
+    } else if (command.startsWith(QLatin1String("RENDER:"))) {
+        addChunks(expandChunks(value.split(QLatin1Char(','), Qt::SkipEmptyParts)));
+    } else if (command.startsWith(QLatin1String("INVALIDATE:"))) {
+        invalidate(expandChunks(value.split(QLatin1Char(','), Qt::SkipEmptyParts)));
+    } else if (command.startsWith(QLatin1String("PLAYHEAD:"))) {
+        setPlayhead(value.toInt());
+    } else if (command == QLatin1String("SYNC")) {
+        QMutexLocker lock(&m_mutex);
+        fprintf(stderr, "SYNCED\n");
+        // The update may not have queued anything, tell Kdenlive that we are still idle
+        reportIdle(true);
+    }
+}
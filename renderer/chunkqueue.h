@@ -0,0 +1,87 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QDir>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QWaitCondition>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/** @class ChunkQueue
+    @brief The list of timeline preview chunks to render, shared by the render workers.
+    Workers always take the pending chunk closest to the playhead.
+    The queue can be updated while rendering with the following commands, one per line:
+    - SCENE:<file> the timeline changed, chunks taken from now on use this scene file
+    - RENDER:<chunks> add chunks to render
+    - INVALIDATE:<chunks> chunks that were affected by a timeline change and need to be rendered again
+    - PLAYHEAD:<frame> the timeline cursor moved
+    - SYNC acknowledged with a SYNCED line once the previous commands are processed
+    Until the queue is closed, workers wait for new chunks when it is empty. An IDLE line is printed
+    when all chunks are rendered, so that Kdenlive can close the queue if it has no update to send.
+    Rendered chunks are reported as DONE:<chunk>:<generation>, the generation being the number of SCENE
+    commands received before the chunk was taken, so that Kdenlive knows which timeline version it shows.
+ */
+class ChunkQueue
+{
+public:
+    /** @param chunkSize the chunk duration in frames */
+    ChunkQueue(const QDir &baseFolder, const QString &extension, int chunkSize, const QString &scene);
+
+    /** @brief Expand a compressed chunk list like "0-500,525" in a list of chunk start frames */
+    std::vector<int> expandChunks(const QStringList &chunks) const;
+
+    void addChunks(const std::vector<int> &chunks);
+    void setPlayhead(int frame);
+
+    /** @brief Take the pending chunk closest to the playhead, waiting for one if the queue is empty but not closed
+     *  @param scene receives the scene file to use for this chunk
+     *  @param generation receives a number that changes each time the scene changes
+     *  @returns false when the queue is closed and there is nothing left to render, or when it was aborted */
+    bool take(int &chunk, QString &scene, int &generation);
+    /** @brief Report that a chunk was rendered
+     *  @returns false if the chunk was invalidated while rendering, in which case its result must be discarded */
+    bool finish(int chunk);
+    /** @brief No more chunks will be added, workers stop when the queue is empty */
+    void close();
+    /** @brief Stop distributing chunks */
+    void abort();
+    bool aborted() const;
+
+    /** @brief Process one command line, see the class description */
+    void processCommand(const QString &command);
+    /** @brief Process the commands read from the standard input, until it is closed or the queue is aborted.
+     *  The queue is then closed */
+    void readCommands();
+
+private:
+    mutable QMutex m_mutex;
+    QDir m_baseFolder;
+    QString m_extension;
+    int m_chunkSize;
+    QString m_scene;
+    int m_generation;
+    int m_playhead;
+    bool m_aborted;
+    bool m_closed;
+    /** @brief True once IDLE was printed, until a chunk is queued again */
+    bool m_idleReported;
+    /** @brief Signaled when chunks are queued or the queue is closed */
+    QWaitCondition m_chunksAvailable;
+    std::vector<int> m_pending;
+    /** @brief Chunks being rendered, with a flag set if they were invalidated meanwhile */
+    std::unordered_map<int, bool> m_running;
+    std::unordered_set<int> m_done;
+    int distance(int chunk) const;
+    bool isQueued(int chunk) const;
+    void invalidate(const std::vector<int> &chunks);
+    /** @brief Print IDLE if nothing is pending or rendering. Must be called with m_mutex locked */
+    void reportIdle(bool force);
+};
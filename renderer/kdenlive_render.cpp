@@ -5,6 +5,7 @@
 */
 
 #include "../src/lib/localeHandling.h"
+#include "chunkqueue.h"
 #include "mlt++/Mlt.h"
 #include "renderjob.h"
 #include <../config-kdenlive.h>
@@ -13,8 +14,12 @@
 #include <QDebug>
 #include <QDir>
 #include <QDomDocument>
+#include <QMutex>
 #include <QTemporaryFile>
+#include <QThread>
 #include <QtGlobal>
+#include <memory>
+#include <vector>
 
 int main(int argc, char **argv)
 {
@@ -48,6 +53,16 @@ int main(int argc, char **argv)
         parser.addPositionalArgument("file_extension", "Rendered file extension.");
         parser.addPositionalArgument("args", "Space separated libavformat arguments.", "[arg1 arg2 ...]");
 
+        QCommandLineOption workersOption("workers", "Number of chunks rendered in parallel, 0 to use a value based on the number of cores.", "count",
+                                         QString::number(1));
+        parser.addOption(workersOption);
+
+        QCommandLineOption playheadOption("playhead", "Chunks closest to this frame are rendered first.", "frame", QString::number(-1));
+        parser.addOption(playheadOption);
+
+        QCommandLineOption commandsOption("commands", "Read queue updates on the standard input.");
+        parser.addOption(commandsOption);
+
         parser.process(app);
         args = parser.positionalArguments();
         if (args.count() < 7) {
@@ -76,71 +91,124 @@ int main(int argc, char **argv)
         QString extension = args.takeFirst();
         // avformat consumer params
         QStringList consumerParams = args.takeFirst().split(QLatin1Char(' '), Qt::SkipEmptyParts);
+        int workers = parser.value(workersOption).toInt();
+        if (workers <= 0) {
+            // Each consumer already uses several threads for encoding
+            workers = qMax(1, QThread::idealThreadCount() / 4);
+        }
+        ChunkQueue queue(baseFolder, extension, chunkSize + 1, playlist);
+        queue.setPlayhead(parser.value(playheadOption).toInt());
+        std::vector<int> frames = queue.expandChunks(chunks);
+        queue.addChunks(frames);
+        const bool readCommands = parser.isSet(commandsOption);
+        if (!readCommands) {
+            // Nothing will be added to the queue
+            queue.close();
+            workers = qBound(1, workers, int(frames.size()));
+        }
 
         profile.set_explicit(1);
-        Mlt::Producer prod(profile, nullptr, playlist.toUtf8().constData());
-        if (!prod.is_valid()) {
+        std::unique_ptr<Mlt::Producer> firstProducer(new Mlt::Producer(profile, nullptr, playlist.toUtf8().constData()));
+        if (!firstProducer->is_valid()) {
             fprintf(stderr, "INVALID playlist: %s \n", playlist.toUtf8().constData());
             return 1;
         }
-        const char *localename = prod.get_lcnumeric();
+        const char *localename = firstProducer->get_lcnumeric();
         QLocale::setDefault(QLocale(localename));
 
-        int currentFrame = 0;
-        int rangeStart = 0;
-        int rangeEnd = 0;
-        QString frame;
-        while (!chunks.isEmpty()) {
-            if (rangeEnd == 0) {
-                // We are not processing a range
-                frame = chunks.first();
-            }
-            if (rangeEnd > 0) {
-                // We are processing a range
-                currentFrame += chunkSize + 1;
-                frame = QString::number(currentFrame);
-                if (currentFrame >= rangeEnd) {
-                    // End of range
-                    rangeStart = 0;
-                    rangeEnd = 0;
-                    // Range is processed, remove from stack
-                    chunks.removeFirst();
+        QThread *commandReader = nullptr;
+        if (readCommands) {
+            // Read the queue updates sent by Kdenlive, until it closes our standard input.
+            // Workers wait for new chunks meanwhile, so more chunks can be added than the initial ones
+            commandReader = QThread::create([&queue]() { queue.readCommands(); });
+            commandReader->start();
+        }
+
+        QMutex outputMutex;
+        QMutex loadMutex;
+        auto output = [&outputMutex](const char *message, int frame, int generation = 0) {
+            QMutexLocker lock(&outputMutex);
+            fprintf(stderr, message, frame, generation);
+        };
+        // Each worker needs its own producer, producers cannot be shared between consumers
+        auto renderChunks = [&](Mlt::Producer *initialProducer) {
+            std::unique_ptr<Mlt::Producer> prod(initialProducer);
+            int prodGeneration = prod ? 0 : -1;
+            int frame;
+            QString scene;
+            int generation;
+            while (queue.take(frame, scene, generation)) {
+                output("START:%d \n", frame);
+                QString fileName = QStringLiteral("%1.%2").arg(frame).arg(extension);
+                if (baseFolder.exists(fileName)) {
+                    // Don't overwrite an existing file
+                    if (queue.finish(frame)) {
+                        output("DONE:%d:%d \n", frame, generation);
+                    }
+                    continue;
                 }
-            } else if (frame.contains(QLatin1Char('-'))) {
-                rangeStart = frame.section(QLatin1Char('-'), 0, 0).toInt();
-                rangeEnd = frame.section(QLatin1Char('-'), 1, 1).toInt();
-                currentFrame = rangeStart;
-                frame = QString::number(currentFrame);
-            } else {
-                // Frame will be processed, remove from stack
-                chunks.removeFirst();
-            }
-            fprintf(stderr, "START:%d \n", frame.toInt());
-            QString fileName = QStringLiteral("%1.%2").arg(frame, extension);
-            if (baseFolder.exists(fileName)) {
-                // Don't overwrite an existing file
-                fprintf(stderr, "DONE:%d \n", frame.toInt());
-                continue;
-            }
-            QScopedPointer<Mlt::Producer> playlst(prod.cut(frame.toInt(), frame.toInt() + chunkSize));
-            QScopedPointer<Mlt::Consumer> cons(
-                new Mlt::Consumer(profile, QString("avformat:%1").arg(baseFolder.absoluteFilePath(fileName)).toUtf8().constData()));
-            for (const QString &param : qAsConst(consumerParams)) {
-                if (param.contains(QLatin1Char('='))) {
-                    cons->set(param.section(QLatin1Char('='), 0, 0).toUtf8().constData(), param.section(QLatin1Char('='), 1).toUtf8().constData());
+                if (generation != prodGeneration) {
+                    // The timeline changed, reload it
+                    QMutexLocker lock(&loadMutex);
+                    prod.reset(new Mlt::Producer(profile, nullptr, scene.toUtf8().constData()));
+                    prodGeneration = generation;
+                    if (!prod->is_valid()) {
+                        fprintf(stderr, "INVALID playlist: %s \n", scene.toUtf8().constData());
+                        queue.abort();
+                        break;
+                    }
                 }
+                // Render in a temporary file so that an interrupted render never leaves an incomplete chunk
+                QString tmpFileName = QStringLiteral("%1-part.%2").arg(frame).arg(extension);
+                QScopedPointer<Mlt::Producer> playlst(prod->cut(frame, frame + chunkSize));
+                QScopedPointer<Mlt::Consumer> cons(
+                    new Mlt::Consumer(profile, QString("avformat:%1").arg(baseFolder.absoluteFilePath(tmpFileName)).toUtf8().constData()));
+                for (const QString &param : qAsConst(consumerParams)) {
+                    if (param.contains(QLatin1Char('='))) {
+                        cons->set(param.section(QLatin1Char('='), 0, 0).toUtf8().constData(), param.section(QLatin1Char('='), 1).toUtf8().constData());
+                    }
+                }
+                if (!cons->is_valid()) {
+                    fprintf(stderr, " = =  = INVALID CONSUMER\n\n");
+                    queue.abort();
+                    break;
+                }
+                cons->set("terminate_on_pause", 1);
+                cons->connect(*playlst);
+                playlst.reset();
+                cons->run();
+                cons->stop();
+                cons->purge();
+                if (queue.finish(frame)) {
+                    baseFolder.remove(fileName);
+                    baseFolder.rename(tmpFileName, fileName);
+                    output("DONE:%d:%d \n", frame, generation);
+                } else {
+                    // The chunk was invalidated while rendering, it was queued again
+                    baseFolder.remove(tmpFileName);
+                }
+            }
+        };
+        if (workers == 1) {
+            renderChunks(firstProducer.release());
+        } else {
+            std::vector<std::unique_ptr<QThread>> threads;
+            for (int i = 0; i < workers; i++) {
+                Mlt::Producer *initialProducer = i == 0 ? firstProducer.release() : nullptr;
+                threads.emplace_back(QThread::create(renderChunks, initialProducer));
+                threads.back()->start();
             }
-            if (!cons->is_valid()) {
-                fprintf(stderr, " = =  = INVALID CONSUMER\n\n");
-                return 1;
+            for (auto &thread : threads) {
+                thread->wait();
             }
-            cons->set("terminate_on_pause", 1);
-            cons->connect(*playlst);
-            playlst.reset();
-            cons->run();
-            cons->stop();
-            cons->purge();
-            fprintf(stderr, "DONE:%d \n", frame.toInt());
+        }
+        if (commandReader) {
+            // The reader stops on abort, or when Kdenlive closes our input
+            commandReader->wait();
+            delete commandReader;
+        }
+        if (queue.aborted()) {
+            return 1;
         }
         // Mlt::Factory::close();
         fprintf(stderr, "+ + + RENDERING FINISHED + + + \n");
@@ -165,6 +233,12 @@ int main(int argc, char **argv)
         QCommandLineOption subtitleOption("subtitle", "Subtitle file.", "file");
         parser.addOption(subtitleOption);
 
+        QCommandLineOption segmentsOption("segments",
+                                          "Comma separated list of frames where the output is split. The segments are rendered in parallel and joined "
+                                          "without re-encoding.",
+                                          "frames");
+        parser.addOption(segmentsOption);
+
         parser.process(app);
         args = parser.positionalArguments();
 
@@ -234,8 +308,17 @@ int main(int argc, char **argv)
         }
         int pid = parser.value(pidOption).toInt();
         QString subtitleFile = parser.value(subtitleOption);
+        QList<int> segments;
+        const QStringList bounds = parser.value(segmentsOption).split(QLatin1Char(','), Qt::SkipEmptyParts);
+        for (const QString &bound : bounds) {
+            int frame = bound.toInt();
+            // Bounds must be increasing and inside the rendered range
+            if (frame > in && frame <= out && (segments.isEmpty() || frame > segments.constLast())) {
+                segments << frame;
+            }
+        }
 
-        auto *rJob = new RenderJob(render, playlist, target, pid, in, out, subtitleFile, &app);
+        auto *rJob = new RenderJob(render, playlist, target, pid, in, out, subtitleFile, segments, &app);
         QObject::connect(rJob, &RenderJob::renderingFinished, rJob, [&]() {
             rJob->deleteLater();
             app.quit();
@@ -16,8 +16,11 @@
 #endif
 #include <QDebug>
 #include <QDir>
+#include <QDomDocument>
 #include <QElapsedTimer>
+#include <QFileInfo>
 #include <QStandardPaths>
+#include <QTemporaryFile>
 #include <utility>
 // Can't believe I need to do this to sleep.
 class SleepThread : QThread
@@ -28,7 +31,7 @@ public:
 };
 
 RenderJob::RenderJob(const QString &render, const QString &scenelist, const QString &target, int pid, int in, int out, const QString &subtitleFile,
-                     QObject *parent)
+                     const QList<int> &segments, QObject *parent)
     : QObject(parent)
     , m_scenelist(scenelist)
     , m_dest(target)
@@ -49,6 +52,8 @@ RenderJob::RenderJob(const QString &render, const QString &scenelist, const QStr
     , m_pid(pid)
     , m_dualpass(false)
     , m_subtitleFile(subtitleFile)
+    , m_segments(in >= 0 && out > in ? segments : QList<int>())
+    , m_runningSegments(0)
 {
     m_renderProcess = new QProcess(&m_looper);
     m_renderProcess->setReadChannel(QProcess::StandardError);
@@ -78,6 +83,7 @@ RenderJob::~RenderJob()
     delete m_kdenlivesocket;
 #endif
     delete m_renderProcess;
+    qDeleteAll(m_segmentProcesses);
     m_logfile.close();
 }
 
@@ -119,10 +125,15 @@ void RenderJob::sendFinish(int status, const QString &error)
 void RenderJob::slotAbort()
 {
     m_renderProcess->kill();
+    for (QProcess *process : qAsConst(m_segmentProcesses)) {
+        process->disconnect(this);
+        process->kill();
+    }
     sendFinish(-3, QString());
     if (m_erase) {
         QFile(m_scenelist).remove();
     }
+    removeSegmentFiles();
     QFile(m_dest).remove();
     m_logstream << "Job aborted by user"
                 << "\n";
@@ -271,6 +282,20 @@ void RenderJob::start()
     }
 #endif
 
+    if (!m_segments.isEmpty() && QStandardPaths::findExecutable(QStringLiteral("ffmpeg")).isEmpty()) {
+        // The segments could not be joined, render in a single process
+        m_logstream << "FFmpeg not found, rendering without segments"
+                    << "\n";
+        m_segments.clear();
+    }
+    if (!m_segments.isEmpty()) {
+        if (!startSegments()) {
+            segmentsFailed(tr("Cannot write the playlists of the render segments."));
+            return;
+        }
+        m_looper.exec();
+        return;
+    }
     // Because of the logging, we connect to stderr in all cases.
     connect(m_renderProcess, &QProcess::readyReadStandardError, this, &RenderJob::receivedStderr);
     m_renderProcess->start(m_prog, m_args);
@@ -343,37 +368,45 @@ void RenderJob::slotIsOver(QProcess::ExitStatus status, bool isWritable)
         QProcess::startDetached(QStringLiteral("kdialog"), args);
         Q_EMIT renderingFinished();
     } else {
-        m_logstream << "Rendering of " << m_dest << " finished"
-                    << "\n";
-        m_logstream.flush();
-        if (m_dualpass) {
-            deleteLater();
-        } else {
-            m_logfile.remove();
-            if (!m_subtitleFile.isEmpty()) {
-                // Embed subtitles
-                QString ffmpegExe = QStandardPaths::findExecutable(QStringLiteral("ffmpeg"));
-                if (!ffmpegExe.isEmpty()) {
-                    QFileInfo videoRender(m_dest);
-                    m_temporaryRenderFile = QDir::temp().absoluteFilePath(videoRender.fileName());
-                    QStringList args = {
-                        "-y", "-v", "quiet", "-stats", "-i", m_dest, "-i", m_subtitleFile, "-c", "copy", "-f", "matroska", m_temporaryRenderFile};
-                    qDebug() << "::: JOB ARGS: " << args;
-                    m_progress = 0;
-                    disconnect(m_renderProcess, &QProcess::stateChanged, this, &RenderJob::slotCheckProcess);
-                    disconnect(m_renderProcess, &QProcess::readyReadStandardError, this, &RenderJob::receivedStderr);
-                    m_subsProcess = new QProcess(&m_looper);
-                    m_subsProcess->setProcessChannelMode(QProcess::MergedChannels);
-                    connect(m_subsProcess, &QProcess::readyReadStandardOutput, this, &RenderJob::receivedSubtitleProgress);
-                    m_subsProcess->start(ffmpegExe, args);
-                    m_subsProcess->waitForStarted(-1);
-                    m_subsProcess->waitForFinished(-1);
-                    slotCheckSubtitleProcess(m_subsProcess->exitCode(), m_subsProcess->exitStatus());
-                    return;
-                }
+        finishRender();
+        return;
+    }
+    Q_EMIT renderingFinished();
+    m_looper.quit();
+}
+
+void RenderJob::finishRender()
+{
+    m_logstream << "Rendering of " << m_dest << " finished"
+                << "\n";
+    m_logstream.flush();
+    if (m_dualpass) {
+        deleteLater();
+    } else {
+        m_logfile.remove();
+        if (!m_subtitleFile.isEmpty()) {
+            // Embed subtitles
+            QString ffmpegExe = QStandardPaths::findExecutable(QStringLiteral("ffmpeg"));
+            if (!ffmpegExe.isEmpty()) {
+                QFileInfo videoRender(m_dest);
+                m_temporaryRenderFile = QDir::temp().absoluteFilePath(videoRender.fileName());
+                QStringList args = {
+                    "-y", "-v", "quiet", "-stats", "-i", m_dest, "-i", m_subtitleFile, "-c", "copy", "-f", "matroska", m_temporaryRenderFile};
+                qDebug() << "::: JOB ARGS: " << args;
+                m_progress = 0;
+                disconnect(m_renderProcess, &QProcess::stateChanged, this, &RenderJob::slotCheckProcess);
+                disconnect(m_renderProcess, &QProcess::readyReadStandardError, this, &RenderJob::receivedStderr);
+                m_subsProcess = new QProcess(&m_looper);
+                m_subsProcess->setProcessChannelMode(QProcess::MergedChannels);
+                connect(m_subsProcess, &QProcess::readyReadStandardOutput, this, &RenderJob::receivedSubtitleProgress);
+                m_subsProcess->start(ffmpegExe, args);
+                m_subsProcess->waitForStarted(-1);
+                m_subsProcess->waitForFinished(-1);
+                slotCheckSubtitleProcess(m_subsProcess->exitCode(), m_subsProcess->exitStatus());
+                return;
             }
-            sendFinish(-1, QString());
         }
+        sendFinish(-1, QString());
     }
     Q_EMIT renderingFinished();
     m_looper.quit();
@@ -430,3 +463,227 @@ void RenderJob::slotCheckSubtitleProcess(int exitCode, QProcess::ExitStatus exit
     Q_EMIT renderingFinished();
     m_looper.quit();
 }
+
+bool RenderJob::startSegments()
+{
+    QFile file(m_scenelist);
+    QDomDocument doc;
+    if (!file.open(QIODevice::ReadOnly) || !doc.setContent(&file, false)) {
+        return false;
+    }
+    file.close();
+    QDomElement consumer = doc.documentElement().firstChildElement(QStringLiteral("consumer"));
+    if (consumer.isNull()) {
+        return false;
+    }
+    const QFileInfo destination(m_dest);
+    // Render the segments next to the destination, so that joining them doesn't copy data between filesystems
+    auto partFile = [&destination](const QString &part) {
+        return destination.dir().absoluteFilePath(QStringLiteral("%1-%2.%3").arg(destination.completeBaseName(), part, destination.suffix()));
+    };
+    auto writePlaylist = [this, &doc]() {
+        QTemporaryFile tmp(QDir::temp().absoluteFilePath(QStringLiteral("kdenlive-XXXXXX.mlt")));
+        tmp.setAutoRemove(false);
+        if (!tmp.open()) {
+            return false;
+        }
+        QTextStream outStream(&tmp);
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+        outStream.setCodec("UTF-8");
+#endif
+        outStream << doc.toString();
+        outStream.flush();
+        tmp.close();
+        m_segmentPlaylists << tmp.fileName();
+        return true;
+    };
+    // Audio encoders like AAC or Opus add priming samples at the start of each stream, which would be heard at
+    // each join. So the segments only contain video and the audio is rendered in a single pass, then muxed.
+    const bool hasAudio = consumer.attribute(QStringLiteral("an")) != QLatin1String("1") && consumer.attribute(QStringLiteral("audio_off")) != QLatin1String("1");
+    QList<int> starts = {m_framein};
+    starts << m_segments;
+    for (int i = 0; i < starts.count(); i++) {
+        const int in = starts.at(i);
+        const int out = i + 1 < starts.count() ? starts.at(i + 1) - 1 : m_frameout;
+        const QString segmentFile = partFile(QStringLiteral("part%1").arg(i + 1));
+        consumer.setAttribute(QStringLiteral("in"), in);
+        consumer.setAttribute(QStringLiteral("out"), out);
+        consumer.setAttribute(QStringLiteral("target"), segmentFile);
+        if (hasAudio) {
+            consumer.setAttribute(QStringLiteral("an"), 1);
+        }
+        if (!writePlaylist()) {
+            return false;
+        }
+        m_segmentFiles << segmentFile;
+    }
+    if (hasAudio) {
+        m_audioFile = partFile(QStringLiteral("audio"));
+        consumer.removeAttribute(QStringLiteral("an"));
+        consumer.setAttribute(QStringLiteral("in"), m_framein);
+        consumer.setAttribute(QStringLiteral("out"), m_frameout);
+        consumer.setAttribute(QStringLiteral("target"), m_audioFile);
+        consumer.setAttribute(QStringLiteral("vn"), 1);
+        if (!writePlaylist()) {
+            return false;
+        }
+    }
+    m_segmentFrames.fill(0, starts.count());
+    for (int i = 0; i < m_segmentPlaylists.count(); i++) {
+        auto *process = new QProcess(&m_looper);
+        process->setReadChannel(QProcess::StandardError);
+        connect(process, &QProcess::readyReadStandardError, this, [this, i]() { receivedSegmentStderr(i); });
+        connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+                [this, i](int exitCode, QProcess::ExitStatus status) { slotSegmentFinished(i, exitCode, status); });
+        m_segmentProcesses << process;
+        const QStringList args = {QStringLiteral("-progress"), m_segmentPlaylists.at(i)};
+        process->start(m_prog, args);
+        m_runningSegments++;
+        m_logstream << "Started segment render process: " << m_prog << ' ' << args.join(QLatin1Char(' ')) << "\n";
+    }
+    m_logstream.flush();
+    return true;
+}
+
+void RenderJob::receivedSegmentStderr(int ix)
+{
+    QProcess *process = m_segmentProcesses.at(ix);
+    QString result = QString::fromLocal8Bit(process->readAllStandardError()).simplified();
+    if (!result.startsWith(QLatin1String("Current Frame"))) {
+        m_errorMessage.append(result + QStringLiteral("<br>"));
+        m_logstream << result;
+        return;
+    }
+    if (ix >= m_segmentFrames.count()) {
+        // The audio pass is much faster than the video segments, only count the video frames
+        return;
+    }
+    // Frames are counted from the segment start
+    int segmentIn = ix == 0 ? m_framein : m_segments.at(ix - 1);
+    int frame = result.section(QLatin1Char(','), 0, 0).section(QLatin1Char(' '), -1).toInt();
+    m_segmentFrames[ix] = qMax(m_segmentFrames.at(ix), frame - segmentIn);
+    int rendered = 0;
+    for (int count : qAsConst(m_segmentFrames)) {
+        rendered += count;
+    }
+    // Keep the last percent for the joining of segments
+    int progress = qMin(99, int(100 * qint64(rendered) / (m_frameout - m_framein + 1)));
+    if (progress <= m_progress) {
+        return;
+    }
+    m_progress = progress;
+    qint64 elapsedTime = m_startTime.secsTo(QDateTime::currentDateTime());
+    if (elapsedTime == m_seconds) {
+        return;
+    }
+    int speed = (m_framein + rendered - m_frame) / (elapsedTime - m_seconds);
+    m_seconds = elapsedTime;
+    m_frame = m_framein + rendered;
+    updateProgress(speed);
+}
+
+void RenderJob::slotSegmentFinished(int ix, int exitCode, QProcess::ExitStatus status)
+{
+    QProcess *process = m_segmentProcesses.at(ix);
+    if (status == QProcess::CrashExit || process->error() != QProcess::UnknownError || exitCode != 0) {
+        segmentsFailed(ix < m_segmentFrames.count() ? tr("Rendering of segment %1 failed.").arg(ix + 1) : tr("Rendering of the audio failed."));
+        return;
+    }
+    if (ix < m_segmentFrames.count()) {
+        m_logstream << "Segment " << ix + 1 << " finished"
+                    << "\n";
+    } else {
+        m_logstream << "Audio finished"
+                    << "\n";
+    }
+    if (--m_runningSegments > 0) {
+        return;
+    }
+    if (m_erase) {
+        QFile(m_scenelist).remove();
+    }
+    if (!concatSegments()) {
+        segmentsFailed(tr("Cannot join the rendered segments in %1.").arg(m_dest));
+        return;
+    }
+    removeSegmentFiles();
+    finishRender();
+}
+
+bool RenderJob::concatSegments()
+{
+    QString ffmpegExe = QStandardPaths::findExecutable(QStringLiteral("ffmpeg"));
+    if (ffmpegExe.isEmpty()) {
+        m_errorMessage.append(tr("FFmpeg is required to join the rendered segments.") + QStringLiteral("<br>"));
+        return false;
+    }
+    QTemporaryFile listFile(QDir::temp().absoluteFilePath(QStringLiteral("kdenlive-XXXXXX.txt")));
+    if (!listFile.open()) {
+        return false;
+    }
+    QTextStream listStream(&listFile);
+    for (QString segmentFile : qAsConst(m_segmentFiles)) {
+        listStream << QStringLiteral("file '%1'\n").arg(segmentFile.replace(QLatin1Char('\''), QLatin1String("'\\''")));
+    }
+    listStream.flush();
+    listFile.close();
+    // The segments were encoded with the same parameters, so their streams can be joined without re-encoding
+    QStringList args = {"-y", "-v", "error", "-f", "concat", "-safe", "0", "-i", listFile.fileName()};
+    if (m_audioFile.isEmpty()) {
+        args << "-map" << "0";
+    } else {
+        args << "-i" << m_audioFile << "-map" << "0" << "-map" << "1:a";
+    }
+    args << "-c" << "copy" << m_dest;
+    m_logstream << "Joining segments: " << ffmpegExe << ' ' << args.join(QLatin1Char(' ')) << "\n";
+    QProcess concatProcess;
+    concatProcess.setProcessChannelMode(QProcess::MergedChannels);
+    concatProcess.start(ffmpegExe, args);
+    concatProcess.waitForStarted(-1);
+    concatProcess.waitForFinished(-1);
+    if (concatProcess.exitStatus() == QProcess::CrashExit || concatProcess.exitCode() != 0 || !QFile::exists(m_dest)) {
+        const QString output = QString::fromLocal8Bit(concatProcess.readAll()).simplified();
+        m_errorMessage.append(output + QStringLiteral("<br>"));
+        m_logstream << output << "\n";
+        return false;
+    }
+    m_progress = 100;
+    m_frame = m_frameout;
+    updateProgress();
+    return true;
+}
+
+void RenderJob::segmentsFailed(const QString &error)
+{
+    for (QProcess *process : qAsConst(m_segmentProcesses)) {
+        process->disconnect(this);
+        process->kill();
+        process->waitForFinished();
+    }
+    if (m_erase) {
+        QFile(m_scenelist).remove();
+    }
+    removeSegmentFiles();
+    m_errorMessage.append(error);
+    sendFinish(-2, m_errorMessage);
+    m_logstream << error << "\n";
+    QProcess::startDetached(QStringLiteral("kdialog"), {QStringLiteral("--error"), error});
+    Q_EMIT renderingFinished();
+    m_looper.quit();
+}
+
+void RenderJob::removeSegmentFiles()
+{
+    for (const QString &file : qAsConst(m_segmentPlaylists)) {
+        QFile::remove(file);
+    }
+    for (const QString &file : qAsConst(m_segmentFiles)) {
+        QFile::remove(file);
+    }
+    if (!m_audioFile.isEmpty()) {
+        QFile::remove(m_audioFile);
+        m_audioFile.clear();
+    }
+    m_segmentPlaylists.clear();
+    m_segmentFiles.clear();
+}
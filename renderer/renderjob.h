@@ -16,6 +16,7 @@
 #include <QFile>
 #include <QObject>
 #include <QProcess>
+#include <QVector>
 // Testing
 #include <QTextStream>
 
@@ -25,7 +26,7 @@ class RenderJob : public QObject
 
 public:
     RenderJob(const QString &render, const QString &scenelist, const QString &target, int pid = -1, int in = -1, int out = -1,
-              const QString &subtitleFile = QString(), QObject *parent = nullptr);
+              const QString &subtitleFile = QString(), const QList<int> &segments = QList<int>(), QObject *parent = nullptr);
     ~RenderJob() override;
 
 public Q_SLOTS:
@@ -39,6 +40,8 @@ private Q_SLOTS:
     void slotCheckProcess(QProcess::ProcessState state);
     void slotCheckSubtitleProcess(int exitCode, QProcess::ExitStatus exitStatus);
     void receivedSubtitleProgress();
+    void receivedSegmentStderr(int ix);
+    void slotSegmentFinished(int ix, int exitCode, QProcess::ExitStatus status);
 
 private:
     QString m_scenelist;
@@ -65,6 +68,16 @@ private:
     QString m_temporaryRenderFile;
     QProcess *m_renderProcess;
     QProcess *m_subsProcess;
+    /** @brief First frame of each segment after the first one, empty if the output is rendered in a single process */
+    QList<int> m_segments;
+    QList<QProcess *> m_segmentProcesses;
+    QStringList m_segmentPlaylists;
+    QStringList m_segmentFiles;
+    /** @brief Audio of the whole range, rendered in its own process and muxed with the joined segments */
+    QString m_audioFile;
+    /** @brief Number of frames rendered in each segment */
+    QVector<int> m_segmentFrames;
+    int m_runningSegments;
     QEventLoop m_looper;
     QString m_errorMessage;
     QList<QVariant> m_dbusargs;
@@ -80,6 +93,14 @@ private:
     void sendFinish(int status, const QString &error);
     void updateProgress(int speed = -1);
     void sendProgress();
+    /** @brief Handle a successful render: embed the subtitles and notify Kdenlive */
+    void finishRender();
+    /** @brief Start a render process for each segment, @returns false if the segment playlists could not be written */
+    bool startSegments();
+    /** @brief Join the rendered segments in the destination file without re-encoding */
+    bool concatSegments();
+    void segmentsFailed(const QString &error);
+    void removeSegmentFiles();
 
 Q_SIGNALS:
     void renderingFinished();
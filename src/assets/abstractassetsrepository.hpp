@@ -60,6 +60,20 @@ protected:
         AssetType type;
     };
 
+    /** @brief Assets parsed by a previous run, stored on disk to speed up startup */
+    struct AssetCache
+    {
+        /** @brief Parse result of each MLT service, the bool is false if the parsing failed */
+        std::unordered_map<QString, std::pair<bool, Info>> mltAssets;
+        struct CustomFile
+        {
+            QByteArray hash;
+            std::vector<Info> assets;
+        };
+        /** @brief Assets defined by each custom XML file, indexed by path */
+        std::unordered_map<QString, CustomFile> files;
+    };
+
     // Reads the asset list from file and populates appropriate structure
     void parseAssetList(const QStringList &filePaths, QSet<QString> &destination);
 
@@ -101,6 +115,18 @@ protected:
     /** @brief Returns the path to the assets' preferred list*/
     virtual QString assetPreferredListPath() const = 0;
 
+    /** @brief Returns the file name of the on disk cache of the parsed assets*/
+    virtual QString assetCacheName() const = 0;
+
+    /** @brief Returns a key identifying the MLT installation and the asset lists, the cache is discarded when it changes*/
+    QByteArray assetCacheKey() const;
+
+    /** @brief Reads the cache written by a previous run
+       @return false if the cache does not exist or is outdated
+     */
+    bool readAssetCache(const QString &path, const QByteArray &key, AssetCache &cache) const;
+    void writeAssetCache(const QString &path, const QByteArray &key, const AssetCache &cache) const;
+
     std::unordered_map<QString, Info> m_assets;
 
     QSet<QString> m_excludedList;
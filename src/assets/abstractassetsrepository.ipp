@@ -7,12 +7,17 @@
 #include "kdenlivesettings.h"
 #include "core.h"
 
+#include <QCryptographicHash>
+#include <QDataStream>
 #include <QDir>
 #include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
 #include <QStandardPaths>
 #include <QString>
 #include <QTextStream>
 #include <KLocalizedString>
+#include <framework/mlt_version.h>
 
 #include <locale>
 #ifdef Q_OS_MAC
@@ -30,6 +35,13 @@ template <typename AssetType> void AbstractAssetsRepository<AssetType>::init()
     // Parse preferred list
     parseAssetList({assetPreferredListPath()}, m_preferred_list);
 
+    // Load the assets parsed by a previous run
+    AssetCache cache;
+    const QString cacheFolder = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/assets/");
+    const QString cachePath = cacheFolder + assetCacheName();
+    const QByteArray cacheKey = assetCacheKey();
+    bool cacheChanged = !readAssetCache(cachePath, cacheKey, cache);
+
     // Retrieve the list of MLT's available assets.
     QScopedPointer<Mlt::Properties> assets(retrieveListFromMlt());
     QStringList emptyMetaAssets;
@@ -44,7 +56,20 @@ template <typename AssetType> void AbstractAssetsRepository<AssetType>::init()
             continue;
         }
         if (!m_excludedList.contains(name)) {
-            if (parseInfoFromMlt(name, info)) {
+            bool parsed = false;
+            auto cached = cache.mltAssets.find(name);
+            if (cached != cache.mltAssets.end()) {
+                parsed = cached->second.first;
+                if (parsed) {
+                    info = cached->second.second;
+                }
+            } else {
+                // Fetching the metadata is slow, only do it for assets we don't know yet
+                parsed = parseInfoFromMlt(name, info);
+                cache.mltAssets[name] = {parsed, info};
+                cacheChanged = true;
+            }
+            if (parsed) {
                 m_assets[name] = info;
                 if (m_includedList.contains(name)) {
                     info.included = true;
@@ -67,8 +92,10 @@ template <typename AssetType> void AbstractAssetsRepository<AssetType>::init()
        Each of them contains a tag, which is the corresponding mlt asset, and an id that is the name of the asset. Note that several custom files can correspond
        to the same tag, and in that case they must have different ids. We do the parsing in a map from ids to parse info, and then we add them to the asset
        list, while discarding the bare version of each tag (the one with no file associated)
+       Files that did not change since the last run are not parsed again, the assets they defined are taken from the cache.
     */
     std::unordered_map<QString, Info> customAssets;
+    QSet<QString> parsedFiles;
     // reverse order to prioritize local install
     QListIterator<QString> dirs_it(asset_dirs);
     for (dirs_it.toBack(); dirs_it.hasPrevious();) { auto dir=dirs_it.previous();
@@ -77,9 +104,70 @@ template <typename AssetType> void AbstractAssetsRepository<AssetType>::init()
         QStringList fileList = current_dir.entryList(filter, QDir::Files);
         for (const auto &file : qAsConst(fileList)) {
             QString path = current_dir.absoluteFilePath(file);
+            QFile xmlFile(path);
+            if (!xmlFile.open(QIODevice::ReadOnly)) {
+                continue;
+            }
+            const QByteArray fileHash = QCryptographicHash::hash(xmlFile.readAll(), QCryptographicHash::Md5);
+            xmlFile.close();
+            parsedFiles.insert(path);
+            auto cachedFile = cache.files.find(path);
+            if (cachedFile != cache.files.end() && cachedFile->second.hash == fileHash) {
+                for (const Info &asset : cachedFile->second.assets) {
+                    auto existing = customAssets.find(asset.id);
+                    if (existing != customAssets.end() && asset.version < existing->second.version) {
+                        continue;
+                    }
+                    customAssets[asset.id] = asset;
+                }
+                continue;
+            }
+            // Remember the current definitions to find out which assets are defined by this file
+            std::unordered_map<QString, QDomElement> previous;
+            for (const auto &asset : customAssets) {
+                previous[asset.first] = asset.second.xml;
+            }
             parseCustomAssetFile(path, customAssets);
+            typename AssetCache::CustomFile cacheEntry;
+            cacheEntry.hash = fileHash;
+            for (const auto &asset : customAssets) {
+                auto prev = previous.find(asset.first);
+                if (prev == previous.end() || prev->second != asset.second.xml) {
+                    cacheEntry.assets.push_back(asset.second);
+                }
+            }
+            cache.files[path] = cacheEntry;
+            cacheChanged = true;
+        }
+    }
+    // Forget the files that were removed
+    for (auto it = cache.files.begin(); it != cache.files.end();) {
+        if (!parsedFiles.contains(it->first)) {
+            it = cache.files.erase(it);
+            cacheChanged = true;
+        } else {
+            ++it;
         }
     }
+    if (cacheChanged && QDir().mkpath(cacheFolder)) {
+        writeAssetCache(cachePath, cacheKey, cache);
+    }
+
+    // List of all MLT services, built on first use to check the dependencies
+    QSet<QString> mltServices;
+    auto mltServiceExists = [&mltServices](const QString &serviceName) {
+        if (mltServices.isEmpty()) {
+            QScopedPointer<Mlt::Properties> effects(pCore->getMltRepository()->filters());
+            for (int i = 0; i < effects->count(); ++i) {
+                mltServices.insert(QString(effects->get_name(i)));
+            }
+            QScopedPointer<Mlt::Properties> transitions(pCore->getMltRepository()->transitions());
+            for (int i = 0; i < transitions->count(); ++i) {
+                mltServices.insert(QString(transitions->get_name(i)));
+            }
+        }
+        return mltServices.contains(serviceName);
+    };
 
     // We add the custom assets
     QStringList missingDependency;
@@ -92,33 +180,11 @@ template <typename AssetType> void AbstractAssetsRepository<AssetType>::init()
         m_assets[custom.first] = custom.second;
 
         QString dependency = custom.second.xml.attribute(QStringLiteral("dependency"), QString());
-        if(!dependency.isEmpty()) {
-            bool found = false;
-            QScopedPointer<Mlt::Properties> effects(pCore->getMltRepository()->filters());
-            for(int i = 0; i < effects->count(); ++i) {
-                if(effects->get_name(i) == dependency) {
-                    found = true;
-                    break;
-                }
-            }
-
-            if(!found) {
-                QScopedPointer<Mlt::Properties> transitions(pCore->getMltRepository()->transitions());
-                for(int i = 0; i < transitions->count(); ++i) {
-                    if(transitions->get_name(i) == dependency) {
-                        found = true;
-                        break;
-                    }
-                }
-            }
-
-            if(!found) {
-                // asset depends on another asset that is invalid so remove this asset too
-                missingDependency << custom.first;
-                qDebug() << "Asset" << custom.first << "has invalid dependency" << dependency << "and is going to be removed";
-            }
+        if (!dependency.isEmpty() && !mltServiceExists(dependency)) {
+            // asset depends on another asset that is invalid so remove this asset too
+            missingDependency << custom.first;
+            qDebug() << "Asset" << custom.first << "has invalid dependency" << dependency << "and is going to be removed";
         }
-
     }
     // Remove really invalid assets
     emptyMetaAssets << missingDependency;
@@ -147,6 +213,146 @@ template <typename AssetType> void AbstractAssetsRepository<AssetType>::parseAss
     }
 }
 
+namespace AssetCacheFormat {
+// Increase when the content of the assets cache changes
+constexpr quint32 version = 1;
+constexpr quint32 magic = 0x4b444143;
+
+inline QString assetXmlToString(const QDomElement &xml)
+{
+    if (xml.isNull()) {
+        return QString();
+    }
+    QDomDocument doc;
+    doc.appendChild(doc.importNode(xml, true));
+    return doc.toString(-1);
+}
+
+inline QDomElement assetXmlFromString(const QString &data)
+{
+    if (data.isEmpty()) {
+        return QDomElement();
+    }
+    QDomDocument doc;
+    doc.setContent(data);
+    return doc.documentElement();
+}
+} // namespace AssetCacheFormat
+
+template <typename AssetType> QByteArray AbstractAssetsRepository<AssetType>::assetCacheKey() const
+{
+    QCryptographicHash key(QCryptographicHash::Md5);
+    key.addData(QByteArray(mlt_version_get_string()));
+    // Names and descriptions are translated when parsed
+    key.addData(KLocalizedString::languages().join(QLatin1Char(',')).toUtf8());
+    QStringList assetLists = m_excludedList.values();
+    assetLists.sort();
+    QStringList included = m_includedList.values();
+    included.sort();
+    assetLists << QStringLiteral("#") << included;
+    key.addData(assetLists.join(QLatin1Char(',')).toUtf8());
+    // Installing or removing plugins changes the modification time of their folders
+    QStringList pluginDirs = {QString::fromUtf8(mlt_environment("MLT_REPOSITORY"))};
+    const QStringList pluginEnv = {QStringLiteral("FREI0R_PATH"), QStringLiteral("LADSPA_PATH"), QStringLiteral("LV2_PATH"), QStringLiteral("VST2_PATH")};
+    for (const QString &env : pluginEnv) {
+        pluginDirs << qEnvironmentVariable(env.toLatin1().constData()).split(QDir::listSeparator(), Qt::SkipEmptyParts);
+    }
+    pluginDirs << QStringLiteral("/usr/lib/frei0r-1") << QStringLiteral("/usr/lib64/frei0r-1") << QStringLiteral("/usr/local/lib/frei0r-1")
+               << QDir::homePath() + QStringLiteral("/.frei0r-1/lib") << QStringLiteral("/usr/lib/ladspa") << QStringLiteral("/usr/local/lib/ladspa");
+    for (const QString &dir : qAsConst(pluginDirs)) {
+        QFileInfo info(dir);
+        if (info.exists()) {
+            key.addData(dir.toUtf8());
+            key.addData(QByteArray::number(info.lastModified().toMSecsSinceEpoch()));
+        }
+    }
+    return key.result();
+}
+
+template <typename AssetType> bool AbstractAssetsRepository<AssetType>::readAssetCache(const QString &path, const QByteArray &key, AssetCache &cache) const
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    // Read everything at once, the stream is then parsed from memory
+    const QByteArray data = file.readAll();
+    file.close();
+    QDataStream in(data);
+    in.setVersion(QDataStream::Qt_5_15);
+    quint32 magic, version;
+    QByteArray storedKey;
+    in >> magic >> version >> storedKey;
+    if (magic != AssetCacheFormat::magic || version != AssetCacheFormat::version || storedKey != key) {
+        return false;
+    }
+    auto readInfo = [&in]() {
+        Info info;
+        qint32 type;
+        QString xml;
+        in >> info.id >> info.mltId >> info.name >> info.description >> info.author >> info.version_str >> info.version >> info.included >> type >> xml;
+        info.type = AssetType(type);
+        info.xml = AssetCacheFormat::assetXmlFromString(xml);
+        return info;
+    };
+    qint32 count;
+    in >> count;
+    for (int i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QString name;
+        bool parsed;
+        in >> name >> parsed;
+        cache.mltAssets[name] = {parsed, readInfo()};
+    }
+    in >> count;
+    for (int i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QString filePath;
+        typename AssetCache::CustomFile entry;
+        qint32 assetCount;
+        in >> filePath >> entry.hash >> assetCount;
+        for (int j = 0; j < assetCount && in.status() == QDataStream::Ok; ++j) {
+            entry.assets.push_back(readInfo());
+        }
+        cache.files[filePath] = entry;
+    }
+    if (in.status() != QDataStream::Ok) {
+        qWarning() << "Corrupted assets cache" << path;
+        cache.mltAssets.clear();
+        cache.files.clear();
+        return false;
+    }
+    return true;
+}
+
+template <typename AssetType>
+void AbstractAssetsRepository<AssetType>::writeAssetCache(const QString &path, const QByteArray &key, const AssetCache &cache) const
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Cannot write assets cache" << path;
+        return;
+    }
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_15);
+    out << AssetCacheFormat::magic << AssetCacheFormat::version << key;
+    auto writeInfo = [&out](const Info &info) {
+        out << info.id << info.mltId << info.name << info.description << info.author << info.version_str << info.version << info.included
+            << qint32(info.type) << AssetCacheFormat::assetXmlToString(info.xml);
+    };
+    out << qint32(cache.mltAssets.size());
+    for (const auto &asset : cache.mltAssets) {
+        out << asset.first << asset.second.first;
+        writeInfo(asset.second.second);
+    }
+    out << qint32(cache.files.size());
+    for (const auto &entry : cache.files) {
+        out << entry.first << entry.second.hash << qint32(entry.second.assets.size());
+        for (const Info &info : entry.second.assets) {
+            writeInfo(info);
+        }
+    }
+    file.commit();
+}
+
 template <typename AssetType> bool AbstractAssetsRepository<AssetType>::parseInfoFromMlt(const QString &assetId, Info &res)
 {
     std::unique_ptr<Mlt::Properties> metadata(getMetadata(assetId));
@@ -1170,41 +1170,18 @@ QVariant KeyframeModel::getInterpolatedValue(const GenTime &pos) const
     if (m_keyframeList.size() == 0) {
         return QVariant();
     }
-    Mlt::Properties mlt_prop;
     QString animData;
-    int out = 0;
     bool useOpacity = false;
-    if (auto ptr = m_model.lock()) {
-        ptr->passProperties(mlt_prop);
-        out = ptr->data(m_index, AssetParameterModel::ParentDurationRole).toInt();
+    std::shared_ptr<AssetParameterModel> ptr = m_model.lock();
+    if (ptr) {
         useOpacity = ptr->data(m_index, AssetParameterModel::OpacityRole).toBool();
         animData = ptr->data(m_index, AssetParameterModel::ValueRole).toString();
     }
 
-    if (!animData.isEmpty() && (m_paramType == ParamType::KeyframeParam || m_paramType == ParamType::ColorWheel)) {
-        mlt_prop.set("key", animData.toUtf8().constData());
-        // This is a fake query to force the animation to be parsed
-        (void)mlt_prop.anim_get_double("key", 0, out);
-        return QVariant(mlt_prop.anim_get_double("key", pos.frames(pCore->getCurrentFps())));
-    }
-    if (!animData.isEmpty() && m_paramType == ParamType::AnimatedRect) {
-        mlt_prop.set("key", animData.toUtf8().constData());
-        // This is a fake query to force the animation to be parsed
-        (void)mlt_prop.anim_get_double("key", 0, out);
-        mlt_rect rect = mlt_prop.anim_get_rect("key", pos.frames(pCore->getCurrentFps()));
-        QString res = QStringLiteral("%1 %2 %3 %4").arg(int(rect.x)).arg(int(rect.y)).arg(int(rect.w)).arg(int(rect.h));
-        if (useOpacity) {
-            res.append(QStringLiteral(" %1").arg(QString::number(rect.o, 'f')));
-        }
-        return QVariant(res);
-    }
-    if (!animData.isEmpty() && m_paramType == ParamType::Color) {
-        mlt_prop.set("key", animData.toUtf8().constData());
-        // This is a fake query to force the animation to be parsed
-        (void)mlt_prop.anim_get_double("key", 0, out);
-        mlt_color mltColor = mlt_prop.anim_get_color("key", pos.frames(pCore->getCurrentFps()));
-        QColor color(mltColor.r, mltColor.g, mltColor.b, mltColor.a);
-        return QVariant(QColorUtils::colorToString(color, true));
+    if (!animData.isEmpty() && (m_paramType == ParamType::KeyframeParam || m_paramType == ParamType::ColorWheel ||
+                                m_paramType == ParamType::AnimatedRect || m_paramType == ParamType::Color)) {
+        QMutexLocker lock(&m_curveMutex);
+        return curveValue(interpolationCurve(ptr, animData), pos.frames(pCore->getCurrentFps()), useOpacity);
     }
     if (m_paramType == ParamType::Roto_spline) {
         // interpolate
@@ -1250,8 +1227,88 @@ QVariant KeyframeModel::getInterpolatedValue(const GenTime &pos) const
     return QVariant();
 }
 
+QVector<QVariant> KeyframeModel::getInterpolatedValues(int start, int end) const
+{
+    QVector<QVariant> values;
+    if (end < start) {
+        return values;
+    }
+    values.reserve(end - start + 1);
+    QString animData;
+    bool useOpacity = false;
+    std::shared_ptr<AssetParameterModel> ptr = m_model.lock();
+    if (ptr) {
+        useOpacity = ptr->data(m_index, AssetParameterModel::OpacityRole).toBool();
+        animData = ptr->data(m_index, AssetParameterModel::ValueRole).toString();
+    }
+    if (m_keyframeList.empty() || animData.isEmpty() ||
+        (m_paramType != ParamType::KeyframeParam && m_paramType != ParamType::ColorWheel && m_paramType != ParamType::AnimatedRect &&
+         m_paramType != ParamType::Color)) {
+        for (int frame = start; frame <= end; ++frame) {
+            values << getInterpolatedValue(frame);
+        }
+        return values;
+    }
+    // Fetch the curve once for the whole range
+    double fps = pCore->getCurrentFps();
+    QMutexLocker lock(&m_curveMutex);
+    Mlt::Properties *curve = interpolationCurve(ptr, animData);
+    for (int frame = start; frame <= end; ++frame) {
+        auto keyframe = m_keyframeList.find(GenTime(frame, fps));
+        if (keyframe != m_keyframeList.end()) {
+            values << keyframe->second.second;
+        } else {
+            values << curveValue(curve, frame, useOpacity);
+        }
+    }
+    return values;
+}
+
+Mlt::Properties *KeyframeModel::interpolationCurve(const std::shared_ptr<AssetParameterModel> &model, const QString &animData) const
+{
+    if (!m_curve || animData != m_curveData) {
+        m_curve.reset(new Mlt::Properties());
+        if (model) {
+            model->passProperties(*m_curve.get());
+        }
+        m_curve->set("key", animData.toUtf8().constData());
+        m_curveData = animData;
+    }
+    return m_curve.get();
+}
+
+QVariant KeyframeModel::curveValue(Mlt::Properties *curve, int frame, bool useOpacity) const
+{
+    // Always query with the same length, otherwise MLT parses the animation again
+    switch (m_paramType) {
+    case ParamType::AnimatedRect: {
+        mlt_rect rect = curve->anim_get_rect("key", frame);
+        QString res = QStringLiteral("%1 %2 %3 %4").arg(int(rect.x)).arg(int(rect.y)).arg(int(rect.w)).arg(int(rect.h));
+        if (useOpacity) {
+            res.append(QStringLiteral(" %1").arg(QString::number(rect.o, 'f')));
+        }
+        return QVariant(res);
+    }
+    case ParamType::Color: {
+        mlt_color mltColor = curve->anim_get_color("key", frame);
+        QColor color(mltColor.r, mltColor.g, mltColor.b, mltColor.a);
+        return QVariant(QColorUtils::colorToString(color, true));
+    }
+    case ParamType::KeyframeParam:
+    case ParamType::ColorWheel:
+        return QVariant(curve->anim_get_double("key", frame));
+    default:
+        return QVariant();
+    }
+}
+
 void KeyframeModel::sendModification()
 {
+    {
+        // The keyframes changed, drop the parsed curve
+        QMutexLocker lock(&m_curveMutex);
+        m_curve.reset();
+    }
     if (auto ptr = m_model.lock()) {
         Q_ASSERT(m_index.isValid());
         QString name = ptr->data(m_index, AssetParameterModel::NameRole).toString();
@@ -11,6 +11,7 @@
 #include "utils/gentime.h"
 
 #include <QAbstractListModel>
+#include <QMutex>
 #include <QReadWriteLock>
 #include <QtGlobal>
 
@@ -168,6 +169,8 @@ public:
     /** @brief Return the interpolated value at given pos */
     QVariant getInterpolatedValue(int pos) const;
     QVariant getInterpolatedValue(const GenTime &pos) const;
+    /** @brief Return the interpolated values for all frames from start to end (included) */
+    QVector<QVariant> getInterpolatedValues(int start, int end) const;
     QVariant updateInterpolated(const QVariant &interpValue, double val);
     /** @brief Return the real value from a normalized one */
     QVariant getNormalizedValue(double newVal) const;
@@ -223,6 +226,12 @@ protected:
     void parseAnimProperty(const QString &prop, int in = -1, int out = -1);
     void parseRotoProperty(const QString &prop);
 
+    /** @brief Returns the parsed animation for the given anim string, only parsed again when the string changes.
+        m_curveMutex must be locked by the caller */
+    Mlt::Properties *interpolationCurve(const std::shared_ptr<AssetParameterModel> &model, const QString &animData) const;
+    /** @brief Query the parsed animation at the given frame, according to the parameter type */
+    QVariant curveValue(Mlt::Properties *curve, int frame, bool useOpacity) const;
+
 private:
     std::weak_ptr<AssetParameterModel> m_model;
     std::weak_ptr<DocUndoStack> m_undoStack;
@@ -233,6 +242,11 @@ private:
     mutable QReadWriteLock m_lock;
 
     std::map<GenTime, std::pair<KeyframeType, QVariant>> m_keyframeList;
+    /** @brief Animation parsed by MLT, used to interpolate the values between keyframes */
+    mutable std::unique_ptr<Mlt::Properties> m_curve;
+    /** @brief The anim string m_curve was built from */
+    mutable QString m_curveData;
+    mutable QMutex m_curveMutex;
     bool moveOneKeyframe(GenTime oldPos, GenTime pos, QVariant newVal, Fun &undo, Fun &redo, bool updateView = true, bool allowedToFail = false);
 
 Q_SIGNALS:
@@ -32,6 +32,11 @@ AssetParameterModel::AssetParameterModel(std::unique_ptr<Mlt::Properties> asset,
     , m_filterProgress(0)
 {
     Q_ASSERT(m_asset->is_valid());
+    m_liveTimer.setSingleShot(true);
+    connect(&m_liveTimer, &QTimer::timeout, this, &AssetParameterModel::applyLiveParameters);
+    m_invalidateTimer.setSingleShot(true);
+    m_invalidateTimer.setInterval(500);
+    connect(&m_invalidateTimer, &QTimer::timeout, this, [this]() { pCore->invalidateItem(m_ownerId); });
     QDomNodeList parameterNodes = assetXml.elementsByTagName(QStringLiteral("parameter"));
     m_hideKeyframesByDefault = assetXml.hasAttribute(QStringLiteral("hideKeyframes"));
     m_requiresInOut = assetXml.hasAttribute(QStringLiteral("requires_in_out"));
@@ -265,6 +270,7 @@ const QString AssetParameterModel::getParam(const QString &paramName)
 void AssetParameterModel::setParameter(const QString &name, int value, bool update)
 {
     Q_ASSERT(m_asset->is_valid());
+    m_liveValues.remove(name);
     m_asset->set(name.toLatin1().constData(), value);
     if (m_fixedParams.count(name) == 0) {
         m_params[name].value = value;
@@ -287,15 +293,51 @@ void AssetParameterModel::setParameter(const QString &name, int value, bool upda
     if (update) {
         Q_EMIT modelChanged();
         Q_EMIT dataChanged(index(0, 0), index(m_rows.count() - 1, 0), {});
-        // Update fades in timeline
-        pCore->updateItemModel(m_ownerId, m_assetId, name);
-        if (!m_isAudio) {
-            // Trigger monitor refresh
-            pCore->refreshProjectItem(m_ownerId);
-            // Invalidate timeline preview
-            pCore->invalidateItem(m_ownerId);
-        }
+        updateOwner(name);
+    }
+}
+
+void AssetParameterModel::updateOwner(const QString &name)
+{
+    // Update fades in timeline
+    pCore->updateItemModel(m_ownerId, m_assetId, name);
+    if (m_isAudio) {
+        return;
+    }
+    // Trigger monitor refresh
+    pCore->refreshProjectItem(m_ownerId);
+    // Invalidate timeline preview, only once the user stopped dragging the value
+    if (m_liveChange) {
+        m_invalidateTimer.start();
+    } else {
+        m_invalidateTimer.stop();
+        pCore->invalidateItem(m_ownerId);
+    }
+}
+
+void AssetParameterModel::setLiveParameter(const QString &name, const QString &paramValue, const QModelIndex &paramIndex)
+{
+    m_liveValues.insert(name, {paramValue, QPersistentModelIndex(paramIndex)});
+    if (!m_liveTimer.isActive()) {
+        // Don't refresh faster than the display
+        double fps = pCore->getCurrentFps();
+        m_liveTimer.start(fps > 0. ? qMax(16, qRound(1000. / fps)) : 40);
+    }
+}
+
+void AssetParameterModel::applyLiveParameters()
+{
+    m_liveTimer.stop();
+    if (m_liveValues.isEmpty()) {
+        return;
+    }
+    const auto values = m_liveValues;
+    m_liveValues.clear();
+    m_liveChange = true;
+    for (auto it = values.cbegin(); it != values.cend(); ++it) {
+        setParameter(it.key(), it.value().first, false, it.value().second);
     }
+    m_liveChange = false;
 }
 
 void AssetParameterModel::internalSetParameter(const QString name, const QString paramValue, const QModelIndex &paramIndex)
@@ -439,6 +481,10 @@ const QChar AssetParameterModel::getKeyframeType(const QString keyframeString)
 void AssetParameterModel::setParameter(const QString &name, const QString &paramValue, bool update, const QModelIndex &paramIndex)
 {
     // qDebug() << "// PROCESSING PARAM CHANGE: " << name << ", UPDATE: " << update << ", VAL: " << paramValue;
+    if (!m_liveChange) {
+        // A pending live value must not override this one
+        m_liveValues.remove(name);
+    }
     internalSetParameter(name, paramValue, paramIndex);
     bool updateChildRequired = true;
     if (m_assetId.startsWith(QStringLiteral("sox_"))) {
@@ -472,14 +518,7 @@ void AssetParameterModel::setParameter(const QString &name, const QString &param
         // Used for generator clips
         if (!update) Q_EMIT modelChanged();
     } else {
-        // Update fades in timeline
-        pCore->updateItemModel(m_ownerId, m_assetId, name);
-        if (!m_isAudio) {
-            // Trigger monitor refresh
-            pCore->refreshProjectItem(m_ownerId);
-            // Invalidate timeline preview
-            pCore->invalidateItem(m_ownerId);
-        }
+        updateOwner(name);
     }
 }
 
@@ -10,6 +10,9 @@
 #include <QAbstractListModel>
 #include <QDomElement>
 #include <QJsonDocument>
+#include <QMap>
+#include <QPersistentModelIndex>
+#include <QTimer>
 #include <unordered_map>
 
 #include <memory>
@@ -147,6 +150,13 @@ public:
      */
     Q_INVOKABLE void setParameter(const QString &name, const QString &paramValue, bool update = true, const QModelIndex &paramIndex = QModelIndex());
     void setParameter(const QString &name, int value, bool update = true);
+    /** @brief Set an intermediate parameter value while the user is dragging it.
+     *  Successive values are merged and applied at most once per frame, and the timeline preview is only invalidated once
+     *  the final value is set with setParameter() or when no new value arrived for a short time.
+     */
+    void setLiveParameter(const QString &name, const QString &paramValue, const QModelIndex &paramIndex = QModelIndex());
+    /** @brief Immediately apply the pending live values */
+    void applyLiveParameters();
 
     /** @brief Return all the parameters as pairs (parameter name, parameter value) */
     QVector<QPair<QString, QVariant>> getAllParameters() const;
@@ -265,6 +275,17 @@ protected:
     bool m_isAudio;
     /** @brief Store a filter's job progress */
     int m_filterProgress;
+    /** @brief Live values that were not applied yet, by parameter name */
+    QMap<QString, QPair<QString, QPersistentModelIndex>> m_liveValues;
+    /** @brief Applies the live values, started at most once per frame */
+    QTimer m_liveTimer;
+    /** @brief Invalidates the timeline preview when a live change stopped without a final value */
+    QTimer m_invalidateTimer;
+    /** @brief true while the live values are applied */
+    bool m_liveChange{false};
+
+    /** @brief Refresh the monitor and timeline after a parameter change. The timeline preview invalidation is delayed during live changes */
+    void updateOwner(const QString &name);
 
     /** @brief Set the parameter with given name to the given value. This should be called when first
      *  building an effect in the constructor, so that we don't call shared_from_this
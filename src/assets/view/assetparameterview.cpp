@@ -169,6 +169,16 @@ void AssetParameterView::disableCurrentFilter(bool disable)
 void AssetParameterView::commitChanges(const QModelIndex &index, const QString &value, bool storeUndo)
 {
     // Warning: please note that some widgets (for example keyframes) do NOT send the valueChanged signal and do modifications on their own
+    if (!storeUndo) {
+        const QString name = m_model->data(index, AssetParameterModel::NameRole).toString();
+        if (!name.contains(QLatin1Char('\n'))) {
+            // Intermediate value while dragging, merge it with the next ones
+            m_model->setLiveParameter(name, value, index);
+            return;
+        }
+    }
+    // The final value of a drag must be compared to the last applied one for undo
+    m_model->applyLiveParameters();
     const QString previousValue = m_model->data(index, AssetParameterModel::ValueRole).toString();
     auto *command = new AssetCommand(m_model, index, value);
     if (storeUndo && m_model->getOwnerId().itemId != -1) {
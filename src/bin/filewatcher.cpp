@@ -4,13 +4,51 @@
 */
 
 #include "filewatcher.hpp"
+#include "kdenlivesettings.h"
 
 #include <KDirWatch>
 #include <QFileInfo>
 
+void DirectoryWatcher::addDirectories(const QStringList &dirs)
+{
+    if (!m_dirWatch) {
+        // Created on first use so that it belongs to the watcher thread
+        m_dirWatch.reset(new KDirWatch);
+        connect(m_dirWatch.get(), &KDirWatch::dirty, this, &DirectoryWatcher::dirty);
+        connect(m_dirWatch.get(), &KDirWatch::deleted, this, &DirectoryWatcher::deleted);
+        connect(m_dirWatch.get(), &KDirWatch::created, this, &DirectoryWatcher::created);
+    }
+    for (const QString &dir : dirs) {
+        if (!m_dirs.contains(dir)) {
+            // One watch per folder, events are reported for the files it contains
+            m_dirWatch->addDir(dir, KDirWatch::WatchFiles);
+            m_dirs << dir;
+        }
+    }
+}
+
+void DirectoryWatcher::removeDirectories(const QStringList &dirs)
+{
+    if (!m_dirWatch) {
+        return;
+    }
+    for (const QString &dir : dirs) {
+        if (m_dirs.removeOne(dir)) {
+            m_dirWatch->removeDir(dir);
+        }
+    }
+}
+
+void DirectoryWatcher::clear()
+{
+    m_dirWatch.reset();
+    m_dirs.clear();
+}
+
 FileWatcher::FileWatcher(QObject *parent)
     : QObject(parent)
     , m_fileWatcher(new KDirWatch)
+    , m_watchFolders(KdenliveSettings::watchmediafolders())
 {
     // Init clip modification tracker
     m_modifiedTimer.setInterval(2000);
@@ -21,6 +59,39 @@ FileWatcher::FileWatcher(QObject *parent)
     m_queueTimer.setInterval(300);
     m_queueTimer.setSingleShot(true);
     connect(&m_queueTimer, &QTimer::timeout, this, &FileWatcher::slotProcessQueue);
+    if (m_watchFolders) {
+        m_dirWatcher = new DirectoryWatcher;
+        m_dirWatcher->moveToThread(&m_dirThread);
+        connect(&m_dirThread, &QThread::finished, m_dirWatcher, &QObject::deleteLater);
+        connect(m_dirWatcher, &DirectoryWatcher::dirty, this, &FileWatcher::slotUrlModified);
+        connect(m_dirWatcher, &DirectoryWatcher::deleted, this, &FileWatcher::slotUrlMissing);
+        connect(m_dirWatcher, &DirectoryWatcher::created, this, &FileWatcher::slotUrlAdded);
+        m_dirThread.start(QThread::LowPriority);
+        // Folders are sent to the watcher thread in batches
+        m_dirQueueTimer.setInterval(100);
+        m_dirQueueTimer.setSingleShot(true);
+        connect(&m_dirQueueTimer, &QTimer::timeout, this, &FileWatcher::slotProcessDirQueue);
+    }
+}
+
+FileWatcher::~FileWatcher()
+{
+    if (m_watchFolders) {
+        m_dirThread.quit();
+        m_dirThread.wait();
+    }
+}
+
+void FileWatcher::slotProcessDirQueue()
+{
+    if (!m_removedDirs.isEmpty()) {
+        QMetaObject::invokeMethod(m_dirWatcher, [watcher = m_dirWatcher, dirs = m_removedDirs]() { watcher->removeDirectories(dirs); });
+        m_removedDirs.clear();
+    }
+    if (!m_addedDirs.isEmpty()) {
+        QMetaObject::invokeMethod(m_dirWatcher, [watcher = m_dirWatcher, dirs = m_addedDirs]() { watcher->addDirectories(dirs); });
+        m_addedDirs.clear();
+    }
 }
 
 void FileWatcher::slotProcessQueue()
@@ -38,6 +109,27 @@ void FileWatcher::slotProcessQueue()
 
 void FileWatcher::addFile(const QString &binId, const QString &url)
 {
+    if (m_watchFolders) {
+        if (url.isEmpty()) {
+            return;
+        }
+        std::unordered_set<QString> &ids = m_occurences[url];
+        bool newUrl = ids.empty();
+        ids.insert(binId);
+        m_binClipPaths[binId] = url;
+        if (newUrl) {
+            const QString dir = QFileInfo(url).absolutePath();
+            if (m_dirOccurences[dir]++ == 0) {
+                if (!m_removedDirs.removeOne(dir)) {
+                    m_addedDirs << dir;
+                }
+                if (!m_dirQueueTimer.isActive()) {
+                    m_dirQueueTimer.start();
+                }
+            }
+        }
+        return;
+    }
     std::unordered_map<QString, std::unordered_set<QString>>::const_iterator pos = m_occurences.find(url);
     if (pos != m_occurences.end()) {
         // Url already queued, only add ref to binId if necessary
@@ -75,15 +167,33 @@ void FileWatcher::removeFile(const QString &binId)
     m_occurences[url].erase(binId);
     m_binClipPaths.erase(binId);
     if (m_occurences[url].empty()) {
-        m_fileWatcher->removeFile(url);
         m_occurences.erase(url);
+        if (!m_watchFolders) {
+            m_fileWatcher->removeFile(url);
+            return;
+        }
+        const QString dir = QFileInfo(url).absolutePath();
+        if (--m_dirOccurences[dir] <= 0) {
+            m_dirOccurences.erase(dir);
+            if (!m_addedDirs.removeOne(dir)) {
+                m_removedDirs << dir;
+            }
+            if (!m_dirQueueTimer.isActive()) {
+                m_dirQueueTimer.start();
+            }
+        }
     }
 }
 
 void FileWatcher::slotUrlModified(const QString &path)
 {
+    auto pos = m_occurences.find(path);
+    if (pos == m_occurences.end()) {
+        // Not a project file, can happen when watching folders
+        return;
+    }
     if (m_modifiedUrls.insert(path).second) {
-        for (const QString &id : m_occurences[path]) {
+        for (const QString &id : pos->second) {
             Q_EMIT binClipWaiting(id);
         }
     }
@@ -94,14 +204,22 @@ void FileWatcher::slotUrlModified(const QString &path)
 
 void FileWatcher::slotUrlAdded(const QString &path)
 {
-    for (const QString &id : m_occurences[path]) {
+    auto pos = m_occurences.find(path);
+    if (pos == m_occurences.end()) {
+        return;
+    }
+    for (const QString &id : pos->second) {
         Q_EMIT binClipModified(id);
     }
 }
 
 void FileWatcher::slotUrlMissing(const QString &path)
 {
-    for (const QString &id : m_occurences[path]) {
+    auto pos = m_occurences.find(path);
+    if (pos == m_occurences.end()) {
+        return;
+    }
+    for (const QString &id : pos->second) {
         Q_EMIT binClipMissing(id);
     }
 }
@@ -110,9 +228,14 @@ void FileWatcher::slotProcessModifiedUrls()
 {
     auto checkList = m_modifiedUrls;
     for (const QString &path : checkList) {
-        if (m_fileWatcher->ctime(path).msecsTo(QDateTime::currentDateTime()) > 2000) {
-            for (const QString &id : m_occurences[path]) {
-                Q_EMIT binClipModified(id);
+        // The folder watcher lives in another thread, so directly check the file
+        const QDateTime lastChange = m_watchFolders ? QFileInfo(path).lastModified() : m_fileWatcher->ctime(path);
+        if (lastChange.msecsTo(QDateTime::currentDateTime()) > 2000) {
+            auto pos = m_occurences.find(path);
+            if (pos != m_occurences.end()) {
+                for (const QString &id : pos->second) {
+                    Q_EMIT binClipModified(id);
+                }
             }
             m_modifiedUrls.erase(path);
         }
@@ -134,9 +257,19 @@ void FileWatcher::clear()
     m_modifiedUrls.clear();
     m_binClipPaths.clear();
     m_fileWatcher->startScan();
+    if (m_watchFolders) {
+        m_dirQueueTimer.stop();
+        m_addedDirs.clear();
+        m_removedDirs.clear();
+        m_dirOccurences.clear();
+        QMetaObject::invokeMethod(m_dirWatcher, &DirectoryWatcher::clear);
+    }
 }
 
 bool FileWatcher::contains(const QString &path) const
 {
+    if (m_watchFolders) {
+        return m_occurences.count(path) > 0;
+    }
     return m_fileWatcher->contains(path);
 }
@@ -7,10 +7,34 @@
 
 #include "definitions.h"
 #include <KDirWatch>
+#include <QThread>
 #include <QTimer>
 #include <unordered_map>
 #include <unordered_set>
 
+/** @class DirectoryWatcher
+    @brief Owns a KDirWatch living in a background thread, used to register
+    the folders of the project media in bulk without blocking the UI.
+ */
+class DirectoryWatcher : public QObject
+{
+    Q_OBJECT
+
+public Q_SLOTS:
+    void addDirectories(const QStringList &dirs);
+    void removeDirectories(const QStringList &dirs);
+    void clear();
+
+Q_SIGNALS:
+    void dirty(const QString &path);
+    void created(const QString &path);
+    void deleted(const QString &path);
+
+private:
+    std::unique_ptr<KDirWatch> m_dirWatch;
+    QStringList m_dirs;
+};
+
 /** @class FileWatcher
     @brief This class is responsible for watching all files used in the project
     and triggers a reload notification when a file changes.
@@ -22,6 +46,7 @@ class FileWatcher : public QObject
 public:
     // Constructor
     explicit FileWatcher(QObject *parent = nullptr);
+    ~FileWatcher() override;
     /** @brief Add a file to the queue for watched items */
     void addFile(const QString &binId, const QString &url);
     /** @brief Remove a binId from the list of watched items */
@@ -45,6 +70,7 @@ private Q_SLOTS:
     void slotUrlAdded(const QString &path);
     void slotProcessModifiedUrls();
     void slotProcessQueue();
+    void slotProcessDirQueue();
 
 private:
     /// This is a handle to the watcher singleton, not owned by this class.
@@ -62,6 +88,19 @@ private:
 
     QTimer m_modifiedTimer;
     QTimer m_queueTimer;
+
+    /// True if we watch the parent folders of the files instead of each file
+    bool m_watchFolders;
+    /// Thread running the folder watcher
+    QThread m_dirThread;
+    /// Folder watcher, living in m_dirThread
+    DirectoryWatcher *m_dirWatcher{nullptr};
+    /// Number of watched urls in each folder
+    std::unordered_map<QString, int> m_dirOccurences;
+    /// Folders to add or remove on the next call to slotProcessDirQueue
+    QStringList m_addedDirs;
+    QStringList m_removedDirs;
+    QTimer m_dirQueueTimer;
     /// Add a file to the list of watched items
     void doAddFile(const QString &binId, const QString &url);
 };
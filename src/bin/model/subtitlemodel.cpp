@@ -27,6 +27,7 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QRegularExpression>
+#include <QSaveFile>
 #include <utility>
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
 #include <QStringConverter>
@@ -34,6 +35,25 @@
 #include <QTextCodec>
 #endif
 
+namespace {
+// Format a time as hh:mm:ss,SSS for srt files
+QString srtTime(GenTime time)
+{
+    int millisec = int(time.seconds() * 1000);
+    int seconds = millisec / 1000;
+    millisec %= 1000;
+    int minutes = seconds / 60;
+    seconds %= 60;
+    int hours = minutes / 60;
+    minutes %= 60;
+    return QString("%1:%2:%3,%4")
+        .arg(hours, 2, 10, QChar('0'))
+        .arg(minutes, 2, 10, QChar('0'))
+        .arg(seconds, 2, 10, QChar('0'))
+        .arg(millisec, 3, 10, QChar('0'));
+}
+} // namespace
+
 SubtitleModel::SubtitleModel(std::shared_ptr<TimelineItemModel> timeline, const std::weak_ptr<SnapInterface> &snapModel, QObject *parent)
     : QAbstractListModel(parent)
     , m_timeline(timeline)
@@ -64,7 +84,18 @@ SubtitleModel::SubtitleModel(std::shared_ptr<TimelineItemModel> timeline, const
             .arg(fontMargin);
     eventSection = QStringLiteral("[Events]\n");
     styleName = QStringLiteral("Default");
-    connect(this, &SubtitleModel::modelChanged, [this]() { jsontoSubtitle(toJson()); });
+    // Coalesce the model changes, the subtitle filter has to reparse the whole file on each update
+    m_fileTimer.setSingleShot(true);
+    m_fileTimer.setInterval(200);
+    connect(&m_fileTimer, &QTimer::timeout, this, [this]() {
+        if (flushSubtitleFile()) {
+            pCore->refreshProjectMonitorOnce();
+        }
+    });
+    connect(this, &SubtitleModel::modelChanged, this, [this]() {
+        m_fileDirty = true;
+        m_fileTimer.start();
+    });
     int id = pCore->currentDoc()->getSequenceProperty(timeline->uuid(), QStringLiteral("kdenlive:activeSubtitleIndex"), QStringLiteral("0")).toInt();
     const QString subPath = pCore->currentDoc()->subTitlePath(timeline->uuid(), id, true);
     const QString workPath = pCore->currentDoc()->subTitlePath(timeline->uuid(), id, false);
@@ -87,6 +118,8 @@ SubtitleModel::SubtitleModel(std::shared_ptr<TimelineItemModel> timeline, const
         qDebug() << "MISSING SUBTITLE FILE, create tmp: " << workPath;
     }
     parseSubtitle(workPath);
+    // Attach the filter right away when loading a project
+    flushSubtitleFile();
 }
 
 void SubtitleModel::setStyle(const QString &style)
@@ -1169,6 +1202,7 @@ QString SubtitleModel::toJson()
 
 void SubtitleModel::copySubtitle(const QString &path, int ix, bool checkOverwrite, bool updateFilter)
 {
+    flushSubtitleFile();
     QFile srcFile(pCore->currentDoc()->subTitlePath(m_timeline->uuid(), ix, false));
     if (srcFile.exists()) {
         QFile prev(path);
@@ -1197,22 +1231,68 @@ void SubtitleModel::restoreTmpFile(int ix)
     m_subtitleFilter->set("av.filename", outFile.toUtf8().constData());
 }
 
-void SubtitleModel::jsontoSubtitle(const QString &data)
+bool SubtitleModel::flushSubtitleFile()
 {
+    m_fileTimer.stop();
+    if (!m_fileDirty || m_timeline == nullptr) {
+        return false;
+    }
+    m_fileDirty = false;
     int ix = pCore->currentDoc()->getSequenceProperty(m_timeline->uuid(), QStringLiteral("kdenlive:activeSubtitleIndex"), QStringLiteral("0")).toInt();
-    QString outFile = pCore->currentDoc()->subTitlePath(m_timeline->uuid(), ix, false);
-    QString masterFile = m_subtitleFilter->get("av.filename");
-    if (masterFile.isEmpty()) {
-        m_subtitleFilter->set("av.filename", outFile.toUtf8().constData());
+    const QString outFile = pCore->currentDoc()->subTitlePath(m_timeline->uuid(), ix, false);
+    QWriteLocker locker(&m_lock);
+    // Both lists are sorted by start time, so walk them together and only format the added or edited subtitles
+    bool changed = outFile != m_workFile;
+    QString data;
+    int line = 0;
+    auto cached = m_formattedEntries.begin();
+    for (const auto &subtitle : m_subtitleList) {
+        while (cached != m_formattedEntries.end() && cached->first < subtitle.first) {
+            // Subtitle was removed or moved
+            cached = m_formattedEntries.erase(cached);
+            changed = true;
+        }
+        bool added = false;
+        if (cached == m_formattedEntries.end() || subtitle.first < cached->first) {
+            cached = m_formattedEntries.emplace_hint(cached, subtitle.first, FormattedEntry());
+            added = true;
+        }
+        FormattedEntry &entry = cached->second;
+        if (added || entry.end != subtitle.second.second || entry.text != subtitle.second.first) {
+            entry.text = subtitle.second.first;
+            entry.end = subtitle.second.second;
+            entry.block = QStringLiteral("%1 --> %2\n%3\n\n").arg(srtTime(subtitle.first), srtTime(entry.end), entry.text);
+            changed = true;
+        }
+        data.append(QString::number(++line));
+        data.append(QLatin1Char('\n'));
+        data.append(entry.block);
+        ++cached;
+    }
+    if (cached != m_formattedEntries.end()) {
+        m_formattedEntries.erase(cached, m_formattedEntries.end());
+        changed = true;
+    }
+    if (!changed) {
+        // Only the view changed, don't make the filter reload the file
+        return false;
     }
-    int line = saveSubtitleData(data, outFile);
+    // Replace the file atomically, it may be read by the subtitle filter at any time
+    QSaveFile outF(outFile);
+    if (!outF.open(QIODevice::WriteOnly) || outF.write(data.toUtf8()) < 0 || !outF.commit()) {
+        qDebug() << "Cannot write subtitle file: " << outFile;
+        m_fileDirty = true;
+        return false;
+    }
+    m_workFile = outFile;
     qDebug() << "Saving subtitle filter: " << outFile;
+    m_subtitleFilter->set("av.filename", outFile.toUtf8().constData());
     if (line > 0) {
-        m_subtitleFilter->set("av.filename", outFile.toUtf8().constData());
         m_timeline->tractor()->attach(*m_subtitleFilter.get());
     } else {
         m_timeline->tractor()->detach(*m_subtitleFilter.get());
     }
+    return true;
 }
 
 int SubtitleModel::saveSubtitleData(const QString &data, const QString &outFile)
@@ -1735,6 +1815,7 @@ int SubtitleModel::createNewSubtitle(const QString subtitleName, int id)
     m_subtitlesList.insert({maxIx, newName}, newPath);
     if (id >= 0) {
         // Duplicate existing subtitle
+        flushSubtitleFile();
         QString source = pCore->currentDoc()->subTitlePath(m_timeline->uuid(), id, false);
         if (!QFile::exists(source)) {
             source = pCore->currentDoc()->subTitlePath(m_timeline->uuid(), id, true);
@@ -1796,6 +1877,8 @@ void SubtitleModel::activateSubtitle(int ix)
     if (currentIx == ix) {
         return;
     }
+    // Write the pending changes of the current subtitle before switching
+    flushSubtitleFile();
     const QString workPath = pCore->currentDoc()->subTitlePath(m_timeline->uuid(), ix, false);
     const QString finalPath = pCore->currentDoc()->subTitlePath(m_timeline->uuid(), ix, true);
     if (!QFile::exists(workPath) && QFile::exists(finalPath)) {
@@ -12,6 +12,7 @@
 
 #include <QAbstractListModel>
 #include <QReadWriteLock>
+#include <QTimer>
 
 #include <array>
 #include <map>
@@ -134,6 +135,10 @@ public:
     void copySubtitle(const QString &path, int ix, bool checkOverwrite, bool updateFilter = false);
     /** @brief Use the tmp work file for the subtitle filter after saving the project */
     void restoreTmpFile(int ix);
+    /** @brief Write the pending subtitle changes to the work file read by the subtitle filter.
+     *  Changes are otherwise written after a short delay, so that a burst of edits only rewrites the file once
+     *  @returns true if the file was rewritten */
+    bool flushSubtitleFile();
     int trackDuration() const;
     void switchDisabled();
     bool isDisabled() const;
@@ -208,8 +213,6 @@ public Q_SLOTS:
     /** @brief Function that parses through a subtitle file */
     void parseSubtitle(const QString &workPath);
 
-    /** @brief Import model to a temporary subtitle file to which the Subtitle effect is applied*/
-    void jsontoSubtitle(const QString &data);
     /** @brief Update a subtitle text*/
     bool setText(int id, const QString &text);
 
@@ -238,6 +241,20 @@ private:
     std::unique_ptr<Mlt::Filter> m_subtitleFilter;
     QVector<int> m_selected;
     QVector<int> m_grabbedIds;
+    /** @brief The srt block of a subtitle (without its sequence number), kept until its text or end changes */
+    struct FormattedEntry
+    {
+        QString text;
+        GenTime end;
+        QString block;
+    };
+    /** @brief The formatted subtitles, by start time, so that only the edited subtitles are formatted again when writing the work file */
+    std::map<GenTime, FormattedEntry> m_formattedEntries;
+    /** @brief The work file that was last written */
+    QString m_workFile;
+    /** @brief True if the model changed since the work file was written */
+    bool m_fileDirty{false};
+    QTimer m_fileTimer;
     int saveSubtitleData(const QString &data, const QString &outFile);
 
 Q_SIGNALS:
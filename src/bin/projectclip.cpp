@@ -31,7 +31,9 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "projectitemmodel.h"
 #include "projectsubclip.h"
 #include "timeline2/model/snapmodel.hpp"
+#include "utils/mediaprobecache.hpp"
 #include "utils/thumbnailcache.hpp"
+#include "utils/thumbnailproducerpool.hpp"
 #include "utils/timecode.h"
 #include "xml/xml.hpp"
 
@@ -443,6 +445,7 @@ void ProjectClip::resetSequenceThumbnails()
     QMutexLocker lk(&m_thumbMutex);
     pCore->taskManager.discardJobs(ObjectId(KdenliveObjectType::BinClip, m_binId.toInt(), QUuid()), AbstractTask::LOADJOB, true);
     m_thumbXml.clear();
+    ThumbnailProducerPool::get()->invalidate(m_binId);
     ThumbnailCache::get()->invalidateThumbsForClip(m_binId);
     // Force refeshing thumbs producer
     lk.unlock();
@@ -465,6 +468,7 @@ void ProjectClip::reloadProducer(bool refreshOnly, bool isProxy, bool forceAudio
         pCore->taskManager.discardJobs(oid, AbstractTask::THUMBJOB);
         pCore->taskManager.discardJobs(oid, AbstractTask::CACHEJOB);
         m_thumbXml.clear();
+        ThumbnailProducerPool::get()->invalidate(m_binId);
         // Reset uuid to enforce reloading thumbnails from qml cache
         m_uuid = QUuid::createUuid();
         updateTimelineClips({TimelineModel::ClipThumbRole, TimelineModel::ResourceRole});
@@ -491,6 +495,7 @@ void ProjectClip::reloadProducer(bool refreshOnly, bool isProxy, bool forceAudio
         if (!xml.isNull()) {
             bool hashChanged = false;
             m_thumbXml.clear();
+            ThumbnailProducerPool::get()->invalidate(m_binId);
             ClipType::ProducerType type = clipType();
             if (type != ClipType::Color && type != ClipType::Image && type != ClipType::SlideShow) {
                 xml.removeAttribute("out");
@@ -627,6 +632,7 @@ bool ProjectClip::setProducer(std::shared_ptr<Mlt::Producer> producer, bool gene
         pCore->taskManager.discardJobs(ObjectId(KdenliveObjectType::BinClip, m_binId.toInt(), QUuid()), AbstractTask::THUMBJOB);
         m_thumbMutex.lock();
         m_thumbXml.clear();
+        ThumbnailProducerPool::get()->invalidate(m_binId);
         m_thumbMutex.unlock();
     }
 
@@ -1723,8 +1729,12 @@ const QString ProjectClip::getFileHash()
 
 const QPair<QByteArray, qint64> ProjectClip::calculateHash(const QString &path)
 {
+    QByteArray fileHash = MediaProbeCache::get()->fileHash(path);
+    if (!fileHash.isEmpty()) {
+        // The file did not change since it was last hashed
+        return {fileHash, QFileInfo(path).size()};
+    }
     QFile file(path);
-    QByteArray fileHash;
     qint64 fSize = 0;
     if (file.open(QIODevice::ReadOnly)) { // write size and hash only if resource points to a file
         /*
@@ -1743,6 +1753,7 @@ const QPair<QByteArray, qint64> ProjectClip::calculateHash(const QString &path)
         }
         file.close();
         fileHash = QCryptographicHash::hash(fileData, QCryptographicHash::Md5);
+        MediaProbeCache::get()->storeFileHash(path, fileHash);
     }
     return {fileHash, fSize};
 }
@@ -2159,9 +2170,9 @@ void ProjectClip::discardAudioThumb()
         QString key = QString("%1:%2").arg(m_binId).arg(st);
         pCore->audioThumbCache.insert(key, QByteArray("-"));
     }
-    // Delete thumbnail
+    // Delete thumbnail created by previous versions
     for (int &st : streams) {
-        audioThumbPath = getAudioThumbPath(st);
+        audioThumbPath = getAudioThumbPath(st, true);
         if (!audioThumbPath.isEmpty()) {
             QFile::remove(audioThumbPath);
         }
@@ -2184,7 +2195,7 @@ int ProjectClip::getAudioStreamFfmpegIndex(int mltStream)
     return -1;
 }
 
-const QString ProjectClip::getAudioThumbPath(int stream)
+const QString ProjectClip::getAudioThumbPath(int stream, bool legacyImage)
 {
     if (audioInfo() == nullptr) {
         return QString();
@@ -2202,7 +2213,11 @@ const QString ProjectClip::getAudioThumbPath(int stream)
     QString audioPath = thumbFolder.absoluteFilePath(clipHash);
     audioPath.append(QLatin1Char('_') + QString::number(stream));
     int roundedFps = int(pCore->getCurrentFps());
-    audioPath.append(QStringLiteral("_%1_audio.png").arg(roundedFps));
+    if (legacyImage) {
+        audioPath.append(QStringLiteral("_%1_audio.png").arg(roundedFps));
+    } else {
+        audioPath.append(QStringLiteral("_%1_audio.levels").arg(roundedFps));
+    }
     return audioPath;
 }
 
@@ -2867,6 +2882,23 @@ const QVector<uint8_t> ProjectClip::audioFrameCache(int stream)
     return audioLevels;*/
 }
 
+std::shared_ptr<const AudioLevelsPyramid> ProjectClip::audioLevelsPyramid(int stream)
+{
+    if (stream == -1) {
+        if (m_audioInfo) {
+            stream = m_audioInfo->ffmpeg_audio_index();
+        } else {
+            return nullptr;
+        }
+    }
+    const QString key = QString("_kdenlive:audiopyramid%1").arg(stream);
+    auto *pyramid = static_cast<std::shared_ptr<AudioLevelsPyramid> *>(m_masterProducer->get_data(key.toUtf8().constData()));
+    if (pyramid) {
+        return *pyramid;
+    }
+    return nullptr;
+}
+
 void ProjectClip::setClipStatus(FileStatus::ClipStatus status)
 {
     FileStatus::ClipStatus previousStatus = m_clipStatus;
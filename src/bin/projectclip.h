@@ -20,6 +20,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include <QUuid>
 #include <memory>
 
+class AudioLevelsPyramid;
 class ClipPropertiesController;
 class ProjectFolder;
 class ProjectSubClip;
@@ -197,7 +198,9 @@ public:
     /** @brief Delete cached audio thumb - needs to be recreated */
     void discardAudioThumb();
     /** @brief Get path for this clip's audio thumbnail */
-    const QString getAudioThumbPath(int stream);
+    /** @brief Returns the path of the audio levels cache file for a stream
+     *  @param legacyImage if true, return the path of the PNG file used by previous versions */
+    const QString getAudioThumbPath(int stream, bool legacyImage = false);
     /** @brief Returns true if this producer has audio and can be splitted on timeline*/
     bool isSplittable() const;
 
@@ -241,6 +244,8 @@ public:
     /** @brief Return audio cache for a stream
      */
     const QVector <uint8_t> audioFrameCache(int stream = -1);
+    /** @brief Returns the multi resolution audio levels for a stream, or nullptr if they are not ready */
+    std::shared_ptr<const AudioLevelsPyramid> audioLevelsPyramid(int stream = -1);
     /** @brief Return FFmpeg's audio stream index for an MLT audio stream index
      */
     int getAudioStreamFfmpegIndex(int mltStream);
@@ -25,6 +25,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "projectfolder.h"
 #include "projectsubclip.h"
 #include "utils/thumbnailcache.hpp"
+#include "utils/thumbnailproducerpool.hpp"
 #include "xml/xml.hpp"
 
 #include <KLocalizedString>
@@ -504,6 +505,16 @@ const QVector<uint8_t> ProjectItemModel::getAudioLevelsByBinID(const QString &bi
     return QVector<uint8_t>();
 }
 
+std::shared_ptr<const AudioLevelsPyramid> ProjectItemModel::getAudioPyramidByBinID(const QString &binId, int stream)
+{
+    READ_LOCK();
+    auto search = m_allClipItems.find(binId.toInt());
+    if (search != m_allClipItems.end()) {
+        return search->second->audioLevelsPyramid(stream);
+    }
+    return nullptr;
+}
+
 double ProjectItemModel::getAudioMaxLevel(const QString &binId, int stream)
 {
     READ_LOCK();
@@ -620,6 +631,7 @@ void ProjectItemModel::clean()
     m_sequenceFolderId = -1;
     buildPlaylist(m_uuid);
     ThumbnailCache::get()->clearCache();
+    ThumbnailProducerPool::get()->clear();
 }
 
 std::shared_ptr<ProjectFolder> ProjectItemModel::getRootFolder() const
@@ -21,6 +21,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include <QTimer>
 #include <QUuid>
 
+class AudioLevelsPyramid;
 class BinPlaylist;
 class FileWatcher;
 class MarkerListModel;
@@ -63,6 +64,8 @@ public:
     std::shared_ptr<ProjectClip> getClipByBinID(const QString &binId);
     /** @brief Returns audio levels for a clip from its id */
     const QVector <uint8_t>getAudioLevelsByBinID(const QString &binId, int stream);
+    /** @brief Returns the multi resolution audio levels for a clip from its id, or nullptr if not available */
+    std::shared_ptr<const AudioLevelsPyramid> getAudioPyramidByBinID(const QString &binId, int stream);
     double getAudioMaxLevel(const QString &binId, int stream);
 
     /** @brief Returns a list of clips using the given url */
@@ -77,7 +77,8 @@ enum {
     LastTimeRole,
     LastFrameRole,
     OpenBrowserRole,
-    PlayAfterRole
+    PlayAfterRole,
+    ThreadsRole
 };
 
 // Running job status
@@ -248,6 +249,15 @@ RenderWidget::RenderWidget(bool enableProxy, QWidget *parent)
     m_view.encoder_threads->setValue(KdenliveSettings::encodethreads());
     connect(m_view.encoder_threads, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged), this, &KdenliveSettings::setEncodethreads);
     connect(m_view.encoder_threads, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged), this, &RenderWidget::refreshParams);
+    m_view.render_segments->setValue(KdenliveSettings::rendersegments());
+    connect(m_view.render_segments, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged), this, &KdenliveSettings::setRendersegments);
+    m_view.thread_budget->setMaximum(4 * QThread::idealThreadCount());
+    m_view.thread_budget->setValue(KdenliveSettings::renderthreadbudget());
+    connect(m_view.thread_budget, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged), this, [this](int budget) {
+        KdenliveSettings::setRenderthreadbudget(budget);
+        // A larger budget may allow waiting jobs to start
+        checkRenderStatus();
+    });
 
     connect(m_view.video_box, &QGroupBox::toggled, this, &RenderWidget::refreshParams);
     connect(m_view.audio_box, &QGroupBox::toggled, this, &RenderWidget::refreshParams);
@@ -691,6 +701,7 @@ void RenderWidget::slotPrepareExport2(bool delayedRendering)
     request->setEmbedSubtitles(m_view.embed_subtitles->isEnabled() && m_view.embed_subtitles->isChecked());
     request->setTwoPass(m_view.checkTwoPass->isChecked());
     request->setAudioFilePerTrack(m_view.stemAudioExport->isChecked() && m_view.stemAudioExport->isEnabled());
+    request->setSegments(KdenliveSettings::rendersegments());
 
     bool guideMultiExport = m_view.guide_multi_box->isChecked();
     int guideCategory = m_view.guideCategoryChooser->currentCategory();
@@ -768,6 +779,7 @@ RenderJobItem *RenderWidget::createRenderJob(const RenderRequest::RenderJob &job
     QStringList argsJob = RenderRequest::argsByJob(job);
 
     renderItem->setData(1, ParametersRole, argsJob);
+    renderItem->setData(1, ThreadsRole, jobThreads(job));
     qDebug() << "* CREATED JOB WITH ARGS: " << argsJob;
     renderItem->setData(1, OpenBrowserRole, m_view.open_browser->isChecked());
     renderItem->setData(1, PlayAfterRole, m_view.play_after->isChecked());
@@ -781,6 +793,26 @@ RenderJobItem *RenderWidget::createRenderJob(const RenderRequest::RenderJob &job
     return renderItem;
 }
 
+int RenderWidget::jobThreads(const RenderRequest::RenderJob &job) const
+{
+    if (m_params.value(QStringLiteral("vn")) == QLatin1String("1")) {
+        // Audio encoders use a single thread and audio processing is light
+        return 1;
+    }
+    int encoderThreads = m_params.value(QStringLiteral("threads")).toInt();
+    if (encoderThreads <= 0) {
+        // FFmpeg starts a thread per core, but they spend much of their time waiting for the frames produced by MLT
+        encoderThreads = qMax(1, QThread::idealThreadCount() / 2);
+    }
+    int processingThreads = qMax(1, qAbs(m_params.value(QStringLiteral("real_time")).toInt()));
+    // Segmented jobs start one render process per segment, plus one for the audio
+    int threads = (encoderThreads + processingThreads) * int(job.segments.count() + 1);
+    if (!job.segments.isEmpty() && m_params.value(QStringLiteral("an")) != QLatin1String("1")) {
+        threads++;
+    }
+    return threads;
+}
+
 void RenderWidget::checkRenderStatus()
 {
     // check if we have a job waiting to render
@@ -788,22 +820,41 @@ void RenderWidget::checkRenderStatus()
         return;
     }
 
-    // Make sure no other rendering is running
-    if (runningJobsCount() > 0) {
+    // Jobs run in parallel as long as their threads fit in the budget, otherwise one at a time
+    int budget = KdenliveSettings::renderthreadbudget();
+    int usedThreads = 0;
+    int runningJobs = 0;
+    QStringList runningOutputs;
+    auto *item = static_cast<RenderJobItem *>(m_view.running_jobs->topLevelItem(0));
+    while (item != nullptr) {
+        if (item->status() == RUNNINGJOB || item->status() == STARTINGJOB) {
+            runningJobs++;
+            runningOutputs << item->text(1);
+            usedThreads += item->data(1, ThreadsRole).isValid() ? item->data(1, ThreadsRole).toInt() : QThread::idealThreadCount();
+        }
+        item = static_cast<RenderJobItem *>(m_view.running_jobs->itemBelow(item));
+    }
+    if (runningJobs > 0 && budget <= 0) {
         return;
     }
 
-    auto *item = static_cast<RenderJobItem *>(m_view.running_jobs->topLevelItem(0));
+    item = static_cast<RenderJobItem *>(m_view.running_jobs->topLevelItem(0));
 
     bool waitingJob = false;
 
-    // Find first waiting job
+    // Start the waiting jobs in queue order
     while (item != nullptr) {
         if (item->status() == WAITINGJOB) {
+            waitingJob = true;
+            int threads = item->data(1, ThreadsRole).isValid() ? item->data(1, ThreadsRole).toInt() : QThread::idealThreadCount();
+            // A job larger than the budget still starts when nothing else runs.
+            // Jobs writing the same file, like the passes of a 2 pass render, never run together
+            if (runningJobs > 0 && (usedThreads + threads > budget || runningOutputs.contains(item->text(1)))) {
+                break;
+            }
             QDateTime t = QDateTime::currentDateTime();
             item->setData(1, StartTimeRole, t);
             item->setData(1, LastTimeRole, t);
-            waitingJob = true;
             startRendering(item);
             // Check for 2 pass encoding
             QStringList jobData = item->data(1, ParametersRole).toStringList();
@@ -822,11 +873,16 @@ void RenderWidget::checkRenderStatus()
                 }
             }
             item->setStatus(STARTINGJOB);
-            break;
+            runningJobs++;
+            usedThreads += threads;
+            runningOutputs << item->text(1);
+            if (budget <= 0) {
+                break;
+            }
         }
         item = static_cast<RenderJobItem *>(m_view.running_jobs->itemBelow(item));
     }
-    if (!waitingJob && m_view.shutdown->isChecked()) {
+    if (!waitingJob && runningJobs == 0 && m_view.shutdown->isChecked()) {
         Q_EMIT shutdown();
     }
 }
@@ -220,8 +220,10 @@ private:
     Purpose::Menu *m_shareMenu;
     void parseProfiles(const QString &selectedProfile = QString());
     QUrl filenameWithExtension(QUrl url, const QString &extension);
-    /** @brief Check if a job needs to be started. */
+    /** @brief Start the waiting jobs that fit in the render thread budget. */
     void checkRenderStatus();
+    /** @brief Returns the estimated number of threads used by a render job with the current parameters. */
+    int jobThreads(const RenderRequest::RenderJob &job) const;
     void startRendering(RenderJobItem *item);
     /** @brief Create a rendering profile from MLT preset. */
     QTreeWidgetItem *loadFromMltPreset(const QString &groupName, const QString &path, QString profileName, bool codecInName = false);
@@ -52,10 +52,14 @@ static bool isPlatformRelative(QString filePath, bool *platformChange)
     return true;
 }
 
-DocumentChecker::DocumentChecker(QUrl url, const QDomDocument &doc)
+DocumentChecker::DocumentChecker(QUrl url, const QDomDocument &doc, const DocumentIndex &index)
     : m_url(std::move(url))
     , m_doc(doc)
+    , m_index(index)
 {
+    if (m_index.isEmpty()) {
+        m_index.rebuild(m_doc);
+    }
 
     QDomElement baseElement = m_doc.documentElement();
     m_root = baseElement.attribute(QStringLiteral("root"));
@@ -179,52 +183,48 @@ bool DocumentChecker::hasErrorInProject()
 
     QString storageFolder;
     QDir projectDir(m_url.adjusted(QUrl::RemoveFilename).toLocalFile());
-    QDomNodeList playlists = m_doc.elementsByTagName(QStringLiteral("playlist"));
-    for (int i = 0; i < playlists.count(); ++i) {
-        if (playlists.at(i).toElement().attribute(QStringLiteral("id")) == BinPlaylist::binPlaylistId) {
-            QDomElement mainBinPlaylist = playlists.at(i).toElement();
-
-            // ensure the documentid is valid
-            m_documentid = Xml::getXmlProperty(mainBinPlaylist, QStringLiteral("kdenlive:docproperties.documentid"));
-            if (m_documentid.isEmpty()) {
-                // invalid document id, recreate one
-                m_documentid = QString::number(QDateTime::currentMSecsSinceEpoch());
-                Xml::setXmlProperty(mainBinPlaylist, QStringLiteral("kdenlive:docproperties.documentid"), m_documentid);
+    QDomElement mainBinPlaylist = m_index.elementById(QStringLiteral("playlist"), BinPlaylist::binPlaylistId);
+    if (!mainBinPlaylist.isNull()) {
+        // ensure the documentid is valid
+        m_documentid = Xml::getXmlProperty(mainBinPlaylist, QStringLiteral("kdenlive:docproperties.documentid"));
+        if (m_documentid.isEmpty()) {
+            // invalid document id, recreate one
+            m_documentid = QString::number(QDateTime::currentMSecsSinceEpoch());
+            Xml::setXmlProperty(mainBinPlaylist, QStringLiteral("kdenlive:docproperties.documentid"), m_documentid);
+            m_doc.documentElement().setAttribute(QStringLiteral("modified"), 1);
+            m_warnings.append(i18n("The document id of your project was invalid, a new one has been created."));
+        }
+
+        // ensure the storage for temp files exists
+        storageFolder = Xml::getXmlProperty(mainBinPlaylist, QStringLiteral("kdenlive:docproperties.storagefolder"));
+        storageFolder = ensureAbsolutePath(storageFolder);
+        if (!storageFolder.isEmpty() && !QFile::exists(storageFolder)) {
+            if (projectDir.mkpath(m_documentid)) {
+                // Move storage folder inside the document folder
+                storageFolder = projectDir.absolutePath();
+                Xml::setXmlProperty(mainBinPlaylist, QStringLiteral("kdenlive:docproperties.storagefolder"), projectDir.absoluteFilePath(m_documentid));
+                m_doc.documentElement().setAttribute(QStringLiteral("modified"), 1);
+            } else {
+                // Cannot create storage folder, use default location
+                Xml::removeXmlProperty(mainBinPlaylist, QStringLiteral("kdenlive:docproperties.storagefolder"));
                 m_doc.documentElement().setAttribute(QStringLiteral("modified"), 1);
-                m_warnings.append(i18n("The document id of your project was invalid, a new one has been created."));
-            }
-
-            // ensure the storage for temp files exists
-            storageFolder = Xml::getXmlProperty(mainBinPlaylist, QStringLiteral("kdenlive:docproperties.storagefolder"));
-            storageFolder = ensureAbsolutePath(storageFolder);
-            if (!storageFolder.isEmpty() && !QFile::exists(storageFolder)) {
-                if (projectDir.mkpath(m_documentid)) {
-                    // Move storage folder inside the document folder
-                    storageFolder = projectDir.absolutePath();
-                    Xml::setXmlProperty(mainBinPlaylist, QStringLiteral("kdenlive:docproperties.storagefolder"), projectDir.absoluteFilePath(m_documentid));
-                    m_doc.documentElement().setAttribute(QStringLiteral("modified"), 1);
-                } else {
-                    // Cannot create storage folder, use default location
-                    Xml::removeXmlProperty(mainBinPlaylist, QStringLiteral("kdenlive:docproperties.storagefolder"));
-                    m_doc.documentElement().setAttribute(QStringLiteral("modified"), 1);
-                }
             }
+        }
 
-            // get bin ids
-            m_binEntries = mainBinPlaylist.elementsByTagName(QLatin1String("entry"));
-            for (int i = 0; i < m_binEntries.count(); ++i) {
-                QDomElement e = m_binEntries.item(i).toElement();
-                m_binIds << e.attribute(QStringLiteral("producer"));
-            }
-            break;
+        // get bin ids
+        m_binEntries = mainBinPlaylist.elementsByTagName(QLatin1String("entry"));
+        for (int i = 0; i < m_binEntries.count(); ++i) {
+            QDomElement e = m_binEntries.item(i).toElement();
+            m_binIds << e.attribute(QStringLiteral("producer"));
         }
     }
 
-    QDomNodeList documentTractors = m_doc.elementsByTagName(QStringLiteral("tractor"));
-    QDomNodeList documentProducers = m_doc.elementsByTagName(QStringLiteral("producer"));
-    QDomNodeList documentChains = m_doc.elementsByTagName(QStringLiteral("chain"));
-    QDomNodeList entries = m_doc.elementsByTagName(QStringLiteral("entry"));
-    QDomNodeList transitions = m_doc.elementsByTagName(QStringLiteral("transition"));
+    // Snapshots of the document elements, the checks below modify the document which would invalidate live node lists
+    const QVector<QDomElement> &documentTractors = m_index.elements(QStringLiteral("tractor"));
+    const QVector<QDomElement> &documentProducers = m_index.elements(QStringLiteral("producer"));
+    const QVector<QDomElement> &documentChains = m_index.elements(QStringLiteral("chain"));
+    const QVector<QDomElement> &entries = m_index.elements(QStringLiteral("entry"));
+    const QVector<QDomElement> &transitions = m_index.elements(QStringLiteral("transition"));
     QMap<QString, QString> renamedEffects;
     renamedEffects.insert(QStringLiteral("frei0r.alpha0ps"), QStringLiteral("frei0r.alpha0ps_alpha0ps"));
     renamedEffects.insert(QStringLiteral("frei0r.alphaspot"), QStringLiteral("frei0r.alpha0ps_alphaspot"));
@@ -237,24 +237,18 @@ bool DocumentChecker::hasErrorInProject()
     Q_EMIT pCore->loadingMessageNewStage(i18n("Checking for missing items…"), taskCount);
 
     QStringList verifiedPaths;
-    int max = documentProducers.count();
-    for (int i = 0; i < max; ++i) {
-        QDomElement e = documentProducers.item(i).toElement();
+    for (QDomElement e : documentProducers) {
         verifiedPaths << getMissingProducers(e, entries, storageFolder);
         Q_EMIT pCore->loadingMessageIncrease();
     }
-    max = documentChains.count();
-    for (int i = 0; i < max; ++i) {
-        QDomElement e = documentChains.item(i).toElement();
+    for (QDomElement e : documentChains) {
         verifiedPaths << getMissingProducers(e, entries, storageFolder);
         Q_EMIT pCore->loadingMessageIncrease();
     }
     // Check that we don't have circular dependencies (a sequence embedding itself as a track / ptoducer
-    max = documentTractors.count();
     QStringList circularRefs;
-    for (int i = 0; i < max; ++i) {
+    for (QDomElement e : documentTractors) {
         Q_EMIT pCore->loadingMessageIncrease();
-        QDomElement e = documentTractors.item(i).toElement();
         const QString tractorName = e.attribute(QStringLiteral("id"));
         QDomNodeList tracks = e.elementsByTagName(QStringLiteral("track"));
         int maxTracks = tracks.count();
@@ -285,7 +279,7 @@ bool DocumentChecker::hasErrorInProject()
     }
 
     // Check existence of luma files
-    QStringList filesToCheck = getAssetsFilesByMltTag(m_doc, QStringLiteral("transition"), getLumaPairs());
+    QStringList filesToCheck = getAssetsFilesByMltTag(transitions, getLumaPairs());
     for (const QString &lumafile : qAsConst(filesToCheck)) {
         QString filePath = ensureAbsolutePath(lumafile);
 
@@ -327,7 +321,7 @@ bool DocumentChecker::hasErrorInProject()
         if (QFile::exists(fixedLuma)) {
             if (filePath.startsWith(QStringLiteral("/tmp/.mount_"))) {
                 // This is a luma in the Appimage, fix silently
-                fixAssetResource(transitions, getLumaPairs(), filePath, fixedLuma);
+                fixAssetResource(m_doc.elementsByTagName(QStringLiteral("transition")), getLumaPairs(), filePath, fixedLuma);
                 continue;
             }
             item.newFilePath = fixedLuma;
@@ -343,7 +337,7 @@ bool DocumentChecker::hasErrorInProject()
     }
 
     // Check for missing transitions (eg. not installed)
-    QStringList transtions = getAssetsServiceIds(m_doc, QStringLiteral("transition"));
+    QStringList transtions = getAssetsServiceIds(transitions);
     for (const QString &id : qAsConst(transtions)) {
         if (!TransitionsRepository::get()->exists(id) && !itemsContain(MissingType::Transition, id, MissingStatus::Remove)) {
             DocumentResource item;
@@ -355,7 +349,8 @@ bool DocumentChecker::hasErrorInProject()
     }
 
     // Check for missing filter assets
-    QStringList assetsToCheck = getAssetsFilesByMltTag(m_doc, QStringLiteral("filter"), getAssetPairs());
+    const QVector<QDomElement> &documentFilters = m_index.elements(QStringLiteral("filter"));
+    QStringList assetsToCheck = getAssetsFilesByMltTag(documentFilters, getAssetPairs());
     for (const QString &filterfile : qAsConst(assetsToCheck)) {
         QString filePath = ensureAbsolutePath(filterfile);
 
@@ -383,7 +378,7 @@ bool DocumentChecker::hasErrorInProject()
     }
 
     // Check for missing effects (eg. not installed)
-    QStringList filters = getAssetsServiceIds(m_doc, QStringLiteral("filter"));
+    QStringList filters = getAssetsServiceIds(documentFilters);
     QStringList renamedEffectNames = renamedEffects.keys();
     for (const QString &id : qAsConst(filters)) {
         if (!EffectsRepository::get()->exists(id) && !itemsContain(MissingType::Effect, id, MissingStatus::Remove)) {
@@ -463,7 +458,7 @@ const QString DocumentChecker::relocateResource(QString sourceResource)
     return QString();
 }
 
-bool DocumentChecker::ensureProducerHasId(QDomElement &producer, const QDomNodeList &entries)
+bool DocumentChecker::ensureProducerHasId(QDomElement &producer, const QVector<QDomElement> &entries)
 {
     if (!Xml::getXmlProperty(producer, QStringLiteral("kdenlive:id")).isEmpty()) {
         // id is there, everything is fine
@@ -471,10 +466,8 @@ bool DocumentChecker::ensureProducerHasId(QDomElement &producer, const QDomNodeL
     }
 
     // This should not happen, try to recover the producer id
-    int max = entries.count();
     QString producerName = producer.attribute(QStringLiteral("id"));
-    for (int j = 0; j < max; j++) {
-        QDomElement e = entries.item(j).toElement();
+    for (const QDomElement &e : entries) {
         if (e.attribute(QStringLiteral("producer")) == producerName) {
             // Match found
             QString entryName = Xml::getXmlProperty(e, QStringLiteral("kdenlive:id"));
@@ -637,7 +630,7 @@ void DocumentChecker::checkMissingImagesAndFonts(const QStringList &images, cons
     }
 }
 
-QString DocumentChecker::getMissingProducers(QDomElement &e, const QDomNodeList &entries, const QString &storageFolder)
+QString DocumentChecker::getMissingProducers(QDomElement &e, const QVector<QDomElement> &entries, const QString &storageFolder)
 {
     QString service = Xml::getXmlProperty(e, QStringLiteral("mlt_service"));
     QStringList serviceToCheck = {QStringLiteral("kdenlivetitle"), QStringLiteral("qimage"),  QStringLiteral("pixbuf"), QStringLiteral("timewarp"),
@@ -1102,14 +1095,11 @@ QString DocumentChecker::ensureAbsolutePath(QString filepath)
     return filepath;
 }
 
-QStringList DocumentChecker::getAssetsFilesByMltTag(const QDomDocument &doc, const QString &tagName, const QMap<QString, QString> &searchPairs)
+QStringList DocumentChecker::getAssetsFilesByMltTag(const QVector<QDomElement> &assets, const QMap<QString, QString> &searchPairs)
 {
     QStringList files;
 
-    QDomNodeList assets = doc.elementsByTagName(tagName);
-    int max = assets.count();
-    for (int i = 0; i < max; ++i) {
-        QDomElement asset = assets.at(i).toElement();
+    for (const QDomElement &asset : assets) {
         const QString service = Xml::getXmlProperty(asset, QStringLiteral("mlt_service"));
         if (searchPairs.contains(service)) {
             const QString filepath = Xml::getXmlProperty(asset, searchPairs.value(service));
@@ -1124,11 +1114,13 @@ QStringList DocumentChecker::getAssetsFilesByMltTag(const QDomDocument &doc, con
 
 QStringList DocumentChecker::getAssetsServiceIds(const QDomDocument &doc, const QString &tagName)
 {
-    QDomNodeList filters = doc.elementsByTagName(tagName);
-    int max = filters.count();
+    return getAssetsServiceIds(DocumentIndex(doc).elements(tagName));
+}
+
+QStringList DocumentChecker::getAssetsServiceIds(const QVector<QDomElement> &assets)
+{
     QStringList services;
-    for (int i = 0; i < max; ++i) {
-        QDomElement filter = filters.at(i).toElement();
+    for (const QDomElement &filter : assets) {
         QString service = Xml::getXmlProperty(filter, QStringLiteral("kdenlive_id"));
         if (service.isEmpty()) {
             service = Xml::getXmlProperty(filter, QStringLiteral("mlt_service"));
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "definitions.h"
+#include "documentindex.h"
 #include "ui_missingclips_ui.h"
 
 #include <QDir>
@@ -32,7 +33,8 @@ public:
         ClipType::ProducerType clipType;
     };
 
-    explicit DocumentChecker(QUrl url, const QDomDocument &doc);
+    /** @param index an index of @param doc built by a previous loading pass, the document is indexed again if it is empty */
+    explicit DocumentChecker(QUrl url, const QDomDocument &doc, const DocumentIndex &index = DocumentIndex());
     ~DocumentChecker() override;
     /**
      * @brief checks for problems with the project
@@ -61,6 +63,7 @@ public:
 private:
     QUrl m_url;
     QDomDocument m_doc;
+    DocumentIndex m_index;
     QString m_documentid;
     QString m_root;
     QPair<QString, QString> m_rootReplacement;
@@ -84,7 +87,7 @@ private:
     /** @brief Check if the producer has an id. If not (should not happen, but...) try to recover it
      *  @returns true if the producer has been changed (id recovered), false if it was either already okay or could not be recovered
      */
-    bool ensureProducerHasId(QDomElement &producer, const QDomNodeList &entries);
+    bool ensureProducerHasId(QDomElement &producer, const QVector<QDomElement> &entries);
     /** @brief Check if the producer represents an "invalid" placeholder (project saved with missing source). If such a placeholder is detected, it tries to
      * recover the original clip.
      *  @returns true if the producer has been changed (recovered), false if it was either already okay or could not be recovered
@@ -92,7 +95,7 @@ private:
     bool ensureProducerIsNotPlaceholder(QDomElement &producer);
 
     /** @brief Check for various missing elements */
-    QString getMissingProducers(QDomElement &e, const QDomNodeList &entries, const QString &storageFolder);
+    QString getMissingProducers(QDomElement &e, const QVector<QDomElement> &entries, const QString &storageFolder);
     /** @brief Check if images and fonts in this clip exists, returns a list of images that do exist so we don't check twice. */
     void checkMissingImagesAndFonts(const QStringList &images, const QStringList &fonts, const QString &id);
     /** @brief If project path changed, try to relocate its resources */
@@ -101,8 +104,9 @@ private:
     static ClipType::ProducerType getClipType(const QString &service, const QString &resource);
     QString getProducerResource(const QDomElement &producer);
     static QString getKdenliveClipId(const QDomElement &producer);
-    static QStringList getAssetsFilesByMltTag(const QDomDocument &doc, const QString &tagName, const QMap<QString, QString> &searchPairs);
+    static QStringList getAssetsFilesByMltTag(const QVector<QDomElement> &assets, const QMap<QString, QString> &searchPairs);
     static QStringList getAssetsServiceIds(const QDomDocument &doc, const QString &tagName);
+    static QStringList getAssetsServiceIds(const QVector<QDomElement> &assets);
 
     QStringList getInfoMessages();
 
@@ -0,0 +1,62 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+
+SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "documentindex.h"
+
+DocumentIndex::DocumentIndex(const QDomDocument &doc)
+{
+    rebuild(doc);
+}
+
+void DocumentIndex::rebuild(const QDomDocument &doc)
+{
+    m_elements.clear();
+    const QString propertyTag = QStringLiteral("property");
+    // Depth first walk, so that each list is in the same order as elementsByTagName
+    QDomElement root = doc.documentElement();
+    QDomElement current = root;
+    while (!current.isNull()) {
+        const QString tag = current.tagName();
+        if (tag != propertyTag) {
+            m_elements[tag].append(current);
+        }
+        QDomElement next = current.firstChildElement();
+        if (next.isNull() && current != root) {
+            next = current.nextSiblingElement();
+            QDomElement parent = current;
+            while (next.isNull()) {
+                parent = parent.parentNode().toElement();
+                if (parent.isNull() || parent == root) {
+                    break;
+                }
+                next = parent.nextSiblingElement();
+            }
+        }
+        current = next;
+    }
+}
+
+const QVector<QDomElement> &DocumentIndex::elements(const QString &tagName) const
+{
+    static const QVector<QDomElement> empty;
+    auto it = m_elements.constFind(tagName);
+    return it == m_elements.constEnd() ? empty : it.value();
+}
+
+QDomElement DocumentIndex::elementById(const QString &tagName, const QString &id) const
+{
+    for (const QDomElement &e : elements(tagName)) {
+        if (e.attribute(QStringLiteral("id")) == id) {
+            return e;
+        }
+    }
+    return QDomElement();
+}
+
+bool DocumentIndex::isEmpty() const
+{
+    return m_elements.isEmpty();
+}
@@ -0,0 +1,40 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+
+SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QDomDocument>
+#include <QDomElement>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+/** @class DocumentIndex
+    @brief Collects the elements of a project document by tag name in a single traversal of the tree.
+    The validation of current documents and the checker passes iterate these lists instead of querying the document
+    with elementsByTagName, which walks the whole tree again each time and on every access once the document was modified.
+    The upgrade of documents from older versions still uses elementsByTagName, since it adds, removes and moves elements
+    between its steps; the index is rebuilt once it is done.
+    Unlike a QDomNodeList, the index is a snapshot: rebuild() has to be called after elements were added or removed.
+    Property elements are not indexed.
+ */
+class DocumentIndex
+{
+public:
+    DocumentIndex() = default;
+    explicit DocumentIndex(const QDomDocument &doc);
+
+    /** @brief Index all elements of @param doc, replacing the previous content */
+    void rebuild(const QDomDocument &doc);
+    /** @brief Returns the elements with @param tagName, in document order */
+    const QVector<QDomElement> &elements(const QString &tagName) const;
+    /** @brief Returns the first element with @param tagName having the id attribute @param id, or a null element */
+    QDomElement elementById(const QString &tagName, const QString &id) const;
+    bool isEmpty() const;
+
+private:
+    QHash<QString, QVector<QDomElement>> m_elements;
+};
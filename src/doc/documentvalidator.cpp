@@ -25,6 +25,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 
 #include <mlt++/Mlt.h>
 
+#include <algorithm>
 #include <locale>
 #ifdef Q_OS_MAC
 #include <xlocale.h>
@@ -61,14 +62,14 @@ QPair<bool, QString> DocumentValidator::validate(const double currentVersion)
     } else if (rootDir.isEmpty()) {
         mlt.setAttribute(QStringLiteral("root"), m_url.adjusted(QUrl::RemoveFilename | QUrl::StripTrailingSlash).toLocalFile());
     }
+    m_index.rebuild(m_doc);
 
     QLocale documentLocale = QLocale::c(); // Document locale for conversion. Previous MLT / Kdenlive versions used C locale by default
     QDomElement main_playlist;
-    QDomNodeList playlists = m_doc.elementsByTagName(QStringLiteral("playlist"));
-    for (int i = 0; i < playlists.count(); i++) {
-        if (playlists.at(i).toElement().attribute(QStringLiteral("id")) == QLatin1String("main bin") ||
-            playlists.at(i).toElement().attribute(QStringLiteral("id")) == QLatin1String("main_bin")) {
-            main_playlist = playlists.at(i).toElement();
+    for (const QDomElement &playlist : m_index.elements(QStringLiteral("playlist"))) {
+        const QString playlistId = playlist.attribute(QStringLiteral("id"));
+        if (playlistId == QLatin1String("main bin") || playlistId == QLatin1String("main_bin")) {
+            main_playlist = playlist;
             break;
         }
     }
@@ -140,16 +141,10 @@ QPair<bool, QString> DocumentValidator::validate(const double currentVersion)
     qDebug() << "FOUND MLT PROJECT VERSION: " << mltMajorVersion << " / " << mltServiceVersion << " / " << mltPatchVersion;
     if (mltMajorVersion <= 7 && mltServiceVersion <= 15) {
         // MLT <= 7.15.0 used the mute_on_pause property that is now deprecated and breaks audio playback so remove it
-        QDomNodeList producers = m_doc.elementsByTagName(QStringLiteral("producer"));
-        QDomNodeList chains = m_doc.elementsByTagName(QStringLiteral("chain"));
-        int max = producers.count();
-        for (int i = 0; i < max; ++i) {
-            QDomElement t = producers.at(i).toElement();
+        for (QDomElement t : m_index.elements(QStringLiteral("producer"))) {
             Xml::removeXmlProperty(t, QStringLiteral("mute_on_pause"));
         }
-        max = chains.count();
-        for (int i = 0; i < max; ++i) {
-            QDomElement t = chains.at(i).toElement();
+        for (QDomElement t : m_index.elements(QStringLiteral("chain"))) {
             Xml::removeXmlProperty(t, QStringLiteral("mute_on_pause"));
         }
     }
@@ -167,6 +162,10 @@ QPair<bool, QString> DocumentValidator::validate(const double currentVersion)
     if (version < 1.00) {
         changedDecimalPoint = upgradeTo100(documentLocale);
     }
+    if (version < currentVersion) {
+        // The upgrade may have added, removed or replaced elements
+        m_index.rebuild(m_doc);
+    }
 
     return QPair<bool, QString>(true, changedDecimalPoint);
 }
@@ -2227,10 +2226,23 @@ bool DocumentValidator::isModified() const
     return m_modified;
 }
 
+const DocumentIndex &DocumentValidator::index() const
+{
+    return m_index;
+}
+
 bool DocumentValidator::checkMovit()
 {
-    QString playlist = m_doc.toString();
-    if (!playlist.contains(QStringLiteral("movit."))) {
+    if (m_index.isEmpty()) {
+        m_index.rebuild(m_doc);
+    }
+    const QString movitPrefix = QStringLiteral("movit.");
+    auto usesMovit = [&movitPrefix](const QDomElement &e) {
+        return e.attribute(QStringLiteral("id")).startsWith(movitPrefix) || Xml::getXmlProperty(e, QStringLiteral("mlt_service")).startsWith(movitPrefix);
+    };
+    const QVector<QDomElement> &filters = m_index.elements(QStringLiteral("filter"));
+    const QVector<QDomElement> &transitions = m_index.elements(QStringLiteral("transition"));
+    if (std::none_of(filters.cbegin(), filters.cend(), usesMovit) && std::none_of(transitions.cbegin(), transitions.cend(), usesMovit)) {
         // Project does not use Movit GLSL effects, we can load it
         return true;
     }
@@ -2255,10 +2267,7 @@ bool DocumentValidator::checkMovit()
     }
 
     // Parse all effects in document
-    QDomNodeList filters = m_doc.elementsByTagName(QStringLiteral("filter"));
-    int max = filters.count();
-    for (int i = 0; i < max; ++i) {
-        QDomElement filt = filters.at(i).toElement();
+    for (QDomElement filt : filters) {
         QString filterId = filt.attribute(QStringLiteral("id"));
         if (!filterId.startsWith(QLatin1String("movit."))) {
             continue;
@@ -2307,10 +2316,7 @@ bool DocumentValidator::checkMovit()
     }
 
     // Parse all transitions in document
-    QDomNodeList transitions = m_doc.elementsByTagName(QStringLiteral("transition"));
-    max = transitions.count();
-    for (int i = 0; i < max; ++i) {
-        QDomElement t = transitions.at(i).toElement();
+    for (QDomElement t : transitions) {
         QString transId = Xml::getXmlProperty(t, QStringLiteral("mlt_service"));
         if (!transId.startsWith(QLatin1String("movit."))) {
             continue;
@@ -2339,6 +2345,7 @@ bool DocumentValidator::checkMovit()
     QString scene = m_doc.toString();
     scene.replace(QLatin1String("movit."), QString());
     m_doc.setContent(scene);
+    m_index.rebuild(m_doc);
     return true;
 }
 
@@ -6,6 +6,8 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 
 #pragma once
 
+#include "documentindex.h"
+
 #include <QColor>
 #include <QDomDocument>
 
@@ -30,9 +32,12 @@ public:
     bool isModified() const;
     /** @brief Check if the project contains references to Movit stuff (GLSL), and try to convert if wanted. */
     bool checkMovit();
+    /** @brief The index of the validated document, kept up to date with the changes made by the validator so it can be reused by the next loading passes */
+    const DocumentIndex &index() const;
 
 private:
     QDomDocument m_doc;
+    DocumentIndex m_index;
     QUrl m_url;
     bool m_modified;
     /** @brief Upgrade from a previous Kdenlive document version. */
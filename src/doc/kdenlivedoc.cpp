@@ -43,6 +43,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "kdenlive_debug.h"
 #include <QCryptographicHash>
 #include <QDomImplementation>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QFileDialog>
 #include <QJsonArray>
@@ -155,6 +156,9 @@ DocOpenResult KdenliveDoc::Open(const QUrl &url, const QString &projectFolder, Q
 {
 
     DocOpenResult result = DocOpenResult{};
+    QList<QPair<QString, qint64>> loadingTimes;
+    QElapsedTimer stageTimer;
+    stageTimer.start();
 
     if (url.isEmpty() || !url.isValid()) {
         result.setError(i18n("Invalid file path"));
@@ -218,7 +222,7 @@ DocOpenResult KdenliveDoc::Open(const QUrl &url, const QString &projectFolder, Q
         }
     }
     file.close();
-
+    loadingTimes << qMakePair(QStringLiteral("parse"), stageTimer.restart());
 
     qCDebug(KDENLIVE_LOG) << "// validating project file";
     DocumentValidator validator(domDoc, url);
@@ -249,7 +253,10 @@ DocOpenResult KdenliveDoc::Open(const QUrl &url, const QString &projectFolder, Q
         return result;
     }
 
-    DocumentChecker d(url, domDoc);
+    loadingTimes << qMakePair(QStringLiteral("validate"), stageTimer.restart());
+
+    // Reuse the validator's index, so that the document is not walked again
+    DocumentChecker d(url, domDoc, validator.index());
 
     if (d.hasErrorInProject()) {
         if (pCore->window() == nullptr) {
@@ -271,8 +278,14 @@ DocOpenResult KdenliveDoc::Open(const QUrl &url, const QString &projectFolder, Q
         return result;
     }
 
+    // The checker stage includes the time spent by the user in the missing items dialog
+    loadingTimes << qMakePair(QStringLiteral("check"), stageTimer.restart());
+
     // create KdenliveDoc object
     auto doc = std::unique_ptr<KdenliveDoc>(new KdenliveDoc(url, domDoc, projectFolder, undoGroup, parent));
+    for (const auto &stage : qAsConst(loadingTimes)) {
+        doc->addLoadingTime(stage.first, stage.second);
+    }
     if (!validationResult.second.isEmpty()) {
         doc->m_modifiedDecimalPoint = validationResult.second;
         //doc->setModifiedDecimalPoint(validationResult.second);
@@ -431,11 +444,39 @@ int KdenliveDoc::clipsCount() const
     return m_clipsCount;
 }
 
+void KdenliveDoc::addLoadingTime(const QString &stage, qint64 duration)
+{
+    qCDebug(KDENLIVE_LOG) << "Project loading stage" << stage << "took" << duration << "ms";
+    m_loadingTimes << qMakePair(stage, duration);
+}
+
+const QList<QPair<QString, qint64>> &KdenliveDoc::loadingTimes() const
+{
+    return m_loadingTimes;
+}
+
+const QString KdenliveDoc::loadingTimesSummary() const
+{
+    const QMap<QString, QString> stageNames = {{QStringLiteral("parse"), i18nc("@info:status project loading stage", "parsing")},
+                                               {QStringLiteral("validate"), i18nc("@info:status project loading stage", "validation")},
+                                               {QStringLiteral("check"), i18nc("@info:status project loading stage", "clip check")},
+                                               {QStringLiteral("mlt"), i18nc("@info:status project loading stage", "MLT")},
+                                               {QStringLiteral("timeline"), i18nc("@info:status project loading stage", "timeline")}};
+    qint64 total = 0;
+    QStringList stages;
+    for (const auto &stage : m_loadingTimes) {
+        total += stage.second;
+        stages << i18nc("@info:status loading stage name and its duration", "%1 %2 ms", stageNames.value(stage.first, stage.first), stage.second);
+    }
+    return i18n("Project loaded in %1 ms (%2)", total, stages.join(QStringLiteral(", ")));
+}
+
 const QByteArray KdenliveDoc::getAndClearProjectXml()
 {
     // Profile has already been set, dont overwrite it
     m_document.documentElement().removeChild(m_document.documentElement().firstChildElement(QLatin1String("profile")));
-    const QByteArray result = m_document.toString().toUtf8();
+    // MLT only parses text, so serialize without indentation to keep the string MLT has to read as small as possible
+    const QByteArray result = m_document.toByteArray(-1);
     // We don't need the xml data anymore, throw away
     m_document.clear();
     return result;
@@ -567,8 +608,9 @@ bool KdenliveDoc::autoGenerateImageProxy(int width) const
            (width < 0 || width > m_documentProperties.value(QStringLiteral("proxyimageminsize")).toInt());
 }
 
-void KdenliveDoc::slotAutoSave(const QString &scene)
+void KdenliveDoc::slotAutoSave(QString scene, const QMap<QString, QString> &replacements)
 {
+    // Running in a worker thread, only use thread safe methods to report errors
     if (m_autosave != nullptr) {
         if (!m_autosave->isOpen() && !m_autosave->open(QIODevice::ReadWrite)) {
             // show error: could not open the autosave file
@@ -578,7 +620,18 @@ void KdenliveDoc::slotAutoSave(const QString &scene)
         }
         if (scene.isEmpty()) {
             // Make sure we don't save if scenelist is corrupted
-            KMessageBox::error(QApplication::activeWindow(), i18n("Cannot write to file %1, scene list is corrupted.", m_autosave->fileName()));
+            pCore->displayMessage(i18n("Cannot write to file %1, scene list is corrupted.", m_autosave->fileName()), ErrorMessage);
+            return;
+        }
+        QMapIterator<QString, QString> i(replacements);
+        while (i.hasNext()) {
+            i.next();
+            scene.replace(i.key(), i.value());
+        }
+        if (!scene.contains(QLatin1String("<track "))) {
+            // In some unexplained cases, the MLT playlist is corrupted and all tracks are deleted. Don't save in that case.
+            pCore->displayMessage(i18n("Project was corrupted, cannot backup. Please close and reopen your project file to recover last backup"),
+                                  ErrorMessage);
             return;
         }
         m_autosave->resize(0);
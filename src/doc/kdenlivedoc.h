@@ -266,6 +266,12 @@ public:
      */
     QString &modifiedDecimalPoint();
     void setModifiedDecimalPoint(const QString &decimalPoint) { m_modifiedDecimalPoint = decimalPoint; }
+    /** @brief Record the duration of a project loading stage, in milliseconds */
+    void addLoadingTime(const QString &stage, qint64 duration);
+    /** @brief Returns the duration of each loading stage of this project, in the order they ran */
+    const QList<QPair<QString, qint64>> &loadingTimes() const;
+    /** @brief Returns a translated summary of the loading stages durations, to be displayed once the project is loaded */
+    const QString loadingTimesSummary() const;
     /** @brief Get the list of secondary timelines uuid */
     const QStringList getSecondaryTimelines() const;
 
@@ -374,6 +380,7 @@ private:
     QSet<QUuid> m_sequenceThumbsNeedsRefresh;
 
     QString m_modifiedDecimalPoint;
+    QList<QPair<QString, qint64>> m_loadingTimes;
     /** @brief A list of guide models for this project (one for each timeline). */
     QMap<QUuid, std::shared_ptr<TimelineItemModel>> m_timelines;
     QString searchFileRecursively(const QDir &dir, const QString &matchSize, const QString &matchHash) const;
@@ -407,8 +414,10 @@ public Q_SLOTS:
                               QUndoCommand *masterCommand = nullptr);
     /** @brief Saves the current project at the autosave location.
      *
-     * The autosave files are in ~/.kde/data/stalefiles/kdenlive/ */
-    void slotAutoSave(const QString &scene);
+     * The autosave files are in ~/.kde/data/stalefiles/kdenlive/
+     * This is called from a worker thread, ProjectManager ensures that only one backup is written at a time.
+     * @param replacements strings to replace in the scene before writing it */
+    void slotAutoSave(QString scene, const QMap<QString, QString> &replacements = {});
     void switchProfile(ProfileParam* pf, const QString &clipName);
 
 private Q_SLOTS:
@@ -26,11 +26,18 @@ EffectItemModel::EffectItemModel(const QList<QVariant> &effectData, std::unique_
             return;
         }
         // qDebug() << "* * *SETTING EFFECT PARAM: " << name << " = " << m_asset->get(name.toUtf8().constData());
+        // Read the values once, each instance then only gets the property writes
+        QVector<QPair<QByteArray, QByteArray>> values;
+        values.reserve(names.size());
+        for (const QString &name : names) {
+            const QByteArray key = name.toUtf8();
+            values.append({key, QByteArray(m_asset->get(key.constData()))});
+        }
         QMapIterator<int, std::shared_ptr<EffectItemModel>> i(m_childEffects);
         while (i.hasNext()) {
             i.next();
-            for (const QString &name : names) {
-                i.value()->filter().set(name.toUtf8().constData(), m_asset->get(name.toUtf8().constData()));
+            for (const auto &value : qAsConst(values)) {
+                i.value()->filter().set(value.first.constData(), value.second.isNull() ? nullptr : value.second.constData());
             }
         }
     });
@@ -44,6 +44,7 @@ AbstractTask::AbstractTask(const ObjectId &owner, JOBTYPE type, QObject *object)
     , m_isForce(false)
     , m_running(false)
     , m_type(type)
+    , m_sequence(0)
 {
     setAutoDelete(false);
     m_uuid = QUuid::createUuid();
@@ -51,16 +52,25 @@ AbstractTask::AbstractTask(const ObjectId &owner, JOBTYPE type, QObject *object)
     case AbstractTask::LOADJOB:
         m_priority = 10;
         break;
+    case AbstractTask::THUMBJOB:
+        m_priority = 9;
+        break;
     case AbstractTask::TRANSCODEJOB:
     case AbstractTask::PROXYJOB:
         m_priority = 8;
         break;
+    case AbstractTask::AUDIOTHUMBJOB:
+        m_priority = 7;
+        break;
     case AbstractTask::FILTERCLIPJOB:
     case AbstractTask::STABILIZEJOB:
     case AbstractTask::ANALYSECLIPJOB:
     case AbstractTask::SPEEDJOB:
         m_priority = 5;
         break;
+    case AbstractTask::CACHEJOB:
+        m_priority = 3;
+        break;
     default:
         m_priority = 5;
         break;
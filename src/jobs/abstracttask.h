@@ -60,6 +60,8 @@ private:
     //QString cacheKey();
     JOBTYPE m_type;
     int m_priority;
+    /** @brief Insertion order in the TaskManager queue, used to keep FIFO order between tasks of equal priority */
+    quint64 m_sequence;
     void cancelJob(bool softDelete = false);
     bool isCanceled() const;
 
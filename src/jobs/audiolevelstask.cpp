@@ -6,23 +6,25 @@
 */
 
 #include "audiolevelstask.h"
+#include "audio/audioLevelsCache.h"
+#include "audio/audioLevelsPyramid.h"
 #include "audio/audioStreamInfo.h"
 #include "bin/projectclip.h"
 #include "bin/projectitemmodel.h"
 #include "core.h"
+#include "utils/cachemanager.hpp"
 
 #include <KLocalizedString>
 #include <KMessageWidget>
 #include <QElapsedTimer>
 #include <QFile>
-#include <QImage>
 #include <QList>
 #include <QMutex>
-#include <QRgb>
 #include <QString>
 #include <QThreadPool>
 #include <QTime>
 #include <QVariantList>
+#include <algorithm>
 
 static QList<AudioLevelsTask *> tasksList;
 static QMutex tasksListMutex;
@@ -32,6 +34,11 @@ static void deleteQVariantList(QVector<uint8_t> *list)
     delete list;
 }
 
+static void deletePyramid(std::shared_ptr<AudioLevelsPyramid> *pyramid)
+{
+    delete pyramid;
+}
+
 AudioLevelsTask::AudioLevelsTask(const ObjectId &owner, QObject *object)
     : AbstractTask(owner, AbstractTask::AUDIOTHUMBJOB, object)
 {
@@ -113,30 +120,40 @@ void AudioLevelsTask::run()
         // Generate one thumb per stream
         QString cachePath = binClip->getAudioThumbPath(stream);
         QVector<uint8_t> mltLevels;
-        if (!m_isForce && QFile::exists(cachePath)) {
-            // Audio thumb already exists
-            QImage image(cachePath);
-            if (!m_isCanceled && !image.isNull()) {
-                // convert cached image
-                int n = image.width() * image.height();
-                for (int i = 0; n > 1 && i < n; i++) {
-                    QRgb p = image.pixel(i / channels, i % channels);
-                    mltLevels << qRed(p);
-                    mltLevels << qGreen(p);
-                    mltLevels << qBlue(p);
-                    mltLevels << qAlpha(p);
-                }
-                if (mltLevels.size() > 0) {
-                    QVector<uint8_t> *levelsCopy = new QVector<uint8_t>(mltLevels);
-                    producer = binClip->originalProducer();
-                    producer->lock();
-                    QString key = QString("_kdenlive:audio%1").arg(stream);
-                    producer->set(key.toUtf8().constData(), levelsCopy, 0, (mlt_destructor)deleteQVariantList);
-                    producer->unlock();
-                    producer.reset();
-                    continue;
+        if (!m_isForce && !m_isCanceled) {
+            // Check if audio levels were already cached
+            AudioLevelsCache::Header header;
+            bool cached = AudioLevelsCache::read(cachePath, channels, pCore->getCurrentFps(), mltLevels, &header);
+            if (!cached) {
+                // Convert the image cached by previous versions
+                const QString legacyPath = binClip->getAudioThumbPath(stream, true);
+                if (QFile::exists(legacyPath) && AudioLevelsCache::readLegacyImage(legacyPath, channels, mltLevels)) {
+                    header.maxLevel = *std::max_element(mltLevels.constBegin(), mltLevels.constEnd());
+                    if (AudioLevelsCache::write(cachePath, mltLevels, channels, pCore->getCurrentFps(), stream, int(header.maxLevel))) {
+                        QFile::remove(legacyPath);
+                        CacheManager::get()->forget(legacyPath);
+                        CacheManager::get()->recordStore(CacheAudio, cachePath);
+                    }
+                    cached = true;
                 }
             }
+            CacheManager::get()->recordAccess(CacheAudio, cachePath, cached && mltLevels.size() > 0);
+            if (cached && mltLevels.size() > 0) {
+                QVector<uint8_t> *levelsCopy = new QVector<uint8_t>(std::move(mltLevels));
+                producer = binClip->originalProducer();
+                producer->lock();
+                QString key = QString("_kdenlive:audio%1").arg(stream);
+                QString key2 = QString("kdenlive:audio_max%1").arg(stream);
+                QString key3 = QString("_kdenlive:audiopyramid%1").arg(stream);
+                auto *pyramid = new std::shared_ptr<AudioLevelsPyramid>(new AudioLevelsPyramid(*levelsCopy, channels));
+                producer->set(key2.toUtf8().constData(), int(qMax(1u, header.maxLevel)));
+                producer->set(key.toUtf8().constData(), levelsCopy, 0, (mlt_destructor)deleteQVariantList);
+                producer->set(key3.toUtf8().constData(), pyramid, 0, (mlt_destructor)deletePyramid);
+                producer->unlock();
+                producer.reset();
+                continue;
+            }
+            mltLevels.clear();
         }
 
         Mlt::Producer *aProd = new Mlt::Producer(pCore->getProjectProfile(), service.toUtf8().constData(), res.toUtf8().constData());
@@ -180,6 +197,7 @@ void AudioLevelsTask::run()
                 int samples = mlt_audio_calculate_frame_samples(float(framesPerSecond), frequency, z);
                 mltFrame->get_audio(audioFormat, frequency, channels, samples);
                 for (int channel = 0; channel < channels; ++channel) {
+                    // AudioEnvelope converts these values back to amplitudes, keep both in sync
                     uint lev = 256 * qMin(mltFrame->get_double(keys.at(channel).toUtf8().constData()) * 0.9, 1.0);
                     mltLevels << lev;
                     // double lev = mltFrame->get_double(keys.at(channel).toUtf8().constData());
@@ -220,32 +238,20 @@ void AudioLevelsTask::run()
             producer->lock();
             QString key = QString("_kdenlive:audio%1").arg(stream);
             QString key2 = QString("kdenlive:audio_max%1").arg(stream);
+            QString key3 = QString("_kdenlive:audiopyramid%1").arg(stream);
+            // Build the reduced levels used to draw zoomed out waveforms
+            auto *pyramid = new std::shared_ptr<AudioLevelsPyramid>(new AudioLevelsPyramid(mltLevels, channels));
             producer->set(key2.toUtf8().constData(), int(maxLevel));
             producer->set(key.toUtf8().constData(), levelsCopy, 0, (mlt_destructor)deleteQVariantList);
+            producer->set(key3.toUtf8().constData(), pyramid, 0, (mlt_destructor)deletePyramid);
             producer->unlock();
             producer.reset();
             // qDebug()<<"=== FINISHED PRODUCING AUDIO FOR: "<<key<<", SIZE: "<<levelsCopy->size();
             m_progress = 100;
             QMetaObject::invokeMethod(m_object, "updateJobProgress");
-            // Put into an image for caching.
-            int count = mltLevels.size();
-            QImage image((count + 3) / 4 / channels, channels, QImage::Format_ARGB32);
-            int n = image.width() * image.height();
-            for (int i = 0; i < n; i++) {
-                QRgb p;
-                if ((4 * i + 3) < count) {
-                    p = qRgba(mltLevels.at(4 * i), mltLevels.at(4 * i + 1), mltLevels.at(4 * i + 2), mltLevels.at(4 * i + 3));
-                } else {
-                    int last = mltLevels.last();
-                    int r = (4 * i + 0) < count ? mltLevels.at(4 * i + 0) : last;
-                    int g = (4 * i + 1) < count ? mltLevels.at(4 * i + 1) : last;
-                    int b = (4 * i + 2) < count ? mltLevels.at(4 * i + 2) : last;
-                    int a = last;
-                    p = qRgba(r, g, b, a);
-                }
-                image.setPixel(i / channels, i % channels, p);
+            if (AudioLevelsCache::write(cachePath, mltLevels, channels, framesPerSecond, stream, int(maxLevel))) {
+                CacheManager::get()->recordStore(CacheAudio, cachePath);
             }
-            image.save(cachePath);
             audioCreated = true;
             QMetaObject::invokeMethod(m_object, "updateAudioThumbnail", Q_ARG(bool, false));
         }
@@ -12,6 +12,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "doc/kthumb.h"
 #include "kdenlivesettings.h"
 #include "utils/thumbnailcache.hpp"
+#include "utils/thumbnailproducerpool.hpp"
 
 #include "xml/xml.hpp"
 #include <KLocalizedString>
@@ -51,7 +52,6 @@ void CacheTask::generateThumbnail(std::shared_ptr<ProjectClip> binClip)
 {
     // Fetch thumbnail
     if (binClip->clipType() != ClipType::Audio) {
-        std::unique_ptr<Mlt::Producer> thumbProd(nullptr);
         int duration = m_out > 0 ? m_out - m_in : binClip->getFramePlaytime();
         std::set<int> frames;
         int steps = qCeil(qMax(pCore->getCurrentFps(), double(duration) / m_thumbsCount));
@@ -60,39 +60,38 @@ void CacheTask::generateThumbnail(std::shared_ptr<ProjectClip> binClip)
             frames.insert(pos);
             pos = m_in + (steps * i);
         }
-        int size = int(frames.size());
-        int count = 0;
         const QString clipId = QString::number(m_owner.itemId);
+        std::vector<int> missing;
         for (int i : frames) {
+            if (!ThumbnailCache::get()->hasThumbnail(clipId, i)) {
+                missing.push_back(i);
+            }
+        }
+        if (missing.empty() || m_isCanceled || pCore->taskManager.isBlocked()) {
+            return;
+        }
+        ThumbnailProducerPool::Lease thumbProd = ThumbnailProducerPool::get()->acquire(binClip);
+        if (!thumbProd.isValid()) {
+            // Thumb producer not available
+            return;
+        }
+        int size = int(missing.size());
+        int count = 0;
+        // Extract all thumbnails in one pass so that the decoder only moves forward. Thumbnails are
+        // spaced by steps frames, so a frame slightly after the requested position is good enough
+        thumbProd.extractBatch(missing, steps / 10, 0, 0, m_fullWidth, [&](int pos, const QImage &result) {
+            count++;
             m_progress = 100 * count / size;
             QMetaObject::invokeMethod(m_object, "updateJobProgress");
-            count++;
             if (m_isCanceled || pCore->taskManager.isBlocked()) {
-                break;
-            }
-            if (ThumbnailCache::get()->hasThumbnail(clipId, i)) {
-                continue;
+                return false;
             }
-            if (thumbProd == nullptr) {
-                thumbProd = binClip->getThumbProducer();
+            if (!result.isNull()) {
+                qDebug() << "==== CACHING FRAME: " << pos;
+                ThumbnailCache::get()->storeThumbnail(clipId, pos, result, true);
             }
-            if (thumbProd == nullptr) {
-                // Thumb producer not available
-                break;
-            }
-            thumbProd->seek(i);
-            QScopedPointer<Mlt::Frame> frame(thumbProd->get_frame());
-            if (frame != nullptr && frame->is_valid()) {
-                frame->set("consumer.deinterlacer", "onefield");
-                frame->set("consumer.top_field_first", -1);
-                frame->set("consumer.rescale", "nearest");
-                QImage result = KThumb::getFrame(frame.data(), 0, 0, m_fullWidth);
-                if (!result.isNull() && !m_isCanceled) {
-                    qDebug() << "==== CACHING FRAME: " << i;
-                    ThumbnailCache::get()->storeThumbnail(clipId, i, result, true);
-                }
-            }
-        }
+            return true;
+        });
     }
 }
 
@@ -15,7 +15,9 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "kdenlivesettings.h"
 #include "mltcontroller/clipcontroller.h"
 #include "project/dialogs/slideshowclip.h"
+#include "utils/mediaprobecache.hpp"
 #include "utils/thumbnailcache.hpp"
+#include "utils/thumbnailproducerpool.hpp"
 
 #include "xml/xml.hpp"
 #include <KLocalizedString>
@@ -229,21 +231,9 @@ void ClipLoadTask::generateThumbnail(std::shared_ptr<ProjectClip> binClip, std::
             if (m_isCanceled.loadAcquire() || pCore->taskManager.isBlocked()) {
                 return;
             }
-            std::unique_ptr<Mlt::Producer> thumbProd = binClip->getThumbProducer();
-            if (thumbProd && thumbProd->is_valid()) {
-                if (binClip->clipType() != ClipType::Timeline && binClip->clipType() != ClipType::Playlist) {
-                    Mlt::Profile *prodProfile = &pCore->thumbProfile();
-                    Mlt::Filter scaler(*prodProfile, "swscale");
-                    Mlt::Filter padder(*prodProfile, "resize");
-                    Mlt::Filter converter(*prodProfile, "avcolor_space");
-                    thumbProd->attach(scaler);
-                    thumbProd->attach(padder);
-                    thumbProd->attach(converter);
-                }
-                if (frameNumber > 0) {
-                    thumbProd->seek(frameNumber);
-                }
-                std::unique_ptr<Mlt::Frame> frame(thumbProd->get_frame());
+            ThumbnailProducerPool::Lease thumbProd = ThumbnailProducerPool::get()->acquire(binClip);
+            if (thumbProd.isValid()) {
+                std::unique_ptr<Mlt::Frame> frame = thumbProd.getFrame(qMax(0, frameNumber));
                 if ((frame != nullptr) && frame->is_valid()) {
                     frame->set("consumer.deinterlacer", "onefield");
                     frame->set("consumer.top_field_first", -1);
@@ -306,6 +296,9 @@ void ClipLoadTask::run()
     QString resource = Xml::getXmlProperty(m_xml, QStringLiteral("resource"));
     qDebug() << "============STARTING LOAD TASK FOR: " << m_owner.itemId << " = " << resource << "\n\n:::::::::::::::::::";
     int duration = 0;
+    // The probed length is counted in frames of the project profile
+    const QByteArray probeFrameRate =
+        QByteArray::number(pCore->getProjectProfile().frame_rate_num()) + '/' + QByteArray::number(pCore->getProjectProfile().frame_rate_den());
     ClipType::ProducerType type = static_cast<ClipType::ProducerType>(m_xml.attribute(QStringLiteral("type")).toInt());
     QString service = Xml::getXmlProperty(m_xml, QStringLiteral("mlt_service"));
     if (type == ClipType::Unknown) {
@@ -317,6 +310,8 @@ void ClipLoadTask::run()
         service.clear();
     }
     std::shared_ptr<Mlt::Producer> producer;
+    // True if the avformat properties were restored from the probe cache instead of opening the file
+    bool probeCached = false;
     switch (type) {
     case ClipType::Color:
         producer = loadResource(resource, QStringLiteral("color:"));
@@ -446,6 +441,19 @@ void ClipLoadTask::run()
             if (service == QLatin1String("avformat-novalidate:")) {
                 service = QStringLiteral("avformat:");
             }
+            if (service == QLatin1String("avformat:")) {
+                const MediaProbeCache::Properties cached = MediaProbeCache::get()->properties(resource, probeFrameRate);
+                if (!cached.isEmpty()) {
+                    // The file did not change since it was probed, restore its properties without opening it
+                    producer = loadResource(resource, QStringLiteral("avformat-novalidate:"));
+                    for (const auto &property : cached) {
+                        producer->set(property.first.constData(), property.second.constData());
+                    }
+                    producer->set("out", producer->get_int("length") - 1);
+                    probeCached = true;
+                    break;
+                }
+            }
             producer = loadResource(resource, service);
         } else {
             producer = std::make_shared<Mlt::Producer>(pCore->getProjectProfile(), nullptr, resource.toUtf8().constData());
@@ -651,7 +659,9 @@ void ClipLoadTask::run()
             }
         }
         // Check audio / video
-        producer->probe();
+        if (!probeCached) {
+            producer->probe();
+        }
         hasAudio = producer->get_int("video_index") > -1;
         hasVideo = producer->get_int("audio_index") > -1;
         if (hasAudio) {
@@ -723,6 +733,18 @@ void ClipLoadTask::run()
                 fps = producer->get_double("source_fps");
             }
         }
+        // The producer may have been replaced by the original of an external proxy
+        if (!probeCached && !m_isCanceled.loadAcquire() && resource == QString(producer->get("resource"))) {
+            // Remember the probed properties for the next time this file is loaded
+            MediaProbeCache::Properties probed;
+            for (int i = 0; i < producer->count(); i++) {
+                const QByteArray name(producer->get_name(i));
+                if (MediaProbeCache::isProbeProperty(name)) {
+                    probed.append({name, QByteArray(producer->get(i))});
+                }
+            }
+            MediaProbeCache::get()->storeProperties(resource, probeFrameRate, probed);
+        }
     }
     if (fps <= 0 && type == ClipType::Unknown) {
         // something wrong, maybe audio file with embedded image
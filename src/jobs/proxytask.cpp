@@ -13,6 +13,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "kdenlive_debug.h"
 #include "kdenlivesettings.h"
 #include "macros.hpp"
+#include "utils/cachemanager.hpp"
 
 #include <QProcess>
 #include <QTemporaryFile>
@@ -57,11 +58,13 @@ void ProxyTask::run()
     QFileInfo fInfo(dest);
     if (binClip->getProducerIntProperty(QStringLiteral("_overwriteproxy")) == 0 && fInfo.exists() && fInfo.size() > 0) {
         // Proxy clip already created
+        CacheManager::get()->recordAccess(CacheProxy, fInfo.absoluteFilePath(), true);
         m_progress = 100;
         QMetaObject::invokeMethod(m_object, "updateJobProgress");
         QMetaObject::invokeMethod(binClip.get(), "updateProxyProducer", Qt::QueuedConnection, Q_ARG(QString, dest));
         return;
     }
+    CacheManager::get()->recordAccess(CacheProxy, dest, false);
 
     ClipType::ProducerType type = binClip->clipType();
     m_progress = 0;
@@ -403,6 +406,7 @@ void ProxyTask::run()
             }
         } else if (binClip) {
             // Job successful
+            CacheManager::get()->recordStore(CacheProxy, dest);
             QMetaObject::invokeMethod(binClip.get(), "updateProxyProducer", Qt::QueuedConnection, Q_ARG(QString, dest));
         }
     } else {
@@ -23,10 +23,12 @@ TaskManager::TaskManager(QObject *parent)
     , displayedClip(-1)
     , m_tasksListLock(QReadWriteLock::Recursive)
     , m_blockUpdates(false)
+    , m_taskSequence(0)
 {
-    int maxThreads = qMin(4, QThread::idealThreadCount() - 1);
-    m_taskPool.setMaxThreadCount(qMax(maxThreads, 1));
-    m_transcodePool.setMaxThreadCount(KdenliveSettings::proxythreads());
+    // Keep one core for the GUI, the rest is shared by all in process tasks
+    m_workerThreads = qMax(2, QThread::idealThreadCount() - 1);
+    // Proxy and transcode tasks mostly wait for an external process, give them their own slots
+    m_taskPool.setMaxThreadCount(m_workerThreads + typeBudget(AbstractTask::PROXYJOB));
 }
 
 TaskManager::~TaskManager()
@@ -41,7 +43,126 @@ bool TaskManager::isBlocked() const
 
 void TaskManager::updateConcurrency()
 {
-    m_transcodePool.setMaxThreadCount(KdenliveSettings::proxythreads());
+    m_taskPool.setMaxThreadCount(m_workerThreads + typeBudget(AbstractTask::PROXYJOB));
+    dispatchTasks();
+}
+
+int TaskManager::typeBudget(AbstractTask::JOBTYPE type) const
+{
+    switch (type) {
+    case AbstractTask::TRANSCODEJOB:
+    case AbstractTask::PROXYJOB:
+        // We only want a limited concurrent jobs for those as for example GPU usually only accept 2 concurrent encoding jobs
+        return qMax(1, KdenliveSettings::proxythreads());
+    case AbstractTask::LOADJOB:
+    case AbstractTask::THUMBJOB:
+        // Interactive tasks can use all workers
+        return m_workerThreads;
+    case AbstractTask::AUDIOTHUMBJOB:
+    case AbstractTask::CACHEJOB:
+        return qMax(1, m_workerThreads / 2);
+    default:
+        // Analysis tasks are heavy and not urgent
+        return qMax(1, m_workerThreads / 4);
+    }
+}
+
+int TaskManager::effectivePriority(const AbstractTask *task) const
+{
+    int priority = task->m_priority;
+    if (task->m_owner.itemId == displayedClip) {
+        priority += 20;
+    } else if (m_boostedClips.contains(task->m_owner.itemId)) {
+        priority += 10;
+    }
+    return priority;
+}
+
+void TaskManager::boostClip(int ownerId)
+{
+    QMutexLocker lk(&m_queueMutex);
+    if (!m_boostedClips.isEmpty() && m_boostedClips.constFirst() == ownerId) {
+        return;
+    }
+    m_boostedClips.removeAll(ownerId);
+    m_boostedClips.prepend(ownerId);
+    // Only remember the clips that were recently requested
+    while (m_boostedClips.size() > 64) {
+        m_boostedClips.removeLast();
+    }
+}
+
+void TaskManager::dispatchTasks()
+{
+    QMutexLocker lk(&m_queueMutex);
+    while (!m_pendingTasks.empty()) {
+        int running = 0;
+        int backgroundRunning = 0;
+        int transcodeRunning = 0;
+        for (const auto &r : m_runningTasks) {
+            if (r.first == AbstractTask::TRANSCODEJOB || r.first == AbstractTask::PROXYJOB) {
+                transcodeRunning += r.second;
+                continue;
+            }
+            running += r.second;
+            if (r.first != AbstractTask::LOADJOB && r.first != AbstractTask::THUMBJOB) {
+                backgroundRunning += r.second;
+            }
+        }
+        auto selected = m_pendingTasks.end();
+        int selectedPriority = 0;
+        for (auto it = m_pendingTasks.begin(); it != m_pendingTasks.end(); ++it) {
+            AbstractTask *t = *it;
+            if (t->m_type == AbstractTask::TRANSCODEJOB || t->m_type == AbstractTask::PROXYJOB) {
+                if (transcodeRunning >= typeBudget(t->m_type)) {
+                    continue;
+                }
+            } else {
+                if (running >= m_workerThreads) {
+                    continue;
+                }
+                bool interactive = t->m_type == AbstractTask::LOADJOB || t->m_type == AbstractTask::THUMBJOB;
+                // Always keep one worker available for interactive tasks
+                if (!interactive && backgroundRunning >= m_workerThreads - 1) {
+                    continue;
+                }
+                auto r = m_runningTasks.find(t->m_type);
+                if (r != m_runningTasks.end() && r->second >= typeBudget(t->m_type)) {
+                    continue;
+                }
+            }
+            int priority = effectivePriority(t);
+            if (selected == m_pendingTasks.end() || priority > selectedPriority ||
+                (priority == selectedPriority && t->m_sequence < (*selected)->m_sequence)) {
+                selected = it;
+                selectedPriority = priority;
+            }
+        }
+        if (selected == m_pendingTasks.end()) {
+            // All budgets are used, wait for a task to finish
+            break;
+        }
+        AbstractTask *task = *selected;
+        m_pendingTasks.erase(selected);
+        m_runningTasks[task->m_type]++;
+        m_taskPool.start(task, selectedPriority);
+    }
+}
+
+bool TaskManager::takePendingTask(AbstractTask *task)
+{
+    QMutexLocker lk(&m_queueMutex);
+    auto it = std::find(m_pendingTasks.begin(), m_pendingTasks.end(), task);
+    if (it != m_pendingTasks.end()) {
+        m_pendingTasks.erase(it);
+        return true;
+    }
+    if (m_taskPool.tryTake(task)) {
+        // Task was dispatched but not started yet
+        m_runningTasks[task->m_type]--;
+        return true;
+    }
+    return false;
 }
 
 void TaskManager::discardJobs(const ObjectId &owner, AbstractTask::JOBTYPE type, bool softDelete, const QVector<AbstractTask::JOBTYPE> exceptions)
@@ -73,20 +194,11 @@ void TaskManager::discardJobs(const ObjectId &owner, AbstractTask::JOBTYPE type,
             ix--;
             continue;
         }
-        if (taskType != AbstractTask::TRANSCODEJOB && taskType != AbstractTask::PROXYJOB) {
-            if (m_taskPool.tryTake(t)) {
-                // Task was not started yet, we can simply delete
-                delete t;
-                ix--;
-                continue;
-            }
-        } else {
-            if (m_transcodePool.tryTake(t)) {
-                // Task was not started yet, we can simply delete
-                delete t;
-                ix--;
-                continue;
-            }
+        if (takePendingTask(t)) {
+            // Task was not started yet, we can simply delete
+            delete t;
+            ix--;
+            continue;
         }
         t->cancelJob(softDelete);
         // Block until the task is finished
@@ -119,20 +231,11 @@ void TaskManager::discardJob(const ObjectId &owner, const QUuid &uuid)
             ix--;
             continue;
         }
-        if (taskType != AbstractTask::TRANSCODEJOB && taskType != AbstractTask::PROXYJOB) {
-            if (m_taskPool.tryTake(t)) {
-                // Task was not started yet, we can simply delete
-                delete t;
-                ix--;
-                continue;
-            }
-        } else {
-            if (m_transcodePool.tryTake(t)) {
-                // Task was not started yet, we can simply delete
-                delete t;
-                ix--;
-                continue;
-            }
+        if (takePendingTask(t)) {
+            // Task was not started yet, we can simply delete
+            delete t;
+            ix--;
+            continue;
         }
         t->cancelJob();
         // Block until the task is finished
@@ -192,10 +295,14 @@ void TaskManager::updateJobCount()
 void TaskManager::taskDone(int cid, AbstractTask *task)
 {
     // This will be executed in the QRunnable job thread
+    m_queueMutex.lock();
+    m_runningTasks[task->m_type]--;
+    m_queueMutex.unlock();
     if (m_blockUpdates) {
         // We are closing, tasks will be handled on close
         return;
     }
+    dispatchTasks();
     m_tasksListLock.lockForWrite();
     Q_ASSERT(m_taskList.find(cid) != m_taskList.end());
     m_taskList[cid].erase(std::remove(m_taskList[cid].begin(), m_taskList[cid].end(), task), m_taskList[cid].end());
@@ -225,20 +332,11 @@ void TaskManager::slotCancelJobs(bool leaveBlocked, const QVector<AbstractTask::
                 ix--;
                 continue;
             }
-            if (taskType != AbstractTask::TRANSCODEJOB && taskType != AbstractTask::PROXYJOB) {
-                if (m_taskPool.tryTake(t)) {
-                    // Task was not started yet, we can simply delete
-                    delete t;
-                    ix--;
-                    continue;
-                }
-            } else {
-                if (m_transcodePool.tryTake(t)) {
-                    // Task was not started yet, we can simply delete
-                    delete t;
-                    ix--;
-                    continue;
-                }
+            if (takePendingTask(t)) {
+                // Task was not started yet, we can simply delete
+                delete t;
+                ix--;
+                continue;
             }
             if (m_taskList.find(task.first) != m_taskList.end()) {
                 // If so, then just add ourselves to be notified upon completion.
@@ -252,20 +350,27 @@ void TaskManager::slotCancelJobs(bool leaveBlocked, const QVector<AbstractTask::
     }
     if (exceptions.isEmpty()) {
         m_taskPool.waitForDone();
-        m_transcodePool.waitForDone();
         m_taskList.clear();
         m_taskPool.clear();
+        QMutexLocker lk(&m_queueMutex);
+        m_pendingTasks.clear();
+        m_runningTasks.clear();
     }
     if (!leaveBlocked) {
         m_blockUpdates = false;
     }
     m_tasksListLock.unlock();
+    if (!leaveBlocked) {
+        // Start the tasks that were kept
+        dispatchTasks();
+    }
     updateJobCount();
 }
 
 void TaskManager::unBlock()
 {
     m_blockUpdates = false;
+    dispatchTasks();
 }
 
 void TaskManager::startTask(int ownerId, AbstractTask *task)
@@ -283,12 +388,11 @@ void TaskManager::startTask(int ownerId, AbstractTask *task)
         m_taskList[ownerId].emplace_back(task);
     }
     m_tasksListLock.unlock();
-    if (task->m_type == AbstractTask::TRANSCODEJOB || task->m_type == AbstractTask::PROXYJOB) {
-        // We only want a limited concurrent jobs for those as for example GPU usually only accept 2 concurrent encoding jobs
-        m_transcodePool.start(task, task->m_priority);
-    } else {
-        m_taskPool.start(task, task->m_priority);
-    }
+    m_queueMutex.lock();
+    task->m_sequence = m_taskSequence++;
+    m_pendingTasks.emplace_back(task);
+    m_queueMutex.unlock();
+    dispatchTasks();
     updateJobCount();
 }
 
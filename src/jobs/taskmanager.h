@@ -13,6 +13,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 
 #include <QAbstractListModel>
 #include <QFutureWatcher>
+#include <QMutex>
 #include <QObject>
 #include <QReadWriteLock>
 #include <QThreadPool>
@@ -29,6 +30,10 @@ Q_DECLARE_METATYPE(TaskManagerStatus)
 
 /** @class TaskManager
     @brief This class is responsible for clip jobs management.
+    Tasks are not pushed directly to the thread pool but kept in a pending queue. Each time a
+    worker becomes available, the pending task with the highest effective priority whose job type
+    still has room in its concurrency budget is dispatched. Tasks for the clip displayed in Clip
+    Monitor and for clips recently requested by the timeline are boosted.
  */
 class TaskManager : public QObject
 {
@@ -74,6 +79,9 @@ public:
     /** @brief Allow starting new tasks */
     void unBlock();
 
+    /** @brief Mark a clip as visible in the timeline so that its pending tasks are processed first */
+    void boostClip(int ownerId);
+
 public Q_SLOTS:
     /** @brief Discard all running jobs. */
     void slotCancelJobs(bool leaveBlocked = false, const QVector<AbstractTask::JOBTYPE> exceptions = {});
@@ -84,10 +92,27 @@ private Q_SLOTS:
 
 private:
     QThreadPool m_taskPool;
-    QThreadPool m_transcodePool;
     std::unordered_map<int, std::vector<AbstractTask*> > m_taskList;
     mutable QReadWriteLock m_tasksListLock;
     bool m_blockUpdates;
+    /** @brief Tasks waiting for a free worker, protected by m_queueMutex */
+    std::vector<AbstractTask *> m_pendingTasks;
+    /** @brief Number of dispatched tasks per job type, protected by m_queueMutex */
+    std::unordered_map<int, int> m_runningTasks;
+    /** @brief Clips recently displayed in the timeline, most recent first, protected by m_queueMutex */
+    QList<int> m_boostedClips;
+    QMutex m_queueMutex;
+    quint64 m_taskSequence;
+    /** @brief Number of workers for in process tasks (proxy and transcode tasks have their own budget) */
+    int m_workerThreads;
+    /** @brief Maximum number of concurrent tasks for a job type */
+    int typeBudget(AbstractTask::JOBTYPE type) const;
+    /** @brief Priority used to sort pending tasks, including the displayed / visible clip boost */
+    int effectivePriority(const AbstractTask *task) const;
+    /** @brief Start as many pending tasks as the budgets allow */
+    void dispatchTasks();
+    /** @brief Remove a task that was not started yet from the queue, returns true on success */
+    bool takePendingTask(AbstractTask *task);
 
 Q_SIGNALS:
     void jobCount(int);
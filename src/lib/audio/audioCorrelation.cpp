@@ -4,14 +4,25 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 */
 
 #include "audioCorrelation.h"
-#include "fftCorrelation.h"
 
 #include "kdenlive_debug.h"
 #include "klocalizedstring.h"
 #include <QElapsedTimer>
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 
+namespace {
+// Above this envelope size (in frames), the offset is first searched on decimated envelopes
+const size_t pyramidThreshold = 1 << 16;
+// Size of the decimated envelopes
+const size_t coarseSize = 1 << 14;
+// Minimum size of the decimated child envelope, a shorter one doesn't have enough detail to find the offset
+const size_t minCoarseChildSize = 1 << 10;
+// Number of coarse correlation peaks refined at full resolution
+const int coarseCandidates = 3;
+} // namespace
+
 AudioCorrelation::AudioCorrelation(std::unique_ptr<AudioEnvelope> mainTrackEnvelope)
     : m_mainTrackEnvelope(std::move(mainTrackEnvelope))
 {
@@ -62,8 +73,15 @@ void AudioCorrelation::slotProcessChild(AudioEnvelope *envelope)
     const std::vector<qint64> &envSub = envelope->envelope();
     qint64 max = 0;
 
-    if (sizeSub > 200) {
-        FFTCorrelation::correlate(&envMain[0], sizeMain, &envSub[0], sizeSub, correlation);
+    const size_t factor = pyramidFactor(sizeMain, sizeSub);
+    if (factor > 1) {
+        correlatePyramid(envMain, envSub, factor, info);
+    } else if (sizeSub > 200) {
+        if (!m_mainTrackReference) {
+            // Only transform the main envelope once for all children
+            m_mainTrackReference = std::make_unique<FFTCorrelation::Reference>(&envMain[0], sizeMain);
+        }
+        m_mainTrackReference->correlate(&envSub[0], sizeSub, correlation);
     } else {
         correlate(&envMain[0], sizeMain, &envSub[0], sizeSub, correlation, &max);
         info->setMax(max);
@@ -78,6 +96,109 @@ void AudioCorrelation::slotProcessChild(AudioEnvelope *envelope)
     Q_EMIT gotAudioAlignData(envelope->clipId(), shift);
 }
 
+size_t AudioCorrelation::pyramidFactor(size_t sizeMain, size_t sizeSub)
+{
+    if (std::max(sizeMain, sizeSub) <= pyramidThreshold || sizeSub <= pyramidThreshold / 4) {
+        // The full FFT is fast enough, or the child is too short for its decimated envelope to be reliable
+        return 1;
+    }
+    size_t factor = 2;
+    while (std::max(sizeMain, sizeSub) / factor > coarseSize) {
+        factor *= 2;
+    }
+    // Keep enough entries in the decimated child
+    while (factor > 1 && sizeSub / factor < minCoarseChildSize) {
+        factor /= 2;
+    }
+    return factor;
+}
+
+void AudioCorrelation::correlatePyramid(const std::vector<qint64> &envMain, const std::vector<qint64> &envSub, size_t factor, AudioCorrelationInfo *info)
+{
+    QElapsedTimer t;
+    t.start();
+    const size_t sizeMain = envMain.size();
+    const size_t sizeSub = envSub.size();
+    if (!m_mainTrackCoarseReference || factor != m_coarseFactor) {
+        const std::vector<qint64> coarseMain = decimate(envMain, factor);
+        m_mainTrackCoarseReference = std::make_unique<FFTCorrelation::Reference>(coarseMain.data(), coarseMain.size());
+        m_coarseFactor = factor;
+    }
+    const std::vector<qint64> coarseSub = decimate(envSub, factor);
+    const size_t coarseMainSize = m_mainTrackCoarseReference->size();
+    std::vector<qint64> coarseCorrelation(coarseMainSize + coarseSub.size() + 1);
+    m_mainTrackCoarseReference->correlate(coarseSub.data(), coarseSub.size(), coarseCorrelation.data());
+
+    // The full resolution vector is only filled around the best coarse peaks
+    qint64 *correlation = info->correlationVector();
+    std::fill(correlation, correlation + info->size(), 0);
+    qint64 max = 0;
+    for (int candidate = 0; candidate < coarseCandidates; ++candidate) {
+        auto peak = std::max_element(coarseCorrelation.begin(), coarseCorrelation.end());
+        if (*peak <= 0) {
+            break;
+        }
+        // Coarse shift in decimated frames, see correlate() for the index layout
+        auto coarseIndex = qint64(peak - coarseCorrelation.begin());
+        qint64 shift = (coarseIndex - qint64(coarseSub.size())) * qint64(factor);
+        qint64 first = std::max<qint64>(0, shift - 2 * qint64(factor) + qint64(sizeSub));
+        qint64 last = std::min<qint64>(qint64(sizeMain + sizeSub), shift + 2 * qint64(factor) + qint64(sizeSub));
+        if (first <= last) {
+            qint64 windowMax = 0;
+            correlateWindow(envMain.data(), sizeMain, envSub.data(), sizeSub, correlation, size_t(first), size_t(last), &windowMax);
+            max = std::max(max, windowMax);
+        }
+        // Ignore this peak and its neighbours for the next candidate
+        auto from = std::max<qint64>(0, coarseIndex - 2);
+        auto to = std::min<qint64>(qint64(coarseCorrelation.size()), coarseIndex + 3);
+        std::fill(coarseCorrelation.begin() + from, coarseCorrelation.begin() + to, 0);
+    }
+    info->setMax(max);
+    qCDebug(KDENLIVE_LOG) << "Coarse to fine correlation, factor" << factor << "computed in" << t.elapsed() << "ms.";
+}
+
+std::vector<qint64> AudioCorrelation::decimate(const std::vector<qint64> &envelope, size_t factor)
+{
+    std::vector<qint64> result((envelope.size() + factor - 1) / factor, 0);
+    for (size_t i = 0; i < envelope.size(); ++i) {
+        result[i / factor] += envelope[i];
+    }
+    return result;
+}
+
+void AudioCorrelation::correlateWindow(const qint64 *envMain, size_t sizeMain, const qint64 *envSub, size_t sizeSub, qint64 *correlation, size_t first,
+                                       size_t last, qint64 *out_max)
+{
+    // Entry k of the correlation vector is the sum of main[m + shift] * sub[m], with shift = k - sizeSub.
+    // Products of long envelopes can overflow, so the sums are computed in floating point
+    // and scaled like the FFT correlation, keeping some more precision.
+    qint64 maxMain = 1;
+    qint64 maxSub = 1;
+    for (size_t i = 0; i < sizeMain; ++i) {
+        maxMain = std::max(maxMain, qAbs(envMain[i]));
+    }
+    for (size_t i = 0; i < sizeSub; ++i) {
+        maxSub = std::max(maxSub, qAbs(envSub[i]));
+    }
+    const double scale = 1024. / (double(maxMain) * double(maxSub));
+    qint64 max = 0;
+    last = std::min(last, sizeMain + sizeSub);
+    for (size_t k = first; k <= last; ++k) {
+        qint64 shift = qint64(k) - qint64(sizeSub);
+        qint64 from = std::max<qint64>(0, -shift);
+        qint64 to = std::min<qint64>(qint64(sizeSub), qint64(sizeMain) - shift);
+        double sum = 0;
+        for (qint64 m = from; m < to; ++m) {
+            sum += double(envMain[m + shift]) * double(envSub[m]);
+        }
+        correlation[k] = qint64(sum * scale);
+        max = std::max(max, correlation[k]);
+    }
+    if (out_max != nullptr) {
+        *out_max = max;
+    }
+}
+
 int AudioCorrelation::getShift(int childIndex) const
 {
     Q_ASSERT(childIndex >= 0);
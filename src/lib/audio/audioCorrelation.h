@@ -10,6 +10,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "audioCorrelationInfo.h"
 #include "audioEnvelope.h"
 #include "definitions.h"
+#include "fftCorrelation.h"
 #include <QList>
 
 /**
@@ -58,8 +59,39 @@ public:
       */
     static void correlate(const qint64 *envMain, size_t sizeMain, const qint64 *envSub, size_t sizeSub, qint64 *correlation, qint64 *out_max = nullptr);
 
+    /**
+      Same as correlate, but only computes the entries of the correlation vector
+      from \c first to \c last (included). The other entries are not modified.
+      The values are normalized by the envelope maximums, like the FFT correlation.
+      */
+    static void correlateWindow(const qint64 *envMain, size_t sizeMain, const qint64 *envSub, size_t sizeSub, qint64 *correlation, size_t first,
+                                size_t last, qint64 *out_max = nullptr);
+
+    /**
+      Sums each block of \c factor entries of the envelope.
+      */
+    static std::vector<qint64> decimate(const std::vector<qint64> &envelope, size_t factor);
+
+    /**
+      Returns the decimation factor used to find the rough offset of a child envelope,
+      or 1 if the envelopes should be correlated at full resolution.
+      The factor depends on the child length, so that the decimated child keeps enough entries.
+      */
+    static size_t pyramidFactor(size_t sizeMain, size_t sizeSub);
+
 private:
     std::unique_ptr<AudioEnvelope> m_mainTrackEnvelope;
+    /** @brief Spectrum of the main envelope, shared by the FFT correlations of all children */
+    std::unique_ptr<FFTCorrelation::Reference> m_mainTrackReference;
+    /** @brief Spectrum of the decimated main envelope, used to find the rough offset of long clips */
+    std::unique_ptr<FFTCorrelation::Reference> m_mainTrackCoarseReference;
+    size_t m_coarseFactor{0};
+
+    /**
+      Correlates long envelopes in two steps: the rough offset is searched on decimated
+      envelopes, then the correlation is computed at full resolution around it only.
+      */
+    void correlatePyramid(const std::vector<qint64> &envMain, const std::vector<qint64> &envSub, size_t factor, AudioCorrelationInfo *info);
 
     QList<AudioEnvelope *> m_children;
     QList<AudioCorrelationInfo *> m_correlations;
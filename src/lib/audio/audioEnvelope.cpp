@@ -16,8 +16,42 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include <QImage>
 #include <QtConcurrent>
 #include <algorithm>
+#include <array>
 #include <cmath>
 
+namespace {
+/** @brief Converts a cached audio level back to a linear amplitude in the 16 bit sample range.
+ *  AudioLevelsTask stores 256 * 0.9 * the IEC 60268-18 scaled level of MLT's audiolevel filter.
+ *  Envelopes that are correlated must be linear, since the envelope of another clip may be decoded from its samples. */
+qint64 levelToAmplitude(uint8_t value)
+{
+    static const std::array<qint64, 256> amplitudes = []() {
+        std::array<qint64, 256> table{};
+        for (size_t i = 1; i < table.size(); ++i) {
+            double level = i / (256 * 0.9);
+            // Inverse of the IEC scale, which is linear in dB between these points
+            double dB;
+            if (level >= 0.5) {
+                dB = (level - 0.5) / 0.025 - 20.;
+            } else if (level >= 0.3) {
+                dB = (level - 0.3) / 0.02 - 30.;
+            } else if (level >= 0.15) {
+                dB = (level - 0.15) / 0.015 - 40.;
+            } else if (level >= 0.075) {
+                dB = (level - 0.075) / 0.0075 - 50.;
+            } else if (level >= 0.025) {
+                dB = (level - 0.025) / 0.005 - 60.;
+            } else {
+                dB = level / 0.0025 - 70.;
+            }
+            table[i] = qRound64(32767. * std::pow(10., qMin(dB, 0.) / 20.));
+        }
+        return table;
+    }();
+    return amplitudes[value];
+}
+} // namespace
+
 AudioEnvelope::AudioEnvelope(const QString &binId, int clipId, size_t offset, size_t length, size_t startPos)
     : m_offset(offset)
     , m_clipId(clipId)
@@ -32,6 +66,21 @@ AudioEnvelope::AudioEnvelope(const QString &binId, int clipId, size_t offset, si
     }
     m_envelopeSize = size_t(m_producer->get_playtime());
 
+    // Reuse the levels computed for the audio thumbnail if they cover the analysed zone
+    if (clip->audioInfo()) {
+        int stream = clip->audioInfo()->ffmpeg_audio_index();
+        int channels = clip->audioChannels();
+        channels = channels <= 0 ? 2 : channels;
+        channels = clip->audioInfo()->streamChannels().value(stream, channels);
+        const QVector<uint8_t> levels = clip->audioFrameCache(stream);
+        size_t levelsStart = length > 2000 ? offset : 0;
+        if (size_t(levels.size()) >= (levelsStart + m_envelopeSize) * size_t(channels)) {
+            m_levels = levels;
+            m_levelsChannels = channels;
+            m_levelsStart = levelsStart;
+        }
+    }
+
     m_producer->set("set.test_image", 1);
     connect(&m_watcher, &QFutureWatcherBase::finished, this, [this] { Q_EMIT envelopeReady(this); });
     if (!m_producer || !m_producer->is_valid()) {
@@ -99,28 +148,45 @@ AudioEnvelope::AudioSummary AudioEnvelope::loadAndNormalizeEnvelope() const
 {
     qCDebug(KDENLIVE_LOG) << "Loading envelope …";
     AudioSummary summary(m_envelopeSize);
-    if (!m_info || m_info->size() < 1) {
-        return summary;
-    }
-    int samplingRate = m_info->info(0)->samplingRate();
-    mlt_audio_format format_s16 = mlt_audio_s16;
-    int channels = 1;
-
+    size_t max = summary.audioAmplitudes.size();
     QElapsedTimer t;
     t.start();
-    m_producer->seek(0);
-    size_t max = summary.audioAmplitudes.size();
-    for (size_t i = 0; i < max; ++i) {
-        std::unique_ptr<Mlt::Frame> frame(m_producer->get_frame(int(i)));
-        qint64 position = mlt_frame_get_position(frame->get_frame());
-        int samples = mlt_audio_calculate_frame_samples(float(m_producer->get_fps()), samplingRate, position);
-        auto *data = static_cast<qint16 *>(frame->get_audio(format_s16, samplingRate, channels, samples));
-
-        summary.audioAmplitudes[i] = 0;
-        for (int k = 0; k < samples; ++k) {
-            summary.audioAmplitudes[i] += abs(data[k]);
+    if (!m_levels.isEmpty()) {
+        // The levels are already available, no need to decode the audio
+        const uint8_t *levels = m_levels.constData() + m_levelsStart * size_t(m_levelsChannels);
+        for (size_t i = 0; i < max; ++i) {
+            qint64 sum = 0;
+            for (int channel = 0; channel < m_levelsChannels; ++channel) {
+                sum += levelToAmplitude(*levels++);
+            }
+            summary.audioAmplitudes[i] = sum;
+        }
+    } else {
+        if (!m_info || m_info->size() < 1) {
+            return summary;
+        }
+        int samplingRate = m_info->info(0)->samplingRate();
+        mlt_audio_format format_s16 = mlt_audio_s16;
+        int channels = 1;
+
+        m_producer->seek(0);
+        int lastProgress = -1;
+        for (size_t i = 0; i < max; ++i) {
+            std::unique_ptr<Mlt::Frame> frame(m_producer->get_frame(int(i)));
+            qint64 position = mlt_frame_get_position(frame->get_frame());
+            int samples = mlt_audio_calculate_frame_samples(float(m_producer->get_fps()), samplingRate, position);
+            auto *data = static_cast<qint16 *>(frame->get_audio(format_s16, samplingRate, channels, samples));
+
+            summary.audioAmplitudes[i] = 0;
+            for (int k = 0; k < samples; ++k) {
+                summary.audioAmplitudes[i] += abs(data[k]);
+            }
+            int progress = int(100 * i / max);
+            if (progress != lastProgress) {
+                lastProgress = progress;
+                pCore->displayMessage(i18n("Processing data analysis"), ProcessingJobMessage, progress);
+            }
         }
-        pCore->displayMessage(i18n("Processing data analysis"), ProcessingJobMessage, int(100 * i / max));
     }
     qCDebug(KDENLIVE_LOG) << "Calculating the envelope (" << m_envelopeSize << " frames) took " << t.elapsed() << " ms.";
     qCDebug(KDENLIVE_LOG) << "Normalizing envelope …";
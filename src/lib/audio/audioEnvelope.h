@@ -20,6 +20,11 @@ class QImage;
   The audio envelope is a simplified version of an audio track
   with frame resolution. One entry is calculated by the sum
   of the absolute values of all samples in the current frame.
+  When the audio levels of the clip were already computed for
+  the audio thumbnails, the sum of the channel levels is used
+  instead, so that the audio does not need to be decoded again.
+  The levels are converted back to linear amplitudes, so that
+  the envelope can be correlated with a decoded one.
 
   See also: http://web.archive.org/web/20180626235917/http://bemasc.net/wordpress/2011/07/26/an-auto-aligner-for-pitivi/
   */
@@ -87,6 +92,11 @@ private:
 
     std::shared_ptr<Mlt::Producer> m_producer;
     std::unique_ptr<AudioInfo> m_info;
+    /** @brief Audio levels of the clip (one value per channel and frame), empty if not available */
+    QVector<uint8_t> m_levels;
+    int m_levelsChannels{0};
+    /** @brief Frame of the levels corresponding to the first envelope entry */
+    size_t m_levelsStart{0};
     QFutureWatcher<AudioSummary> m_watcher;
     QFuture<AudioSummary> m_audioSummary;
 
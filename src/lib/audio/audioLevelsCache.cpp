@@ -0,0 +1,95 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    This file is part of kdenlive. See www.kdenlive.org.
+
+SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "audioLevelsCache.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QImage>
+#include <QSaveFile>
+#include <QtEndian>
+#include <cstring>
+
+const quint32 AudioLevelsCache::formatVersion = 1;
+
+namespace {
+const char magic[4] = {'K', 'D', 'L', 'V'};
+// magic, version, channels, fps * 1000, stream, max level, count
+const int headerSize = 4 + 4 + 4 + 4 + 4 + 4 + 8;
+} // namespace
+
+bool AudioLevelsCache::write(const QString &path, const QVector<uint8_t> &levels, int channels, double fps, int stream, int maxLevel)
+{
+    QByteArray header(headerSize, 0);
+    char *data = header.data();
+    memcpy(data, magic, 4);
+    qToLittleEndian<quint32>(formatVersion, data + 4);
+    qToLittleEndian<quint32>(quint32(channels), data + 8);
+    qToLittleEndian<quint32>(quint32(qRound(fps * 1000)), data + 12);
+    qToLittleEndian<qint32>(stream, data + 16);
+    qToLittleEndian<quint32>(quint32(maxLevel), data + 20);
+    qToLittleEndian<quint64>(quint64(levels.size()), data + 24);
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Cannot write audio levels cache" << path;
+        return false;
+    }
+    file.write(header);
+    file.write(reinterpret_cast<const char *>(levels.constData()), levels.size());
+    return file.commit();
+}
+
+bool AudioLevelsCache::read(const QString &path, int channels, double fps, QVector<uint8_t> &levels, Header *header)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly) || file.size() < headerSize) {
+        return false;
+    }
+    const uchar *data = file.map(0, file.size());
+    if (data == nullptr) {
+        return false;
+    }
+    Header h;
+    bool valid = memcmp(data, magic, 4) == 0;
+    if (valid) {
+        h.version = qFromLittleEndian<quint32>(data + 4);
+        h.channels = qFromLittleEndian<quint32>(data + 8);
+        h.fps = qFromLittleEndian<quint32>(data + 12) / 1000.;
+        h.stream = qFromLittleEndian<qint32>(data + 16);
+        h.maxLevel = qFromLittleEndian<quint32>(data + 20);
+        h.count = qFromLittleEndian<quint64>(data + 24);
+        valid = h.version == formatVersion && int(h.channels) == channels && qRound(h.fps * 1000) == qRound(fps * 1000) &&
+                quint64(file.size()) >= headerSize + h.count;
+    }
+    if (valid) {
+        levels.resize(int(h.count));
+        memcpy(levels.data(), data + headerSize, size_t(h.count));
+        if (header) {
+            *header = h;
+        }
+    }
+    file.unmap(const_cast<uchar *>(data));
+    return valid;
+}
+
+bool AudioLevelsCache::readLegacyImage(const QString &path, int channels, QVector<uint8_t> &levels)
+{
+    QImage image(path);
+    if (image.isNull() || channels <= 0) {
+        return false;
+    }
+    int n = image.width() * image.height();
+    levels.reserve(4 * n);
+    for (int i = 0; n > 1 && i < n; i++) {
+        QRgb p = image.pixel(i / channels, i % channels);
+        levels << qRed(p);
+        levels << qGreen(p);
+        levels << qBlue(p);
+        levels << qAlpha(p);
+    }
+    return !levels.isEmpty();
+}
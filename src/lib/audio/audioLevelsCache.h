@@ -0,0 +1,50 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    This file is part of kdenlive. See www.kdenlive.org.
+
+SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QString>
+#include <QVector>
+#include <cstdint>
+
+/**
+  On disk cache for the per frame audio levels computed by AudioLevelsTask.
+
+  The file starts with a fixed size little endian header describing the data,
+  followed by the raw interleaved levels (one byte per channel per frame).
+  Reading maps the file in memory and copies the levels in one block.
+
+  Older projects stored the levels in the pixels of a PNG image, readLegacyImage()
+  allows to migrate them.
+  */
+class AudioLevelsCache
+{
+public:
+    struct Header
+    {
+        quint32 version = 0;
+        quint32 channels = 0;
+        double fps = 0.;
+        qint32 stream = -1;
+        quint32 maxLevel = 0;
+        quint64 count = 0;
+    };
+
+    /** @brief Current version of the file format, files with another version are ignored */
+    static const quint32 formatVersion;
+
+    /** @brief Write the levels to @param path, returns true on success */
+    static bool write(const QString &path, const QVector<uint8_t> &levels, int channels, double fps, int stream, int maxLevel);
+
+    /** @brief Read the levels stored in @param path. The file is rejected if its header does not match @param channels and @param fps
+     *  @param header if not null, receives the file header
+     *  @returns true on success */
+    static bool read(const QString &path, int channels, double fps, QVector<uint8_t> &levels, Header *header = nullptr);
+
+    /** @brief Read the levels from a PNG image created by a previous Kdenlive version */
+    static bool readLegacyImage(const QString &path, int channels, QVector<uint8_t> &levels);
+};
@@ -0,0 +1,70 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    This file is part of kdenlive. See www.kdenlive.org.
+
+SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "audioLevelsPyramid.h"
+
+#include <QtGlobal>
+
+AudioLevelsPyramid::AudioLevelsPyramid(const QVector<uint8_t> &levels, int channels)
+    : m_channels(qMax(1, channels))
+{
+    m_levels.push_back(levels);
+    // Halve the resolution until a level has a single frame
+    while (m_levels.back().size() / m_channels > 1) {
+        const QVector<uint8_t> &previous = m_levels.back();
+        int previousFrames = previous.size() / m_channels;
+        int frames = (previousFrames + 1) / 2;
+        QVector<uint8_t> current(frames * m_channels);
+        for (int f = 0; f < frames; f++) {
+            int first = 2 * f * m_channels;
+            int second = qMin(2 * f + 1, previousFrames - 1) * m_channels;
+            for (int c = 0; c < m_channels; c++) {
+                current[f * m_channels + c] = qMax(previous.at(first + c), previous.at(second + c));
+            }
+        }
+        m_levels.push_back(std::move(current));
+    }
+}
+
+int AudioLevelsPyramid::channels() const
+{
+    return m_channels;
+}
+
+int AudioLevelsPyramid::frames() const
+{
+    return m_levels.front().size() / m_channels;
+}
+
+int AudioLevelsPyramid::levelCount() const
+{
+    return int(m_levels.size());
+}
+
+const QVector<uint8_t> &AudioLevelsPyramid::level(int level) const
+{
+    return m_levels.at(size_t(level));
+}
+
+uint8_t AudioLevelsPyramid::peak(int frame, int span, int channel) const
+{
+    span = qMax(1, span);
+    // Pick the level where the span covers one or two entries
+    int lev = 0;
+    while (lev + 1 < levelCount() && (2 << lev) <= span) {
+        lev++;
+    }
+    const QVector<uint8_t> &data = m_levels.at(size_t(lev));
+    int entries = data.size() / m_channels;
+    int first = qMax(0, frame) >> lev;
+    int last = qMin(entries - 1, (frame + span - 1) >> lev);
+    uint8_t result = 0;
+    for (int i = first; i <= last; i++) {
+        result = qMax(result, data.at(i * m_channels + channel));
+    }
+    return result;
+}
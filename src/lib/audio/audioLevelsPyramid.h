@@ -0,0 +1,42 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    This file is part of kdenlive. See www.kdenlive.org.
+
+SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QVector>
+#include <cstdint>
+#include <vector>
+
+/**
+  Multi resolution version of the per frame audio levels used to draw
+  waveforms when zoomed out.
+
+  Level 0 contains the original interleaved levels. Each entry of level k
+  is the peak of 2^k consecutive frames for one channel, so that a pixel
+  covering many frames can be drawn from a few values without skipping
+  transients.
+  */
+class AudioLevelsPyramid
+{
+public:
+    AudioLevelsPyramid(const QVector<uint8_t> &levels, int channels);
+
+    int channels() const;
+    /** @brief Number of frames in the original levels */
+    int frames() const;
+    /** @brief Number of levels, including the original data */
+    int levelCount() const;
+    /** @brief Returns the interleaved levels of pyramid @param level */
+    const QVector<uint8_t> &level(int level) const;
+
+    /** @brief Peak value of @param channel for the @param span frames starting at @param frame */
+    uint8_t peak(int frame, int span, int channel) const;
+
+private:
+    int m_channels;
+    std::vector<QVector<uint8_t>> m_levels;
+};
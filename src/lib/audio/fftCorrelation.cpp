@@ -5,68 +5,146 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 
 #include "fftCorrelation.h"
 #include <QElapsedTimer>
-extern "C" {
-#include "../external/kiss_fft/tools/kiss_fftr.h"
-}
 
 #include "kdenlive_debug.h"
 #include <algorithm>
+#include <cstdlib>
+#include <memory>
 #include <vector>
 
-void FFTCorrelation::correlate(const qint64 *left, const size_t leftSize, const qint64 *right, const size_t rightSize, qint64 *out_correlated)
+namespace {
+struct PlanDeleter
 {
-    auto *correlatedFloat = new float[leftSize + rightSize + 1];
-    correlate(left, leftSize, right, rightSize, correlatedFloat);
+    void operator()(kiss_fftr_state *cfg) const { kiss_fftr_free(cfg); }
+};
 
-    // The correlation vector will have entries up to N (number of entries
-    // of the vector), so converting to integers will not lose that much
-    // of precision.
-    for (size_t i = 0; i < leftSize + rightSize + 1; ++i) {
-        out_correlated[i] = qint64(correlatedFloat[i]);
+/** @brief Returns the FFT configuration for the given size, allocated on first use.
+    The configurations contain scratch buffers, so they are cached per thread. */
+kiss_fftr_cfg fftPlan(size_t size, bool inverse)
+{
+    thread_local std::map<std::pair<size_t, bool>, std::unique_ptr<kiss_fftr_state, PlanDeleter>> plans;
+    auto &plan = plans[{size, inverse}];
+    if (!plan) {
+        plan.reset(kiss_fftr_alloc(int(size), inverse ? 1 : 0, nullptr, nullptr));
     }
-    delete[] correlatedFloat;
+    return plan.get();
+}
+} // namespace
+
+void FFTCorrelation::correlate(const qint64 *left, const size_t leftSize, const qint64 *right, const size_t rightSize, qint64 *out_correlated)
+{
+    Reference(left, leftSize).correlate(right, rightSize, out_correlated);
 }
 
 void FFTCorrelation::correlate(const qint64 *left, const size_t leftSize, const qint64 *right, const size_t rightSize, float *out_correlated)
 {
-    QElapsedTimer t;
-    t.start();
+    Reference(left, leftSize).correlate(right, rightSize, out_correlated);
+}
 
-    auto *leftF = new float[leftSize];
-    auto *rightF = new float[rightSize];
+size_t FFTCorrelation::fftSize(size_t largestSize)
+{
+    // To avoid issues with repetition (we are dealing with cosine waves
+    // in the fourier domain) we need to pad the vectors to at least twice their size,
+    // otherwise convolution would convolve with the repeated pattern as well.
+    // The vectors must have the same size (same frequency resolution!) and should
+    // be a power of 2 (for FFT).
+    size_t size = 64;
+    while (size / 2 < largestSize) {
+        size = size << 1;
+    }
+    return size;
+}
 
+std::vector<float> FFTCorrelation::normalize(const qint64 *data, const size_t size, bool reverse)
+{
     // First the qint64 values need to be normalized to floats
     // Dividing by the max value is maybe not the best solution, but the
     // maximum value after correlation should not be larger than the longest
     // vector since each value should be at most 1
-    qint64 maxLeft = 1;
-    qint64 maxRight = 1;
-    for (size_t i = 0; i < leftSize; ++i) {
-        if (qAbs(left[i]) > maxLeft) {
-            maxLeft = qAbs(left[i]);
+    qint64 max = 1;
+    for (size_t i = 0; i < size; ++i) {
+        if (qAbs(data[i]) > max) {
+            max = qAbs(data[i]);
         }
     }
-    for (size_t i = 0; i < rightSize; ++i) {
-        if (qAbs(right[i]) > maxRight) {
-            maxRight = qAbs(right[i]);
-        }
+    std::vector<float> result(size);
+    for (size_t i = 0; i < size; ++i) {
+        result[reverse ? size - 1 - i : i] = float(data[i]) / max;
     }
+    return result;
+}
+
+FFTCorrelation::Reference::Reference(const qint64 *left, const size_t leftSize)
+    : m_left(normalize(left, leftSize, false))
+{
+}
+
+size_t FFTCorrelation::Reference::size() const
+{
+    return m_left.size();
+}
+
+void FFTCorrelation::Reference::correlate(const qint64 *right, const size_t rightSize, qint64 *out_correlated)
+{
+    m_correlatedFloat.resize(m_left.size() + rightSize + 1);
+    correlate(right, rightSize, m_correlatedFloat.data());
+
+    // The correlation vector will have entries up to N (number of entries
+    // of the vector), so converting to integers will not lose that much
+    // of precision.
+    for (size_t i = 0; i < m_correlatedFloat.size(); ++i) {
+        out_correlated[i] = qint64(m_correlatedFloat[i]);
+    }
+}
+
+void FFTCorrelation::Reference::correlate(const qint64 *right, const size_t rightSize, float *out_correlated)
+{
+    QElapsedTimer t;
+    t.start();
 
     // One side needs to be reversed, since multiplication in frequency domain (fourier space)
     // calculates the convolution: \sum l[x]r[N-x] and not the correlation: \sum l[x]r[x]
-    for (size_t i = 0; i < leftSize; ++i) {
-        leftF[i] = float(left[i]) / maxLeft;
+    const std::vector<float> rightF = normalize(right, rightSize, true);
+    const size_t leftSize = m_left.size();
+    const size_t size = fftSize(std::max(leftSize, rightSize));
+    const size_t fft_size = size / 2 + 1;
+    kiss_fftr_cfg fftConfig = fftPlan(size, false);
+    kiss_fftr_cfg ifftConfig = fftPlan(size, true);
+
+    // The spectrum of the reference only depends on the FFT size
+    auto spectrum = m_spectrums.find(size);
+    if (spectrum == m_spectrums.end()) {
+        std::vector<float> leftData(size, 0);
+        std::copy(m_left.begin(), m_left.end(), leftData.begin());
+        std::vector<kiss_fft_cpx> leftFFT(fft_size);
+        kiss_fftr(fftConfig, &leftData[0], &leftFFT[0]);
+        spectrum = m_spectrums.emplace(size, std::move(leftFFT)).first;
     }
-    for (size_t i = 0; i < rightSize; ++i) {
-        rightF[rightSize - 1 - i] = float(right[i]) / maxRight;
+    const std::vector<kiss_fft_cpx> &leftFFT = spectrum->second;
+
+    // The buffers are kept between calls, only growing when needed
+    m_rightData.assign(size, 0);
+    std::copy(rightF.begin(), rightF.end(), m_rightData.begin());
+    m_rightFFT.resize(fft_size);
+    kiss_fftr(fftConfig, &m_rightData[0], &m_rightFFT[0]);
+
+    // Convolution in spacial domain is a multiplication in fourier domain. O(n).
+    m_correlatedFFT.resize(fft_size);
+    for (size_t i = 0; i < fft_size; ++i) {
+        m_correlatedFFT[i].r = leftFFT[i].r * m_rightFFT[i].r - leftFFT[i].i * m_rightFFT[i].i;
+        m_correlatedFFT[i].i = leftFFT[i].r * m_rightFFT[i].i + leftFFT[i].i * m_rightFFT[i].r;
     }
 
-    // Now we can convolve to get the correlation
-    convolve(leftF, leftSize, rightF, rightSize, out_correlated);
+    // Inverse fourier transformation to get the convolved data.
+    // Insert one element at the beginning to obtain the same result
+    // that we also get with the nested for loop correlation.
+    m_convolved.resize(size);
+    kiss_fftri(ifftConfig, &m_correlatedFFT[0], &m_convolved[0]);
+    *out_correlated = 0;
+    size_t out_size = leftSize + rightSize + 1;
+    std::copy(m_convolved.begin(), m_convolved.begin() + int(out_size) - 1, out_correlated + 1);
 
     qCDebug(KDENLIVE_LOG) << "Correlation (FFT based) computed in " << t.elapsed() << " ms.";
-    delete[] leftF;
-    delete[] rightF;
 }
 
 void FFTCorrelation::convolve(const float *left, const size_t leftSize, const float *right, const size_t rightSize, float *out_convolved)
@@ -74,21 +152,10 @@ void FFTCorrelation::convolve(const float *left, const size_t leftSize, const fl
     QElapsedTimer time;
     time.start();
 
-    // To avoid issues with repetition (we are dealing with cosine waves
-    // in the fourier domain) we need to pad the vectors to at least twice their size,
-    // otherwise convolution would convolve with the repeated pattern as well
-    size_t largestSize = std::max(leftSize, rightSize);
-
-    // The vectors must have the same size (same frequency resolution!) and should
-    // be a power of 2 (for FFT).
-    size_t size = 64;
-    while (size / 2 < largestSize) {
-        size = size << 1;
-    }
-
+    const size_t size = fftSize(std::max(leftSize, rightSize));
     const size_t fft_size = size / 2 + 1;
-    kiss_fftr_cfg fftConfig = kiss_fftr_alloc(int(size), 0, nullptr, nullptr);
-    kiss_fftr_cfg ifftConfig = kiss_fftr_alloc(int(size), 1, nullptr, nullptr);
+    kiss_fftr_cfg fftConfig = fftPlan(size, false);
+    kiss_fftr_cfg ifftConfig = fftPlan(size, true);
     std::vector<kiss_fft_cpx> leftFFT(fft_size);
     std::vector<kiss_fft_cpx> rightFFT(fft_size);
     std::vector<kiss_fft_cpx> correlatedFFT(fft_size);
@@ -120,9 +187,5 @@ void FFTCorrelation::convolve(const float *left, const size_t leftSize, const fl
     kiss_fftri(ifftConfig, &correlatedFFT[0], &convolved[0]);
     std::copy(convolved.begin(), convolved.begin() + int(out_size) - 1, out_convolved + 1);
 
-    // Finally some cleanup.
-    kiss_fftr_free(fftConfig);
-    kiss_fftr_free(ifftConfig);
-
     qCDebug(KDENLIVE_LOG) << "FFT convolution computed. Time taken: " << time.elapsed() << " ms";
 }
@@ -6,6 +6,12 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #pragma once
 
 #include <QtGlobal>
+#include <map>
+#include <vector>
+extern "C" {
+#include "../external/kiss_fft/tools/kiss_fftr.h"
+}
+
 /** @class FFTCorrelation
     @brief This class provides methods to calculate convolution
     and correlation of two vectors by means of FFT, which
@@ -30,4 +36,39 @@ public:
     static void correlate(const qint64 *left, const size_t leftSize, const qint64 *right, const size_t rightSize, float *out_correlated);
 
     static void correlate(const qint64 *left, const size_t leftSize, const qint64 *right, const size_t rightSize, qint64 *out_correlated);
+
+    /** @class Reference
+        @brief Keeps the normalized left vector and its spectrum, so that several
+        vectors can be correlated with it while transforming it only once.
+      */
+    class Reference
+    {
+    public:
+        Reference(const qint64 *left, const size_t leftSize);
+
+        size_t size() const;
+
+        /**
+          Same as FFTCorrelation::correlate, with the reference as left vector.
+          */
+        void correlate(const qint64 *right, const size_t rightSize, float *out_correlated);
+        void correlate(const qint64 *right, const size_t rightSize, qint64 *out_correlated);
+
+    private:
+        std::vector<float> m_left;
+        /** Spectrum of the left vector for each FFT size used so far */
+        std::map<size_t, std::vector<kiss_fft_cpx>> m_spectrums;
+        /** Work buffers, reused by the following correlations */
+        std::vector<float> m_rightData;
+        std::vector<float> m_convolved;
+        std::vector<float> m_correlatedFloat;
+        std::vector<kiss_fft_cpx> m_rightFFT;
+        std::vector<kiss_fft_cpx> m_correlatedFFT;
+    };
+
+private:
+    /** @brief Returns the FFT size needed to convolve vectors of at most largestSize entries */
+    static size_t fftSize(size_t largestSize);
+    /** @brief Normalizes the values to [-1, 1], reversed if requested */
+    static std::vector<float> normalize(const qint64 *data, const size_t size, bool reverse);
 };
@@ -449,6 +449,7 @@ int main(int argc, char *argv[])
         renderrequest->setEmbedSubtitles(false);
         renderrequest->setTwoPass(false);
         renderrequest->setAudioFilePerTrack(false);
+        renderrequest->setSegments(KdenliveSettings::rendersegments());
 
         /*bool guideMultiExport = false;
         int guideCategory = m_view.guideCategoryChooser->currentCategory();
@@ -65,6 +65,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "titler/titlewidget.h"
 #include "transitions/transitionlist/view/transitionlistwidget.hpp"
 #include "transitions/transitionsrepository.hpp"
+#include "utils/cachemanager.hpp"
 #include "utils/thememanager.h"
 #include "widgets/progressbutton.h"
 #include <config-kdenlive.h>
@@ -5064,50 +5065,54 @@ void MainWindow::checkMaxCacheSize()
         return;
     }
     bool ok;
-    KIO::filesize_t total = 0;
     QDir cacheDir = pCore->currentDoc()->getCacheDir(SystemCacheRoot, &ok);
     if (!ok) {
         return;
     }
-    QDir backupFolder(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + QStringLiteral("/.backup"));
-    QList<QDir> toAdd;
-    QList<QDir> toRemove;
-    if (cacheDir.exists()) {
-        toAdd << cacheDir;
-    }
-    if (backupFolder.exists()) {
-        toAdd << cacheDir;
-    }
-    if (cacheDir.cd(QStringLiteral("knewstuff"))) {
-        toRemove << cacheDir;
-        cacheDir.cdUp();
-    }
-    if (cacheDir.cd(QStringLiteral("attica"))) {
-        toRemove << cacheDir;
-        cacheDir.cdUp();
-    }
-    if (cacheDir.cd(QStringLiteral("proxy"))) {
-        toRemove << cacheDir;
-        cacheDir.cdUp();
-    }
-    pCore->displayMessage(i18n("Checking cached data size"), InformationMessage);
-    while (!toAdd.isEmpty()) {
-        QDir dir = toAdd.takeFirst();
-        KIO::DirectorySizeJob *job = KIO::directorySize(QUrl::fromLocalFile(dir.absolutePath()));
-        job->exec();
-        total += job->totalSize();
-    }
-    while (!toRemove.isEmpty()) {
-        QDir dir = toRemove.takeFirst();
-        KIO::DirectorySizeJob *job = KIO::directorySize(QUrl::fromLocalFile(dir.absolutePath()));
-        job->exec();
-        total -= job->totalSize();
-    }
-    if (total > KIO::filesize_t(1048576) * KdenliveSettings::maxcachesize()) {
+    if (!CacheManager::get()->isIndexed()) {
+        // First run, build the index of the cached files
+        pCore->displayMessage(i18n("Checking cached data size"), InformationMessage);
+        CacheManager::get()->indexFolder(cacheDir);
+    }
+    if (CacheManager::get()->totalSize() <= qint64(1048576) * KdenliveSettings::maxcachesize()) {
+        return;
+    }
+    if (KdenliveSettings::cacheautoeviction()) {
+        slotEnforceCacheBudget();
+    } else {
         slotManageCache();
     }
 }
 
+void MainWindow::slotEnforceCacheBudget()
+{
+    if (KdenliveSettings::maxcachesize() <= 0) {
+        return;
+    }
+    // The cached files of the current project cannot be removed
+    QString currentCache;
+    QStringList proxyHashes;
+    if (pCore->currentDoc()) {
+        bool ok;
+        QDir dir = pCore->currentDoc()->getCacheDir(CacheBase, &ok);
+        if (ok) {
+            currentCache = dir.absolutePath() + QLatin1Char('/');
+        }
+        proxyHashes = pCore->currentDoc()->getProxyHashList();
+    }
+    auto isInUse = [&currentCache, &proxyHashes](CacheType type, const QString &path) {
+        if (type == CacheProxy) {
+            const QString fileName = QFileInfo(path).fileName();
+            return std::any_of(proxyHashes.cbegin(), proxyHashes.cend(), [&fileName](const QString &hash) { return fileName.startsWith(hash); });
+        }
+        return !currentCache.isEmpty() && path.startsWith(currentCache);
+    };
+    qint64 freed = CacheManager::get()->enforceBudget(qint64(1048576) * KdenliveSettings::maxcachesize(), isInUse);
+    if (freed > 0) {
+        pCore->displayMessage(i18n("Removed %1 of least recently used cached data", KIO::convertSize(KIO::filesize_t(freed))), InformationMessage);
+    }
+}
+
 void MainWindow::manageClipJobs(AbstractTask::JOBTYPE type, QWidget *parentWidget)
 {
     QScopedPointer<ClipJobManager> dialog(new ClipJobManager(type, parentWidget ? parentWidget : this));
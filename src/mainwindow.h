@@ -342,6 +342,8 @@ private:
 
 public Q_SLOTS:
     void slotReloadEffects(const QStringList &paths);
+    /** @brief Remove the least recently used cached files until the cached data fits in the maxcachesize budget */
+    void slotEnforceCacheBudget();
     Q_SCRIPTABLE void setRenderingProgress(const QString &url, int progress, int frame);
     Q_SCRIPTABLE void setRenderingFinished(const QString &url, int status, const QString &error);
     Q_SCRIPTABLE void addProjectClip(const QString &url, const QString &folder = QStringLiteral("-1"));
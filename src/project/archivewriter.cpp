@@ -0,0 +1,294 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+
+SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "archivewriter.h"
+#include "kdenlive_debug.h"
+#include "monitor/scopes/dataqueue.h"
+
+#include <KArchive>
+#include <KArchiveDirectory>
+#include <KArchiveFile>
+#include <KLocalizedString>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QThread>
+#include <QtConcurrent>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <utility>
+
+namespace {
+// Size of the blocks read from the source files
+const qint64 chunkSize = 4 * 1024 * 1024;
+// Number of blocks read ahead of the archive writer
+const int readAheadChunks = 16;
+
+struct Chunk
+{
+    // Index of the entry, -1 once all files were read
+    int index = -1;
+    // File data, or the file checksum for the last block of a file
+    QByteArray data;
+    bool endOfFile = false;
+    bool error = false;
+};
+} // namespace
+
+ArchiveWriter::ArchiveWriter(KArchive *archive, QString user, QString group)
+    : m_archive(archive)
+    , m_user(std::move(user))
+    , m_group(std::move(group))
+{
+}
+
+void ArchiveWriter::setDeduplicate(bool deduplicate)
+{
+    m_deduplicate = deduplicate;
+}
+
+QString ArchiveWriter::errorString() const
+{
+    return m_errorString;
+}
+
+int ArchiveWriter::duplicateCount() const
+{
+    return m_duplicates;
+}
+
+const QMap<QString, QByteArray> &ArchiveWriter::checksums() const
+{
+    return m_checksums;
+}
+
+// static
+QByteArray ArchiveWriter::fileChecksum(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    if (!hash.addData(&file)) {
+        return QByteArray();
+    }
+    return hash.result();
+}
+
+QMap<int, int> ArchiveWriter::findDuplicates(const QList<Entry> &entries, const std::function<bool()> &isAborted) const
+{
+    QMap<int, int> duplicates;
+    // Group the files by size, only files with the same size need to be hashed
+    QHash<qint64, QList<int>> bySize;
+    QHash<QString, int> bySource;
+    for (int i = 0; i < entries.count(); ++i) {
+        const QString &source = entries.at(i).source;
+        if (bySource.contains(source)) {
+            // Same file archived under another name
+            duplicates.insert(i, bySource.value(source));
+            continue;
+        }
+        bySource.insert(source, i);
+        qint64 size = QFileInfo(source).size();
+        if (size > 0) {
+            bySize[size].append(i);
+        }
+    }
+    QList<int> candidates;
+    for (auto it = bySize.cbegin(); it != bySize.cend(); ++it) {
+        if (it.value().count() > 1) {
+            candidates << it.value();
+        }
+    }
+    if (candidates.isEmpty() || isAborted()) {
+        return duplicates;
+    }
+    std::sort(candidates.begin(), candidates.end());
+    const QList<QByteArray> hashes =
+        QtConcurrent::blockingMapped<QList<QByteArray>>(candidates, [&entries](int ix) { return fileChecksum(entries.at(ix).source); });
+    QMap<QPair<qint64, QByteArray>, int> firstEntry;
+    for (int i = 0; i < candidates.count(); ++i) {
+        if (hashes.at(i).isEmpty()) {
+            continue;
+        }
+        int ix = candidates.at(i);
+        const QPair<qint64, QByteArray> key(QFileInfo(entries.at(ix).source).size(), hashes.at(i));
+        if (firstEntry.contains(key)) {
+            duplicates.insert(ix, firstEntry.value(key));
+        } else {
+            firstEntry.insert(key, ix);
+        }
+    }
+    return duplicates;
+}
+
+bool ArchiveWriter::addFiles(const QList<Entry> &entries, const std::function<bool()> &isAborted, const std::function<void(int)> &progress)
+{
+    const QMap<int, int> duplicates = m_deduplicate ? findDuplicates(entries, isAborted) : QMap<int, int>();
+    QVector<qint64> sizes(entries.count(), 0);
+    qint64 totalSize = 0;
+    for (int i = 0; i < entries.count(); ++i) {
+        if (!duplicates.contains(i)) {
+            sizes[i] = QFileInfo(entries.at(i).source).size();
+            totalSize += sizes.at(i);
+        }
+    }
+
+    // Read the files on a separate thread, so that reading the next file happens while the archive compresses the data
+    DataQueue<Chunk> queue(readAheadChunks, DataQueue<Chunk>::OverflowModeWait);
+    std::atomic<bool> stopReading{false};
+    QFuture<void> reader = QtConcurrent::run([&entries, &duplicates, &queue, &stopReading]() {
+        for (int i = 0; i < entries.count() && !stopReading; ++i) {
+            if (duplicates.contains(i)) {
+                continue;
+            }
+            QFile file(entries.at(i).source);
+            Chunk chunk;
+            chunk.index = i;
+            if (!file.open(QIODevice::ReadOnly)) {
+                chunk.endOfFile = true;
+                chunk.error = true;
+                queue.push(chunk);
+                continue;
+            }
+            QCryptographicHash hash(QCryptographicHash::Sha1);
+            while (!file.atEnd() && !stopReading) {
+                chunk.data = file.read(chunkSize);
+                if (chunk.data.isEmpty() && file.error() != QFile::NoError) {
+                    chunk.error = true;
+                    break;
+                }
+                hash.addData(chunk.data);
+                queue.push(chunk);
+            }
+            chunk.data = chunk.error ? QByteArray() : hash.result();
+            chunk.endOfFile = true;
+            queue.push(chunk);
+        }
+        queue.push(Chunk());
+    });
+
+    bool success = true;
+    qint64 processed = 0;
+    int lastProgress = -1;
+    for (int i = 0; i < entries.count() && success; ++i) {
+        const Entry &entry = entries.at(i);
+        if (isAborted()) {
+            success = false;
+            break;
+        }
+        QFileInfo info(entry.source);
+        if (duplicates.contains(i)) {
+            // Store a relative link to the identical file
+            const QString target = entries.at(duplicates.value(i)).destination;
+            const QString link = QDir(QStringLiteral("/") + QFileInfo(entry.destination).path()).relativeFilePath(QStringLiteral("/") + target);
+            success = m_archive->writeSymLink(entry.destination, link, m_user, m_group, 0120755, info.lastRead(), info.lastModified(), info.lastModified());
+            if (success) {
+                m_duplicates++;
+                m_checksums.insert(entry.destination, m_checksums.value(target));
+            } else {
+                m_errorString = i18n("Cannot copy file %1 to %2.", entry.source, entry.destination);
+            }
+            continue;
+        }
+        success = m_archive->prepareWriting(entry.destination, m_user, m_group, sizes.at(i), 0100644, info.lastRead(), info.lastModified(), info.lastModified());
+        qint64 written = 0;
+        while (success) {
+            Chunk chunk = queue.pop();
+            if (chunk.index != i || chunk.error) {
+                success = false;
+                break;
+            }
+            if (chunk.endOfFile) {
+                m_checksums.insert(entry.destination, chunk.data);
+                break;
+            }
+            success = written + chunk.data.size() <= sizes.at(i) && m_archive->writeData(chunk.data.constData(), chunk.data.size());
+            written += chunk.data.size();
+            processed += chunk.data.size();
+            int percent = totalSize > 0 ? int(100 * processed / totalSize) : 100;
+            if (percent != lastProgress) {
+                lastProgress = percent;
+                progress(percent);
+            }
+            if (isAborted()) {
+                success = false;
+            }
+        }
+        // The header of the entry was written with the size of the file, it cannot change while archiving
+        success = success && written == sizes.at(i) && m_archive->finishWriting(written);
+        if (!success) {
+            m_errorString = i18n("Cannot copy file %1 to %2.", entry.source, entry.destination);
+        }
+    }
+
+    // Let the reader thread terminate
+    stopReading = true;
+    while (!reader.isFinished()) {
+        if (queue.count() > 0) {
+            Chunk chunk = queue.pop();
+            if (chunk.index < 0) {
+                break;
+            }
+        } else {
+            QThread::msleep(1);
+        }
+    }
+    reader.waitForFinished();
+    if (m_duplicates > 0) {
+        qCDebug(KDENLIVE_LOG) << "Archive stored" << m_duplicates << "duplicate files as links";
+    }
+    return success;
+}
+
+// static
+bool ArchiveWriter::verify(KArchive *archive, const QMap<QString, QByteArray> &checksums, QString *errorString)
+{
+    const KArchiveDirectory *root = archive->directory();
+    for (auto it = checksums.cbegin(); it != checksums.cend(); ++it) {
+        const KArchiveEntry *entry = root->entry(it.key());
+        if (entry == nullptr) {
+            *errorString = i18n("File %1 is missing in the archive.", it.key());
+            return false;
+        }
+        if (!entry->symLinkTarget().isEmpty()) {
+            // Link to another verified file
+            continue;
+        }
+        if (!entry->isFile()) {
+            *errorString = i18n("File %1 is missing in the archive.", it.key());
+            return false;
+        }
+        std::unique_ptr<QIODevice> device(static_cast<const KArchiveFile *>(entry)->createDevice());
+        QCryptographicHash hash(QCryptographicHash::Sha1);
+        if (!device || !hash.addData(device.get()) || hash.result() != it.value()) {
+            *errorString = i18n("File %1 is corrupted in the archive.", it.key());
+            return false;
+        }
+    }
+    return true;
+}
+
+// static
+bool ArchiveWriter::verifyCopies(const QList<Entry> &entries, const std::function<bool()> &isAborted, QString *errorString)
+{
+    for (const Entry &entry : entries) {
+        if (isAborted()) {
+            return false;
+        }
+        const QByteArray hash = fileChecksum(entry.destination);
+        if (hash.isEmpty() || hash != fileChecksum(entry.source)) {
+            *errorString = i18n("File %1 is not identical to %2.", entry.destination, entry.source);
+            return false;
+        }
+    }
+    return true;
+}
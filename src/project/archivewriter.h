@@ -0,0 +1,69 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+
+SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QByteArray>
+#include <QList>
+#include <QMap>
+#include <QString>
+#include <functional>
+
+class KArchive;
+
+/** @class ArchiveWriter
+    @brief Writes a list of local files into an opened KArchive.
+    Files are read ahead on a separate thread while the previous data is compressed, and their checksum is computed on the fly.
+    Files with identical content can be stored only once, the other entries being written as relative symbolic links.
+ */
+class ArchiveWriter
+{
+public:
+    struct Entry
+    {
+        QString source;
+        QString destination;
+    };
+
+    ArchiveWriter(KArchive *archive, QString user, QString group);
+
+    /** @brief If enabled, files with identical content are only stored once.
+     *  Only use it for tar archives, zip tools and Windows do not restore symbolic links */
+    void setDeduplicate(bool deduplicate);
+    /** @brief Write all @param entries to the archive
+     *  @param isAborted is polled between chunks to stop writing
+     *  @param progress receives the progress in percent
+     *  @returns true on success */
+    bool addFiles(const QList<Entry> &entries, const std::function<bool()> &isAborted, const std::function<void(int)> &progress);
+
+    QString errorString() const;
+    /** @brief Number of entries that were stored as a link to an identical file */
+    int duplicateCount() const;
+    /** @brief The checksum of each stored file, by archive path */
+    const QMap<QString, QByteArray> &checksums() const;
+
+    /** @brief Check the data of an archive opened for reading against the @param checksums computed when writing it
+     *  @returns true if all files are present and identical */
+    static bool verify(KArchive *archive, const QMap<QString, QByteArray> &checksums, QString *errorString);
+    /** @brief Check that the copied files are identical to their source */
+    static bool verifyCopies(const QList<Entry> &entries, const std::function<bool()> &isAborted, QString *errorString);
+    /** @brief Returns the checksum of a file, or an empty array if it cannot be read */
+    static QByteArray fileChecksum(const QString &path);
+
+private:
+    KArchive *m_archive;
+    QString m_user;
+    QString m_group;
+    bool m_deduplicate{false};
+    int m_duplicates{0};
+    QString m_errorString;
+    QMap<QString, QByteArray> m_checksums;
+
+    /** @brief Find entries having the same content as a previous entry.
+     *  Only files with the same size are compared.
+     *  @returns a map of the entry index to the index of the first identical entry */
+    QMap<int, int> findDuplicates(const QList<Entry> &entries, const std::function<bool()> &isAborted) const;
+};
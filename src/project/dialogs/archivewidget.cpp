@@ -11,6 +11,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "bin/projectfolder.h"
 #include "bin/projectitemmodel.h"
 #include "core.h"
+#include "project/archivewriter.h"
 #include "projectsettings.h"
 #include "titler/titlewidget.h"
 #include "utils/qstringutils.h"
@@ -29,6 +30,16 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include <QTreeWidget>
 #include <QtConcurrent>
 #include <utility>
+namespace {
+// Returns true if a previous archiving run already copied this file
+bool isAlreadyCopied(const QString &source, const QString &destination)
+{
+    QFileInfo sourceInfo(source);
+    QFileInfo destInfo(destination);
+    return destInfo.exists() && destInfo.size() == sourceInfo.size() && destInfo.lastModified() >= sourceInfo.lastModified();
+}
+} // namespace
+
 ArchiveWidget::ArchiveWidget(const QString &projectName, const QString &xmlData, const QStringList &luma_list, const QStringList &other_list, QWidget *parent)
     : QDialog(parent)
     , m_requestedSize(0)
@@ -52,6 +63,13 @@ ArchiveWidget::ArchiveWidget(const QString &projectName, const QString &xmlData,
     connect(this, &ArchiveWidget::archiveProgress, this, &ArchiveWidget::slotArchivingIntProgress);
     connect(proxy_only, &QCheckBox::stateChanged, this, &ArchiveWidget::slotProxyOnly);
     connect(timeline_archive, &QCheckBox::stateChanged, this, &ArchiveWidget::onlyTimelineItems);
+#ifdef Q_OS_WIN
+    // Duplicates are stored as symbolic links, which cannot be extracted on Windows
+    dedup_archive->setHidden(true);
+#else
+    connect(compression_type, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged), this, &ArchiveWidget::slotUpdateDeduplication);
+    slotUpdateDeduplication();
+#endif
 
     // Prepare xml
     m_doc.setContent(xmlData);
@@ -293,6 +311,8 @@ ArchiveWidget::ArchiveWidget(QUrl url, QWidget *parent)
     project_files->setHidden(true);
     files_list->setHidden(true);
     timeline_archive->setHidden(true);
+    dedup_archive->setHidden(true);
+    verify_archive->setHidden(true);
     compression_type->setHidden(true);
     label->setText(i18n("Extract to"));
     setWindowTitle(i18nc("@title:window", "Open Archived Project"));
@@ -330,6 +350,8 @@ void ArchiveWidget::slotJobResult(bool success, const QString &text)
     compression_type->setEnabled(true);
     proxy_only->setEnabled(true);
     timeline_archive->setEnabled(true);
+    slotUpdateDeduplication();
+    verify_archive->setEnabled(true);
     buttonBox->button(QDialogButtonBox::Apply)->setEnabled(true);
     buttonBox->button(QDialogButtonBox::Apply)->setText(i18n("Archive"));
 }
@@ -608,6 +630,8 @@ bool ArchiveWidget::slotStartArchiving(bool firstPass)
     compression_type->setEnabled(false);
     proxy_only->setEnabled(false);
     timeline_archive->setEnabled(false);
+    dedup_archive->setEnabled(false);
+    verify_archive->setEnabled(false);
     buttonBox->button(QDialogButtonBox::Apply)->setEnabled(false);
     buttonBox->button(QDialogButtonBox::Close)->setText(i18n("Abort"));
 
@@ -622,6 +646,7 @@ bool ArchiveWidget::slotStartArchiving(bool firstPass)
         m_foldersList.clear();
         m_filesList.clear();
         m_processedFiles.clear();
+        m_copiedFiles.clear();
         slotDisplayMessage(QStringLiteral("system-run"), i18n("Archiving…"));
         repaint();
     }
@@ -729,8 +754,11 @@ bool ArchiveWidget::slotStartArchiving(bool firstPass)
                 if (isArchive) {
                     m_filesList.insert(item->text(0), destPath + item->data(0, Qt::UserRole).toString());
                 } else {
-                    m_duplicateFiles.insert(QUrl::fromLocalFile(item->text(0)),
-                                            QUrl::fromLocalFile(destUrl.absoluteFilePath(item->data(0, Qt::UserRole).toString())));
+                    const QString dest = destUrl.absoluteFilePath(item->data(0, Qt::UserRole).toString());
+                    m_copiedFiles.append({item->text(0), dest});
+                    if (!isAlreadyCopied(item->text(0), dest)) {
+                        m_duplicateFiles.insert(QUrl::fromLocalFile(item->text(0)), QUrl::fromLocalFile(dest));
+                    }
                 }
             }
         }
@@ -774,15 +802,26 @@ bool ArchiveWidget::slotStartArchiving(bool firstPass)
             }
         }
         slotArchivingFinished();
-    } else if (files.isEmpty()) {
-        slotStartArchiving(false);
     } else {
-        if (!destUrl.mkpath(QStringLiteral("."))) {
-            KMessageBox::error(this, i18n("Cannot create directory %1", destUrl.absolutePath()));
+        // Files copied by a previous interrupted run are not copied again
+        QList<QUrl> toCopy;
+        for (const QUrl &file : qAsConst(files)) {
+            const QString dest = destUrl.absoluteFilePath(file.fileName());
+            m_copiedFiles.append({file.toLocalFile(), dest});
+            if (!isAlreadyCopied(file.toLocalFile(), dest)) {
+                toCopy << file;
+            }
+        }
+        if (toCopy.isEmpty()) {
+            slotStartArchiving(false);
+        } else {
+            if (!destUrl.mkpath(QStringLiteral("."))) {
+                KMessageBox::error(this, i18n("Cannot create directory %1", destUrl.absolutePath()));
+            }
+            m_copyJob = KIO::copy(toCopy, QUrl::fromLocalFile(destUrl.absolutePath()), KIO::HideProgressInfo);
+            connect(m_copyJob, &KJob::result, this, [this](KJob *jb) { slotArchivingFinished(jb, false); });
+            connect(m_copyJob, &KJob::processedSize, this, &ArchiveWidget::slotArchivingProgress);
         }
-        m_copyJob = KIO::copy(files, QUrl::fromLocalFile(destUrl.absolutePath()), KIO::HideProgressInfo);
-        connect(m_copyJob, &KJob::result, this, [this](KJob *jb) { slotArchivingFinished(jb, false); });
-        connect(m_copyJob, &KJob::processedSize, this, &ArchiveWidget::slotArchivingProgress);
     }
     if (firstPass) {
         progressBar->setValue(0);
@@ -802,10 +841,12 @@ void ArchiveWidget::slotArchivingFinished(KJob *job, bool finished)
         if (!compressed_archive->isChecked()) {
             // Archiving finished
             progressBar->setValue(100);
-            if (processProjectFile()) {
-                slotJobResult(true, i18n("Project was successfully archived."));
-            } else {
+            if (!processProjectFile()) {
                 slotJobResult(false, i18n("There was an error processing project file"));
+            } else if (verify_archive->isChecked()) {
+                verifyCopiedFiles();
+            } else {
+                slotJobResult(true, i18n("Project was successfully archived."));
             }
             buttonBox->button(QDialogButtonBox::Close)->setText(i18n("Close"));
         } else {
@@ -1093,10 +1134,14 @@ void ArchiveWidget::createArchive()
     QFileInfo dirInfo(archive_url->url().toLocalFile());
     QString user = dirInfo.owner();
     QString group = dirInfo.group();
-    if (compression_type->currentIndex() == 1) {
-        m_archive = new KZip(m_archiveName);
+    bool isZip = compression_type->currentIndex() == 1;
+    // Write to a temporary name, so that an interrupted archive is never mistaken for a complete one
+    const QString partName = m_archiveName + QStringLiteral(".part");
+    QFile::remove(partName);
+    if (isZip) {
+        m_archive = new KZip(partName);
     } else {
-        m_archive = new KTar(m_archiveName, QStringLiteral("application/x-gzip"));
+        m_archive = new KTar(partName, QStringLiteral("application/x-gzip"));
     }
 
     QString errorString;
@@ -1115,26 +1160,27 @@ void ArchiveWidget::createArchive()
     }
 
     // Add files
+    ArchiveWriter writer(m_archive, user, group);
+    writer.setDeduplicate(!isZip && dedup_archive->isEnabled() && dedup_archive->isChecked());
     if (success) {
-        int ix = 0;
+        QList<ArchiveWriter::Entry> entries;
+        entries.reserve(m_filesList.count());
         QMapIterator<QString, QString> i(m_filesList);
-        int max = m_filesList.count();
         while (i.hasNext()) {
             i.next();
-            m_infoMessage->setText(i18n("Archiving %1", i.key()));
-            success = m_archive->addLocalFile(i.key(), i.value());
-            Q_EMIT archiveProgress(100 * ix / max);
-            ix++;
-            if (!success || m_abortArchive) {
-                if (!success) {
-                    errorString.append(i18n("Cannot copy file %1 to %2.", i.key(), i.value()));
-                }
-                break;
-            }
+            entries.append({i.key(), i.value()});
+        }
+        Q_EMIT showMessage(QStringLiteral("system-run"), i18n("Archiving…"));
+        success = writer.addFiles(
+            entries, [this]() { return m_abortArchive; }, [this](int progress) { Q_EMIT archiveProgress(progress); });
+        if (!success) {
+            errorString.append(writer.errorString());
         }
     }
 
     if (m_abortArchive) {
+        m_archive->close();
+        QFile::remove(partName);
         return;
     }
 
@@ -1151,9 +1197,53 @@ void ArchiveWidget::createArchive()
     errorString.append(m_archive->errorString());
     success = success && m_archive->close();
 
+    if (success && verify_archive->isChecked()) {
+        Q_EMIT showMessage(QStringLiteral("system-run"), i18n("Verifying archive…"));
+        std::unique_ptr<KArchive> archive;
+        if (isZip) {
+            archive.reset(new KZip(partName));
+        } else {
+            archive.reset(new KTar(partName, QStringLiteral("application/x-gzip")));
+        }
+        QString verifyError;
+        success = archive->open(QIODevice::ReadOnly) && ArchiveWriter::verify(archive.get(), writer.checksums(), &verifyError);
+        if (!success) {
+            errorString.append(verifyError.isEmpty() ? i18n("Cannot open archive file %1", m_archiveName) : verifyError);
+        }
+    }
+    if (success) {
+        QFile::remove(m_archiveName);
+        success = QFile::rename(partName, m_archiveName);
+        if (!success) {
+            errorString.append(i18n("Cannot write to file %1", m_archiveName));
+        }
+    } else {
+        QFile::remove(partName);
+    }
+
     Q_EMIT archivingFinished(success, errorString);
 }
 
+void ArchiveWidget::verifyCopiedFiles()
+{
+    slotDisplayMessage(QStringLiteral("system-run"), i18n("Verifying archived files…"));
+    m_archiveThread = QtConcurrent::run([this]() {
+        QString errorString;
+        bool success = ArchiveWriter::verifyCopies(
+            m_copiedFiles, [this]() { return m_abortArchive; }, &errorString);
+        QMetaObject::invokeMethod(
+            this,
+            [this, success, errorString]() {
+                if (success) {
+                    slotJobResult(true, i18n("Project was successfully archived."));
+                } else {
+                    slotJobResult(false, i18n("There was an error while archiving the project: %1", errorString));
+                }
+            },
+            Qt::QueuedConnection);
+    });
+}
+
 void ArchiveWidget::slotArchivingBoolFinished(bool result, const QString &errorString)
 {
     if (result) {
@@ -1363,6 +1453,12 @@ void ArchiveWidget::updateRequiredSize()
     }
 }
 
+void ArchiveWidget::slotUpdateDeduplication()
+{
+    // Zip tools do not restore symbolic links, only offer it for tar archives
+    dedup_archive->setEnabled(compression_type->currentIndex() == 0);
+}
+
 void ArchiveWidget::onlyTimelineItems(int onlyTimeline)
 {
     int count = files_list->topLevelItemCount();
@@ -8,6 +8,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #pragma once
 
 #include "ui_archivewidget_ui.h"
+#include "project/archivewriter.h"
 #include "timeline2/model/timelinemodel.hpp"
 
 #include <KIO/CopyJob>
@@ -60,6 +61,7 @@ private Q_SLOTS:
     void slotJobResult(bool success, const QString &text);
     void slotProxyOnly(int onlyProxy);
     void onlyTimelineItems(int onlyTimeline);
+    void slotUpdateDeduplication();
 
 protected:
     void closeEvent(QCloseEvent *e) override;
@@ -84,6 +86,8 @@ private:
     QStringList m_foldersList;
     QMap<QString, QString> m_filesList;
     QStringList m_processedFiles;
+    /** @brief Source and destination of the files copied when not creating a compressed archive */
+    QList<ArchiveWriter::Entry> m_copiedFiles;
     bool m_extractMode;
     QUrl m_extractUrl;
     QString m_projectName;
@@ -118,6 +122,8 @@ private:
     void propertyProcessUrl(const QDomElement &e, const QString &propertyName, const QString &root);
     /** @brief Calculate required size for archiving */
     void updateRequiredSize();
+    /** @brief Compare the copied files with their source in a background thread */
+    void verifyCopiedFiles();
 
 Q_SIGNALS:
     void archivingFinished(bool, const QString &);
@@ -10,6 +10,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "core.h"
 #include "doc/kdenlivedoc.h"
 #include "kdenlivesettings.h"
+#include "utils/cachemanager.hpp"
 
 #include <KLocalizedString>
 #include <KMessageBox>
@@ -355,6 +356,7 @@ void TemporaryData::deletePreview()
     }
     if (dir.dirName() == QLatin1String("preview")) {
         dir.removeRecursively();
+        CacheManager::get()->forgetFolder(dir.absolutePath());
         dir.mkpath(QStringLiteral("."));
         Q_EMIT disablePreview();
         updateDataInfo();
@@ -473,6 +475,7 @@ void TemporaryData::deleteProjectProxy()
     }
     for (const QString &file : qAsConst(files)) {
         dir.remove(file);
+        CacheManager::get()->forget(dir.absoluteFilePath(file));
     }
     Q_EMIT disableProxies();
     updateDataInfo();
@@ -492,6 +495,7 @@ void TemporaryData::deleteAudio()
     }
     if (dir.dirName() == QLatin1String("audiothumbs")) {
         dir.removeRecursively();
+        CacheManager::get()->forgetFolder(dir.absolutePath());
         dir.mkpath(QStringLiteral("."));
         updateDataInfo();
     }
@@ -511,6 +515,7 @@ void TemporaryData::deleteThumbs()
     }
     if (dir.dirName() == QLatin1String("videothumbs")) {
         dir.removeRecursively();
+        CacheManager::get()->forgetFolder(dir.absolutePath());
         dir.mkpath(QStringLiteral("."));
         updateDataInfo();
     }
@@ -532,6 +537,7 @@ void TemporaryData::deleteCurrentCacheData(bool warn)
         Q_EMIT disablePreview();
         Q_EMIT disableProxies();
         dir.removeRecursively();
+        CacheManager::get()->forgetFolder(dir.absolutePath());
         m_doc->initCacheDirs();
         if (warn) {
             updateDataInfo();
@@ -667,6 +673,10 @@ void TemporaryData::gotFolderSize(KJob *job)
         // Processing done, check total size
         refreshWarningMessage();
         gTotalSize->setText(KIO::convertSize(m_totalGlobal));
+        const CacheManager::Statistics stats = CacheManager::get()->statistics();
+        const quint64 lookups = stats.hits + stats.misses;
+        gTotalSize->setToolTip(i18n("Indexed cache data: %1 in %2 files\nCache hit rate: %3%", KIO::convertSize(KIO::filesize_t(stats.size)), stats.files,
+                                    lookups == 0 ? 0 : int(100 * stats.hits / lookups)));
         listWidget->setCurrentItem(listWidget->topLevelItem(0));
     } else {
         processglobalDirectories();
@@ -733,6 +743,7 @@ void TemporaryData::deleteCache(QStringList &folders)
         }
         QDir toRemove(m_globalDir.filePath(folder));
         toRemove.removeRecursively();
+        CacheManager::get()->forgetFolder(toRemove.absolutePath());
     }
     updateGlobalInfo();
 }
@@ -749,6 +760,7 @@ void TemporaryData::deleteProxy()
     }
     QDir toRemove(m_globalDir.filePath(QStringLiteral("proxy")));
     toRemove.removeRecursively();
+    CacheManager::get()->forgetFolder(toRemove.absolutePath());
     // We deleted proxy folder, recreate it
     toRemove.mkpath(QStringLiteral("."));
     processProxyDirectory();
@@ -781,6 +793,7 @@ void TemporaryData::cleanProxy()
     }
     for (const QString &f : qAsConst(oldFiles)) {
         proxies.remove(f);
+        CacheManager::get()->forget(proxies.absoluteFilePath(f));
     }
     processProxyDirectory();
 }
@@ -61,6 +61,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include <QSaveFile>
 #include <QTimeZone>
 #include <QUndoGroup>
+#include <QtConcurrent>
 
 static QString getProjectNameFilters(bool ark = true)
 {
@@ -432,6 +433,7 @@ bool ProjectManager::closeCurrentDocument(bool saveChanges, bool quit)
 {
     // Disable autosave
     m_autoSaveTimer.stop();
+    waitForAutoSave();
     if ((m_project != nullptr) && m_project->isModified() && saveChanges) {
         QString message;
         if (m_project->url().fileName().isEmpty()) {
@@ -520,6 +522,7 @@ bool ProjectManager::saveFileAs(const QString &outputFileName, bool saveOverExis
 {
     // Disable autosave while saving
     m_autoSaveTimer.stop();
+    waitForAutoSave();
     pCore->monitorManager()->pauseActiveMonitor();
     QString oldProjectFolder =
         m_project->url().isEmpty() ? QString() : QFileInfo(m_project->url().toLocalFile()).absolutePath() + QStringLiteral("/cachefiles");
@@ -917,6 +920,7 @@ void ProjectManager::doOpenFile(const QUrl &url, KAutoSaveFile *stale, bool isBa
         return;
     }
     m_mltWarnings.clear();
+    pCore->displayMessage(m_project->loadingTimesSummary(), InformationMessage, 5000);
 
     // Re-open active timelines
     QStringList openedTimelines = m_project->getDocumentProperty(QStringLiteral("opensequences")).split(QLatin1Char(';'), Qt::SkipEmptyParts);
@@ -1176,25 +1180,29 @@ void ProjectManager::slotAutoSave()
         // Dont start autosave if the project is still loading
         return;
     }
+    if (m_autoSaveTask.isRunning()) {
+        // The previous backup is still being written, retry later
+        m_autoSaveTimer.start();
+        return;
+    }
     prepareSave();
     QString saveFolder = m_project->url().adjusted(QUrl::RemoveFilename | QUrl::StripTrailingSlash).toLocalFile();
+    // The MLT serialization reads objects that the GUI thread modifies without locking, so it must run here.
+    // Only the string replacements and the file write happen in a worker thread
     QString scene = projectSceneList(saveFolder);
-    if (!m_replacementPattern.isEmpty()) {
-        QMapIterator<QString, QString> i(m_replacementPattern);
-        while (i.hasNext()) {
-            i.next();
-            scene.replace(i.key(), i.value());
-        }
-    }
-    if (!scene.contains(QLatin1String("<track "))) {
-        // In some unexplained cases, the MLT playlist is corrupted and all tracks are deleted. Don't save in that case.
-        pCore->displayMessage(i18n("Project was corrupted, cannot backup. Please close and reopen your project file to recover last backup"), ErrorMessage);
-        return;
-    }
-    m_project->slotAutoSave(scene);
+    KdenliveDoc *project = m_project;
+    const QMap<QString, QString> replacements = m_replacementPattern;
+    m_autoSaveTask = QtConcurrent::run([project, scene, replacements]() { project->slotAutoSave(scene, replacements); });
     m_lastSave.start();
 }
 
+void ProjectManager::waitForAutoSave()
+{
+    if (m_autoSaveTask.isRunning()) {
+        m_autoSaveTask.waitForFinished();
+    }
+}
+
 QString ProjectManager::projectSceneList(const QString &outputFolder, const QString &overlayData, const QString &aspectRatio)
 {
     // Disable multitrack view and overlay
@@ -1465,10 +1473,13 @@ bool ProjectManager::updateTimeline(bool createNewTab, const QString &chunks, co
 {
     pCore->taskManager.slotCancelJobs();
     const QUuid uuid = m_project->uuid();
+    QElapsedTimer stageTimer;
+    stageTimer.start();
     QReadLocker lock(&pCore->xmlMutex);
     std::unique_ptr<Mlt::Producer> xmlProd(
         new Mlt::Producer(pCore->getProjectProfile().get_profile(), "xml-string", m_project->getAndClearProjectXml().constData()));
     lock.unlock();
+    m_project->addLoadingTime(QStringLiteral("mlt"), stageTimer.restart());
     Mlt::Service s(*xmlProd.get());
     Mlt::Tractor tractor(s);
     if (xmlProd->property_exists("kdenlive:projectTractor")) {
@@ -1480,7 +1491,11 @@ bool ProjectManager::updateTimeline(bool createNewTab, const QString &chunks, co
         m_project->cleanupTimelinePreview(documentDate);
         pCore->projectItemModel()->buildPlaylist(uuid);
         // Load bin playlist
-        return loadProjectBin(tractor, activeUuid);
+        bool loaded = loadProjectBin(tractor, activeUuid);
+        if (m_project) {
+            m_project->addLoadingTime(QStringLiteral("timeline"), stageTimer.elapsed());
+        }
+        return loaded;
     }
     if (tractor.count() == 0 || pCore->closing) {
         // Wow we have a project file with empty tractor, probably corrupted, propose to open a recovery file
@@ -1523,6 +1538,7 @@ bool ProjectManager::updateTimeline(bool createNewTab, const QString &chunks, co
         requestBackup(i18n("Project file is corrupted - failed to load tracks. Try to find a backup file?"));
         return false;
     }
+    m_project->addLoadingTime(QStringLiteral("timeline"), stageTimer.elapsed());
     // Free memory used by original playlist
     xmlProd->clear();
     xmlProd.reset(nullptr);
@@ -8,6 +8,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "kdenlivecore_export.h"
 #include <KRecentFilesAction>
 #include <QDir>
+#include <QFuture>
 #include <QObject>
 #include <QTime>
 #include <QTimer>
@@ -255,6 +256,8 @@ private:
     std::shared_ptr<TimelineItemModel> m_activeTimelineModel;
     QElapsedTimer m_lastSave;
     QTimer m_autoSaveTimer;
+    /** @brief The backup being written in a worker thread */
+    QFuture<void> m_autoSaveTask;
     QUrl m_startUrl;
     QString m_loadClipsOnOpen;
     QMap<QString, QString> m_replacementPattern;
@@ -273,6 +276,8 @@ private:
                                 TimelineWidget *timelineWidget);
     /** @brief Ensure sequences are correctly stored in our project model */
     void checkProjectIntegrity();
+    /** @brief Wait until the backup being written in a worker thread is finished */
+    void waitForAutoSave();
     /** @brief Opening a project file failed, propose to open a backup */
     void abortProjectLoad(const QUrl &url);
 };
@@ -30,6 +30,13 @@ QStringList RenderRequest::argsByJob(const RenderJob &job)
     if (!job.subtitlePath.isEmpty()) {
         args << QStringLiteral("--subtitle") << job.subtitlePath;
     }
+    if (!job.segments.isEmpty()) {
+        QStringList bounds;
+        for (int frame : job.segments) {
+            bounds << QString::number(frame);
+        }
+        args << QStringLiteral("--segments") << bounds.join(QLatin1Char(','));
+    }
     return args;
 }
 
@@ -121,6 +128,11 @@ void RenderRequest::setAspectRatio(const QString &aspectRatio)
     m_aspectRatio = aspectRatio;
 }
 
+void RenderRequest::setSegments(int count)
+{
+    m_segments = qMax(1, count);
+}
+
 std::vector<RenderRequest::RenderJob> RenderRequest::process()
 {
     m_errors.clear();
@@ -257,12 +269,16 @@ void RenderRequest::createRenderJobs(std::vector<RenderJob> &jobs, const QDomDoc
         if (pass == 2) {
             job.playlistPath = QStringUtils::appendToFilename(job.playlistPath, QStringLiteral("-pass%1").arg(2));
         }
-        jobs.push_back(job);
 
         // get the consumer element
         QDomNodeList consumers = final.elementsByTagName(QStringLiteral("consumer"));
         QDomElement consumer = consumers.at(0).toElement();
 
+        if (passes == 1 && !m_delayedRendering && !m_presetParams.isImageSequence()) {
+            job.segments = segmentBounds(consumer.attribute(QStringLiteral("in")).toInt(), consumer.attribute(QStringLiteral("out")).toInt());
+        }
+        jobs.push_back(job);
+
         consumer.setAttribute(QStringLiteral("target"), job.outputPath);
 
         // Set two pass parameters. In case pass is 0 the function does nothing.
@@ -442,6 +458,57 @@ std::vector<RenderRequest::RenderSection> RenderRequest::getGuideSections()
     return sections;
 }
 
+QList<int> RenderRequest::segmentBounds(int in, int out)
+{
+    QList<int> bounds;
+    if (m_segments < 2 || out <= in || KdenliveSettings::ffmpegpath().isEmpty()) {
+        return bounds;
+    }
+    if (m_presetParams.value(QStringLiteral("vn")) == QLatin1String("1")) {
+        // Audio is rendered in a single pass anyway
+        return bounds;
+    }
+    double fps = pCore->getCurrentFps();
+    // Keyframe interval of the encoder, segments start on a keyframe
+    int gop = qMax(1, m_presetParams.value(QStringLiteral("g")).toInt());
+    // Don't start a process for less than a minute of video
+    int minLength = qMax(gop, int(60 * fps));
+    int count = qMin(m_segments, (out - in + 1) / minLength);
+    if (count < 2) {
+        return bounds;
+    }
+    QList<int> guides;
+    if (auto ptr = m_guidesModel.lock()) {
+        for (const auto &marker : ptr->getAllMarkers(m_guideCategory)) {
+            int pos = marker.time().frames(fps);
+            if (pos > in && pos < out) {
+                guides << pos;
+            }
+        }
+    }
+    int length = (out - in + 1) / count;
+    int previous = in;
+    for (int i = 1; i < count; i++) {
+        int target = in + i * length;
+        // Prefer a guide, usually a scene change, within a quarter of the segment length
+        int bound = -1;
+        for (int pos : qAsConst(guides)) {
+            if (qAbs(pos - target) <= length / 4 && (bound < 0 || qAbs(pos - target) < qAbs(bound - target))) {
+                bound = pos;
+            }
+        }
+        if (bound < 0) {
+            bound = in + qRound(double(target - in) / gop) * gop;
+        }
+        if (bound - previous < gop || out - bound < gop) {
+            continue;
+        }
+        bounds << bound;
+        previous = bound;
+    }
+    return bounds;
+}
+
 void RenderRequest::prepareMultiAudioFiles(std::vector<RenderJob> &jobs, const QDomDocument &doc, const QString &playlistFile, const QString &targetFile,
                                            const QUuid &uuid)
 {
@@ -19,6 +19,8 @@ public:
         QString playlistPath;
         QString outputPath;
         QString subtitlePath;
+        /** @brief First frame of each segment after the first one, when the output is rendered in parallel segments */
+        QList<int> segments;
     };
 
     /** @brief Set frame range that should be rendered
@@ -38,6 +40,10 @@ public:
     void setAudioFilePerTrack(bool enabled);
     void setGuideParams(std::weak_ptr<MarkerListModel> model, bool enableMultiExport, int filterCategory);
     void setOverlayData(const QString &data);
+    /** @brief Split the render range in up to @param count segments rendered in parallel and joined without re-encoding.
+     *  1 disables segmented rendering.
+     */
+    void setSegments(int count);
 
     std::vector<RenderJob> process();
 
@@ -67,6 +73,7 @@ private:
     bool m_guideMultiExport = false;
     int m_guideCategory = -1; /// category used as filter if @variable guideMultiExport is @value true
     bool m_twoPass = false;
+    int m_segments = 1;
 
     QStringList m_errors;
 
@@ -91,5 +98,12 @@ private:
     void createRenderJobs(std::vector<RenderJob> &jobs, const QDomDocument &doc, const QString &playlistPath, QString outputPath, const QString &subtitlePath,
                           const QUuid &uuid);
 
+    /** @brief Returns the first frame of each segment after the first one, to render the range from @param in to @param out in parallel.
+     *  Boundaries are placed on a guide when one is close, otherwise on a multiple of the GOP size to keep a regular keyframe interval.
+     *  Each segment starts with a new GOP, so the keyframes around the bounds may differ from a single render.
+     *  Returns an empty list if the output cannot be rendered in segments: audio only output, or FFmpeg not available to join the segments.
+     */
+    QList<int> segmentBounds(int in, int out);
+
     void addErrorMessage(const QString &error);
 };
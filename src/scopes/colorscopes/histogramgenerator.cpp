@@ -6,6 +6,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 */
 
 #include "histogramgenerator.h"
+#include "parallelscan.h"
 
 #include "klocalizedstring.h"
 #include <QDebug>
@@ -29,43 +30,73 @@ QImage HistogramGenerator::calculateHistogram(const QSize &paradeSize, const QIm
     bool drawB = (components & HistogramGenerator::ComponentB) != 0;
     bool drawSum = (components & HistogramGenerator::ComponentSum) != 0;
 
-    int r[256], g[256], b[256], y[256], s[766];
+    struct Bins
+    {
+        int r[256], g[256], b[256], y[256], s[766];
+    };
+    Bins empty;
     // Initialize the values to zero
-    std::fill(r, r + 256, 0);
-    std::fill(g, g + 256, 0);
-    std::fill(b, b + 256, 0);
-    std::fill(y, y + 256, 0);
-    std::fill(s, s + 766, 0);
+    std::fill(empty.r, empty.r + 256, 0);
+    std::fill(empty.g, empty.g + 256, 0);
+    std::fill(empty.b, empty.b + 256, 0);
+    std::fill(empty.y, empty.y + 256, 0);
+    std::fill(empty.s, empty.s + 766, 0);
 
     const int ww = paradeSize.width();
     const int wh = paradeSize.height();
 
-    // Read the stats from the input image
-    for (int Y = 0; Y < image.height(); ++Y) {
-        for (int X = 0; X < image.width(); X += accelFactor) {
-
-            QRgb col = image.pixel(X, Y);
-            r[qRed(col)]++;
-            g[qGreen(col)]++;
-            b[qBlue(col)]++;
+    // Luminance weights in 16 bit fixed point
+    const bool rec601 = rec == ITURec::Rec_601;
+    const int kr = int(65536 * (rec601 ? REC_601_R : REC_709_R));
+    const int kg = int(65536 * (rec601 ? REC_601_G : REC_709_G));
+    const int kb = int(65536 * (rec601 ? REC_601_B : REC_709_B));
+    // Compensates the truncation of the weights, so that a gray pixel falls on its own value
+    const int lumaBias = 1 << 10;
+
+    // Read the stats from the input image, each thread fills its own bins
+    const QImage source = ParallelScan::rgbImage(image);
+    const int iw = source.width();
+    std::vector<Bins> bands = ParallelScan::scanLines(source, empty, [&](Bins &bins, const QRgb *line, int) {
+        for (int X = 0; X < iw; X += int(accelFactor)) {
+            const QRgb col = line[X];
+            const int red = qRed(col);
+            const int green = qGreen(col);
+            const int blue = qBlue(col);
+            bins.r[red]++;
+            bins.g[green]++;
+            bins.b[blue]++;
 
             if (drawY) {
-                // Use if branch to avoid expensive multiplication if Y disabled
-                if (rec == ITURec::Rec_601) {
-                    y[int(REC_601_R * qRed(col) + REC_601_G * qGreen(col) + REC_601_B * qBlue(col))]++;
-                } else {
-                    y[int(REC_709_R * qRed(col) + REC_709_G * qGreen(col) + REC_709_B * qBlue(col))]++;
-                }
+                // Use if branch to avoid the multiplications if Y disabled
+                bins.y[qMin(255, (kr * red + kg * green + kb * blue + lumaBias) >> 16)]++;
             }
 
             if (drawSum) {
                 // Use an if branch here because the sum takes more operations than rgb
-                s[qRed(col)]++;
-                s[qGreen(col)]++;
-                s[qBlue(col)]++;
+                bins.s[red]++;
+                bins.s[green]++;
+                bins.s[blue]++;
             }
         }
+    });
+    Bins &bins = bands.front();
+    for (size_t band = 1; band < bands.size(); ++band) {
+        const Bins &other = bands.at(band);
+        for (int i = 0; i < 256; ++i) {
+            bins.r[i] += other.r[i];
+            bins.g[i] += other.g[i];
+            bins.b[i] += other.b[i];
+            bins.y[i] += other.y[i];
+        }
+        for (int i = 0; i < 766; ++i) {
+            bins.s[i] += other.s[i];
+        }
     }
+    const int *r = bins.r;
+    const int *g = bins.g;
+    const int *b = bins.b;
+    const int *y = bins.y;
+    const int *s = bins.s;
 
     const int nParts = (drawY ? 1 : 0) + (drawR ? 1 : 0) + (drawG ? 1 : 0) + (drawB ? 1 : 0) + (drawSum ? 1 : 0);
     if (nParts == 0) {
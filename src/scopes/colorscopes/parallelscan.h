@@ -0,0 +1,84 @@
+#pragma once
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    This file is part of kdenlive. See www.kdenlive.org.
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include <QImage>
+#include <QThread>
+#include <QtConcurrent>
+#include <numeric>
+#include <vector>
+
+/**
+ * Helpers used by the scope generators to read the analysed frame
+ * line by line from several threads.
+ */
+namespace ParallelScan {
+
+/** @brief Returns the image in a 32 bit format whose scanlines can be read as QRgb values */
+inline QImage rgbImage(const QImage &image)
+{
+    if (image.format() == QImage::Format_RGB32 || image.format() == QImage::Format_ARGB32) {
+        return image;
+    }
+    return image.convertToFormat(QImage::Format_ARGB32);
+}
+
+/** @brief Split the lines of @param image in bands processed in parallel.
+ *  Each band works on its own copy of @param init, @param process is called for each line
+ *  of the band with the accumulator, the line pixels and the line number.
+ *  The accumulators are returned in the image order so that the caller can merge them.
+ *  @param image must be in one of the formats returned by rgbImage()
+ */
+template <typename Accumulator, typename Process> std::vector<Accumulator> scanLines(const QImage &image, const Accumulator &init, Process process)
+{
+    // Don't create bands of a few lines, the accumulators have to be merged
+    const int bands = qBound(1, QThread::idealThreadCount(), qMax(1, image.height() / 32));
+    std::vector<Accumulator> results(size_t(bands), init);
+    std::vector<int> indexes(size_t(bands));
+    std::iota(indexes.begin(), indexes.end(), 0);
+    auto processBand = [&](int band) {
+        const int first = image.height() * band / bands;
+        const int last = image.height() * (band + 1) / bands;
+        for (int y = first; y < last; ++y) {
+            process(results[size_t(band)], reinterpret_cast<const QRgb *>(image.constScanLine(y)), y);
+        }
+    };
+    if (bands == 1) {
+        processBand(0);
+    } else {
+        QtConcurrent::blockingMap(indexes, processBand);
+    }
+    return results;
+}
+
+/** @brief Split the columns of @param image in bands processed in parallel, each band reading all the lines.
+ *  Unlike scanLines(), there is no accumulator copy: this is meant for results as large as the scope,
+ *  when each band of columns only writes its own part of the result.
+ *  @param bounds the first column of each band, followed by the image width
+ *  @param process is called for each line of each band with the line pixels, the line number and the band columns, last one excluded
+ *  @param image must be in one of the formats returned by rgbImage()
+ */
+template <typename Process> void scanColumns(const QImage &image, const std::vector<int> &bounds, Process process)
+{
+    const int bands = int(bounds.size()) - 1;
+    if (bands < 1) {
+        return;
+    }
+    std::vector<int> indexes(size_t(bands));
+    std::iota(indexes.begin(), indexes.end(), 0);
+    auto processBand = [&](int band) {
+        for (int y = 0; y < image.height(); ++y) {
+            process(reinterpret_cast<const QRgb *>(image.constScanLine(y)), y, bounds[size_t(band)], bounds[size_t(band) + 1]);
+        }
+    };
+    if (bands == 1) {
+        processBand(0);
+    } else {
+        QtConcurrent::blockingMap(indexes, processBand);
+    }
+}
+
+} // namespace ParallelScan
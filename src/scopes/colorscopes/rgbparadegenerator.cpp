@@ -6,6 +6,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 */
 
 #include "rgbparadegenerator.h"
+#include "parallelscan.h"
 #include "klocalizedstring.h"
 #include <QColor>
 #include <QDebug>
@@ -28,6 +29,13 @@ struct StructRGB
     uint b;
 };
 
+struct ParadeValues
+{
+    std::vector<StructRGB> values;
+    // Statistics
+    uchar minR = 255, minG = 255, minB = 255, maxR = 0, maxG = 0, maxB = 0;
+};
+
 RGBParadeGenerator::RGBParadeGenerator() = default;
 
 QImage RGBParadeGenerator::calculateRGBParade(const QSize &paradeSize, const QImage &image, const RGBParadeGenerator::PaintMode paintMode, bool drawAxis,
@@ -57,9 +65,6 @@ QImage RGBParadeGenerator::calculateRGBParade(const QSize &paradeSize, const QIm
     const uint partW = (ww - 2 * offset - distRight) / 3;
     const uint partH = wh - distBottom;
 
-    // Statistics
-    uchar minR = 255, minG = 255, minB = 255, maxR = 0, maxG = 0, maxB = 0;
-
     // Number of input pixels that will fall on one scope pixel.
     // Must be a float because the acceleration factor can be high, leading to <1 expected px per px.
     const float pixelDepth = float((iw * ih) / accelFactor) / (partW * 255);
@@ -71,63 +76,69 @@ QImage RGBParadeGenerator::calculateRGBParade(const QSize &paradeSize, const QIm
 
     const float wPrediv = float(partW - 1) / (iw - 1);
 
-    std::vector<std::vector<StructRGB>> paradeVals(partW, std::vector<StructRGB>(256, {0, 0, 0}));
-
-    const auto totalPixels = image.width() * image.height();
-    for (int i = 0; i < totalPixels; i += accelFactor) {
-        const auto x = i % image.width();
-        const QRgb pixel = image.pixel(x, i / image.width());
-        auto r = uchar(qRed(pixel));
-        auto g = uchar(qGreen(pixel));
-        auto b = uchar(qBlue(pixel));
-
-        double dx = x * double(wPrediv);
-
-        paradeVals[size_t(dx)][r].r++;
-        paradeVals[size_t(dx)][g].g++;
-        paradeVals[size_t(dx)][b].b++;
+    // Parade column of each image column
+    std::vector<uint> columns(iw);
+    for (uint x = 0; x < iw; ++x) {
+        columns[x] = uint(x * double(wPrediv)) * 256;
+    }
 
-        if (r < minR) {
-            minR = r;
-        }
-        if (g < minG) {
-            minG = g;
-        }
-        if (b < minB) {
-            minB = b;
-        }
-        if (r > maxR) {
-            maxR = r;
+    // Each thread fills its own values, stored column by column
+    ParadeValues empty;
+    empty.values.resize(size_t(partW) * 256, {0, 0, 0});
+    const QImage source = ParallelScan::rgbImage(image);
+    std::vector<ParadeValues> bands = ParallelScan::scanLines(source, empty, [&](ParadeValues &parade, const QRgb *line, int y) {
+        StructRGB *data = parade.values.data();
+        // Keep the same subsampling pattern as when counting pixels over the whole frame
+        for (uint x = (accelFactor - uint(y) * iw % accelFactor) % accelFactor; x < iw; x += accelFactor) {
+            const QRgb pixel = line[x];
+            auto r = uchar(qRed(pixel));
+            auto g = uchar(qGreen(pixel));
+            auto b = uchar(qBlue(pixel));
+            StructRGB *column = data + columns[x];
+            column[r].r++;
+            column[g].g++;
+            column[b].b++;
+            parade.minR = qMin(parade.minR, r);
+            parade.minG = qMin(parade.minG, g);
+            parade.minB = qMin(parade.minB, b);
+            parade.maxR = qMax(parade.maxR, r);
+            parade.maxG = qMax(parade.maxG, g);
+            parade.maxB = qMax(parade.maxB, b);
         }
-        if (g > maxG) {
-            maxG = g;
-        }
-        if (b > maxB) {
-            maxB = b;
+    });
+    ParadeValues &paradeVals = bands.front();
+    for (size_t band = 1; band < bands.size(); ++band) {
+        const ParadeValues &other = bands.at(band);
+        for (size_t i = 0; i < paradeVals.values.size(); ++i) {
+            paradeVals.values[i].r += other.values[i].r;
+            paradeVals.values[i].g += other.values[i].g;
+            paradeVals.values[i].b += other.values[i].b;
         }
+        paradeVals.minR = qMin(paradeVals.minR, other.minR);
+        paradeVals.minG = qMin(paradeVals.minG, other.minG);
+        paradeVals.minB = qMin(paradeVals.minB, other.minB);
+        paradeVals.maxR = qMax(paradeVals.maxR, other.maxR);
+        paradeVals.maxG = qMax(paradeVals.maxG, other.maxG);
+        paradeVals.maxB = qMax(paradeVals.maxB, other.maxB);
     }
+    const uchar minR = paradeVals.minR, minG = paradeVals.minG, minB = paradeVals.minB;
+    const uchar maxR = paradeVals.maxR, maxG = paradeVals.maxG, maxB = paradeVals.maxB;
 
     const int offset1 = int(partW + offset);
     const int offset2 = int(2 * partW + 2 * offset);
-    switch (paintMode) {
-    case PaintMode_RGB:
+    const bool rgbMode = paintMode == PaintMode_RGB;
+    const QRgb colR = rgbMode ? qRgb(255, 10, 10) : qRgb(255, 255, 255);
+    const QRgb colG = rgbMode ? qRgb(10, 255, 10) : qRgb(255, 255, 255);
+    const QRgb colB = rgbMode ? qRgb(10, 10, 255) : qRgb(255, 255, 255);
+    for (int j = 0; j < 256; ++j) {
+        auto *line = reinterpret_cast<QRgb *>(unscaled.scanLine(j));
+        const StructRGB *values = paradeVals.values.data() + j;
         for (int i = 0; i < int(partW); ++i) {
-            for (int j = 0; j < 256; ++j) {
-                unscaled.setPixel(i, j, qRgba(255, 10, 10, CHOP255(gain * float(paradeVals[size_t(i)][size_t(j)].r))));
-                unscaled.setPixel(i + offset1, j, qRgba(10, 255, 10, CHOP255(gain * float(paradeVals[size_t(i)][size_t(j)].g))));
-                unscaled.setPixel(i + offset2, j, qRgba(10, 10, 255, CHOP255(gain * float(paradeVals[size_t(i)][size_t(j)].b))));
-            }
-        }
-        break;
-    default:
-        for (int i = 0; i < int(partW); ++i) {
-            for (int j = 0; j < 256; ++j) {
-                unscaled.setPixel(i, j, qRgba(255, 255, 255, CHOP255(gain * float(paradeVals[size_t(i)][size_t(j)].r))));
-                unscaled.setPixel(i + offset1, j, qRgba(255, 255, 255, CHOP255(gain * float(paradeVals[size_t(i)][size_t(j)].g))));
-                unscaled.setPixel(i + offset2, j, qRgba(255, 255, 255, CHOP255(gain * float(paradeVals[size_t(i)][size_t(j)].b))));
-            }
+            const StructRGB &value = values[i * 256];
+            line[i] = (colR & RGB_MASK) | uint(CHOP255(gain * float(value.r))) << 24;
+            line[i + offset1] = (colG & RGB_MASK) | uint(CHOP255(gain * float(value.g))) << 24;
+            line[i + offset2] = (colB & RGB_MASK) | uint(CHOP255(gain * float(value.b))) << 24;
         }
-        break;
     }
 
     // Scale the image to the target height. Scaling is not accomplished before because
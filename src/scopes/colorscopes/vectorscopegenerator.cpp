@@ -61,6 +61,7 @@ mRgb2YPbPr =                        r =
  */
 
 #include "vectorscopegenerator.h"
+#include "parallelscan.h"
 #include <cmath>
 
 // The maximum distance from the center for any RGB color is 0.63, so
@@ -119,11 +120,6 @@ QImage VectorscopeGenerator::calculateVectorscope(const QSize &vectorscopeSize,
     QImage scope = QImage(cw, cw, QImage::Format_ARGB32);
     scope.fill(qRgba(0, 0, 0, 0));
 
-    double dy, dr, dg, db, dmax;
-    double /*y,*/ u, v;
-    QPoint pt;
-    QRgb px;
-
     // Just an average for the number of image pixels per scope pixel.
     // NOTE: byteCount() has to be replaced by (img.bytesPerLine()*img.height()) for Qt 4.5 to compile, see:
     // https://doc.qt.io/qt-5/qimage.html#bytesPerLine
@@ -132,35 +128,60 @@ QImage VectorscopeGenerator::calculateVectorscope(const QSize &vectorscopeSize,
     // benchmarking code
     // const auto start = std::chrono::high_resolution_clock::now();
 
-    const auto totalPixels = image.width() * image.height();
-    for (int i = 0; i < totalPixels; i += accelFactor) {
-        const QRgb pixel = image.pixel(i % image.width(), i / image.width());
-        const int r = qRed(pixel);
-        const int g = qGreen(pixel);
-        const int b = qBlue(pixel);
-
-        switch (colorSpace) {
-        case VectorscopeGenerator::ColorSpace_YUV:
-            //             y = (double)  0.001173 * r +0.002302 * g +0.0004471* b;
-            u = -0.0005781 * r - 0.001135 * g + 0.001713 * b;
-            v = 0.002411 * r - 0.002019 * g - 0.0003921 * b;
-            break;
-        case VectorscopeGenerator::ColorSpace_YPbPr:
-        default:
-            //             y = (double)  0.001173 * r +0.002302 * g +0.0004471* b;
-            u = -0.0006671 * r - 0.001299 * g + 0.0019608 * b;
-            v = 0.001961 * r - 0.001642 * g - 0.0003189 * b;
-            break;
-        }
-
-        pt = mapToCircle(vectorscopeSize, QPointF(SCALING * double(gain) * u, SCALING * double(gain) * v));
+    // The color of a scope pixel only depends on the number of image pixels that fall on it
+    // and, for the color modes, on the last of these pixels. Threads count the hits on their own
+    // copy of the scope, the copies are then merged in the image order.
+    const bool colorMode = paintMode == PaintMode_YUV || paintMode == PaintMode_Chroma || paintMode == PaintMode_Original;
+    struct ScopeHits
+    {
+        std::vector<uint> hits;
+        std::vector<QRgb> colors;
+    };
+    ScopeHits empty;
+    empty.hits.resize(size_t(cw * cw), 0);
+    if (colorMode) {
+        empty.colors.resize(size_t(cw * cw), 0);
+    }
+    const QImage source = ParallelScan::rgbImage(image);
+    const uint iw = uint(source.width());
+    std::vector<ScopeHits> bands = ParallelScan::scanLines(source, empty, [&](ScopeHits &result, const QRgb *line, int y) {
+        double dy, dr, dg, db, dmax;
+        double /*y,*/ u, v;
+        QPoint pt;
+        // Keep the same subsampling pattern as when iterating over the whole frame
+        for (uint x = (accelFactor - uint(y) * iw % accelFactor) % accelFactor; x < iw; x += accelFactor) {
+            const QRgb pixel = line[x];
+            const int r = qRed(pixel);
+            const int g = qGreen(pixel);
+            const int b = qBlue(pixel);
+
+            switch (colorSpace) {
+            case VectorscopeGenerator::ColorSpace_YUV:
+                //             y = (double)  0.001173 * r +0.002302 * g +0.0004471* b;
+                u = -0.0005781 * r - 0.001135 * g + 0.001713 * b;
+                v = 0.002411 * r - 0.002019 * g - 0.0003921 * b;
+                break;
+            case VectorscopeGenerator::ColorSpace_YPbPr:
+            default:
+                //             y = (double)  0.001173 * r +0.002302 * g +0.0004471* b;
+                u = -0.0006671 * r - 0.001299 * g + 0.0019608 * b;
+                v = 0.001961 * r - 0.001642 * g - 0.0003189 * b;
+                break;
+            }
 
-        if (pt.x() >= scope.width() || pt.x() < 0 || pt.y() >= scope.height() || pt.y() < 0) {
-            // Point lies outside (because of scaling), don't plot it
+            pt = mapToCircle(vectorscopeSize, QPointF(SCALING * double(gain) * u, SCALING * double(gain) * v));
 
-        } else {
+            if (pt.x() >= cw || pt.x() < 0 || pt.y() >= cw || pt.y() < 0) {
+                // Point lies outside (because of scaling), don't plot it
+                continue;
+            }
+            const size_t ix = size_t(pt.y() * cw + pt.x());
+            result.hits[ix]++;
+            if (!colorMode) {
+                continue;
+            }
 
-            // Draw the pixel using the chosen draw mode.
+            // Calculate the pixel color using the chosen draw mode.
             switch (paintMode) {
             case PaintMode_YUV:
                 // see yuvColorWheel
@@ -181,26 +202,11 @@ QImage VectorscopeGenerator::calculateVectorscope(const QSize &vectorscopeSize,
                     break;
                 }
 
-                if (dr < 0) {
-                    dr = 0;
-                }
-                if (dg < 0) {
-                    dg = 0;
-                }
-                if (db < 0) {
-                    db = 0;
-                }
-                if (dr > 255) {
-                    dr = 255;
-                }
-                if (dg > 255) {
-                    dg = 255;
-                }
-                if (db > 255) {
-                    db = 255;
-                }
+                dr = qBound(0., dr, 255.);
+                dg = qBound(0., dg, 255.);
+                db = qBound(0., db, 255.);
 
-                scope.setPixel(pt, qRgba(int(dr), int(dg), int(db), 255));
+                result.colors[ix] = qRgba(int(dr), int(dg), int(db), 255);
                 break;
 
             case PaintMode_Chroma:
@@ -235,28 +241,67 @@ QImage VectorscopeGenerator::calculateVectorscope(const QSize &vectorscopeSize,
                 dg *= dmax;
                 db *= dmax;
 
-                scope.setPixel(pt, qRgba(int(dr), int(dg), int(db), 255));
+                result.colors[ix] = qRgba(int(dr), int(dg), int(db), 255);
                 break;
             case PaintMode_Original:
-                scope.setPixel(pt, pixel);
-                break;
-            case PaintMode_Green:
-                px = scope.pixel(pt);
-                scope.setPixel(pt, qRgba(qRed(px) + int((255 - qRed(px)) / (3 * avgPxPerPx)), qGreen(px) + int(20 * (255 - qGreen(px)) / (avgPxPerPx)),
-                                         qBlue(px) + int((255 - qBlue(px)) / (avgPxPerPx)), qAlpha(px) + int((255 - qAlpha(px)) / (avgPxPerPx))));
-                break;
-            case PaintMode_Green2:
-                px = scope.pixel(pt);
-                scope.setPixel(pt, qRgba(qRed(px) + int(ceil((255 - qRed(px)) / (4 * avgPxPerPx))), 255,
-                                         qBlue(px) + int(ceil((255 - qBlue(px)) / (avgPxPerPx))), qAlpha(px) + int(ceil((255 - qAlpha(px)) / (avgPxPerPx)))));
-                break;
-            case PaintMode_Black:
             default:
-                px = scope.pixel(pt);
-                scope.setPixel(pt, qRgba(0, 0, 0, qAlpha(px) + (255 - qAlpha(px)) / 20));
+                result.colors[ix] = pixel;
                 break;
             }
         }
+    });
+
+    ScopeHits &merged = bands.front();
+    for (size_t band = 1; band < bands.size(); ++band) {
+        const ScopeHits &other = bands.at(band);
+        for (size_t ix = 0; ix < merged.hits.size(); ++ix) {
+            if (other.hits[ix] > 0) {
+                merged.hits[ix] += other.hits[ix];
+                if (colorMode) {
+                    merged.colors[ix] = other.colors[ix];
+                }
+            }
+        }
+    }
+
+    // Draw the scope line by line
+    QRgb px;
+    for (int j = 0; j < cw; ++j) {
+        auto *line = reinterpret_cast<QRgb *>(scope.scanLine(j));
+        const uint *hits = merged.hits.data() + size_t(j * cw);
+        for (int i = 0; i < cw; ++i) {
+            uint count = hits[i];
+            if (count == 0) {
+                continue;
+            }
+            if (colorMode) {
+                line[i] = merged.colors[size_t(j * cw + i)];
+                continue;
+            }
+            // Apply the blending once per hit, stop when the color does not change anymore
+            px = line[i];
+            for (; count > 0; --count) {
+                QRgb previous = px;
+                switch (paintMode) {
+                case PaintMode_Green:
+                    px = qRgba(qRed(px) + int((255 - qRed(px)) / (3 * avgPxPerPx)), qGreen(px) + int(20 * (255 - qGreen(px)) / (avgPxPerPx)),
+                               qBlue(px) + int((255 - qBlue(px)) / (avgPxPerPx)), qAlpha(px) + int((255 - qAlpha(px)) / (avgPxPerPx)));
+                    break;
+                case PaintMode_Green2:
+                    px = qRgba(qRed(px) + int(ceil((255 - qRed(px)) / (4 * avgPxPerPx))), 255, qBlue(px) + int(ceil((255 - qBlue(px)) / (avgPxPerPx))),
+                               qAlpha(px) + int(ceil((255 - qAlpha(px)) / (avgPxPerPx))));
+                    break;
+                case PaintMode_Black:
+                default:
+                    px = qRgba(0, 0, 0, qAlpha(px) + (255 - qAlpha(px)) / 20);
+                    break;
+                }
+                if (px == previous) {
+                    break;
+                }
+            }
+            line[i] = px;
+        }
     }
     // const auto elapsed = std::chrono::high_resolution_clock::now() - start;
     // uint64_t us = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
@@ -6,6 +6,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 */
 
 #include "waveformgenerator.h"
+#include "parallelscan.h"
 
 #include <cmath>
 
@@ -41,10 +42,9 @@ QImage WaveformGenerator::calculateWaveform(const QSize &waveformSize, const QIm
 
     const uint ww = uint(waveformSize.width());
     const uint wh = uint(waveformSize.height());
-    const uint iw = uint(image.width());
-    const auto totalPixels = image.width() * image.height();
-
-    std::vector<std::vector<uint>> waveValues(size_t(waveformSize.width()), std::vector<uint>(size_t(waveformSize.height()), 0));
+    const QImage source = ParallelScan::rgbImage(image);
+    const uint iw = uint(source.width());
+    const auto totalPixels = source.width() * source.height();
 
     // Number of input pixels that will fall on one scope pixel.
     // Must be a float because the acceleration factor can be high, leading to <1 expected px per px.
@@ -57,53 +57,68 @@ QImage WaveformGenerator::calculateWaveform(const QSize &waveformSize, const QIm
     const float hPrediv = (wh - 1) / 255.f;
     const float wPrediv = (ww - 1) / float(iw - 1);
 
-    for (int i = 0; i < totalPixels; i += accelFactor) {
-        const int x = i % image.width();
-        const QRgb pixel = image.pixel(x, i / image.width());
-
-        float dY, dx, dy;
-
-        if (rec == ITURec::Rec_601) {
-            // CIE 601 Luminance
-            dY = REC_601_R * qRed(pixel) + REC_601_G * qGreen(pixel) + REC_601_B * qBlue(pixel);
-        } else {
-            // CIE 709 Luminance
-            dY = REC_709_R * qRed(pixel) + REC_709_G * qGreen(pixel) + REC_709_B * qBlue(pixel);
+    // Scope column of each image column
+    std::vector<uint> columns(iw);
+    for (uint x = 0; x < iw; ++x) {
+        columns[x] = uint(x * wPrediv) * wh;
+    }
+    // Luminance weights in 16 bit fixed point, already scaled to the scope height
+    const bool rec601 = rec == ITURec::Rec_601;
+    const uint kr = uint(65536 * hPrediv * (rec601 ? REC_601_R : REC_709_R));
+    const uint kg = uint(65536 * hPrediv * (rec601 ? REC_601_G : REC_709_G));
+    const uint kb = uint(65536 * hPrediv * (rec601 ? REC_601_B : REC_709_B));
+    // Compensates the truncation of the weights, so that a gray pixel falls on its own value
+    const uint lumaBias = 1 << 10;
+
+    // Values are stored column by column. Each thread handles a band of scope columns,
+    // so they all write to the same buffer without overlapping
+    std::vector<uint> waveValues(size_t(ww * wh), 0);
+    const uint bandCount = qBound(1u, uint(QThread::idealThreadCount()), qMax(1u, ww / 16));
+    std::vector<int> bounds = {0};
+    for (uint x = 0, band = 1; x < iw && band < bandCount; ++x) {
+        // First image column falling on the first scope column of the band
+        if (columns[x] >= ww * band / bandCount * wh) {
+            bounds.push_back(int(x));
+            band++;
         }
-        // dY is on [0,255] now.
-
-        dy = dY * hPrediv;
-        dx = x * wPrediv;
-        waveValues[size_t(dx)][size_t(dy)]++;
     }
-
-    switch (paintMode) {
-    case PaintMode_Green:
-        for (int i = 0; i < waveformSize.width(); ++i) {
-            for (int j = 0; j < waveformSize.height(); ++j) {
+    bounds.push_back(int(iw));
+    uint *data = waveValues.data();
+    ParallelScan::scanColumns(source, bounds, [&](const QRgb *line, int y, int first, int last) {
+        // Keep the same subsampling pattern as when counting pixels over the whole frame
+        uint x = (accelFactor - uint(y) * iw % accelFactor) % accelFactor;
+        if (x < uint(first)) {
+            x += (uint(first) - x + accelFactor - 1) / accelFactor * accelFactor;
+        }
+        for (; x < uint(last); x += accelFactor) {
+            const QRgb pixel = line[x];
+            data[columns[x] + qMin(wh - 1, (kr * uint(qRed(pixel)) + kg * uint(qGreen(pixel)) + kb * uint(qBlue(pixel)) + lumaBias) >> 16)]++;
+        }
+    });
+
+    // Write the scope line by line, the scope bottom being the darkest value
+    for (uint j = 0; j < wh; ++j) {
+        auto *line = reinterpret_cast<QRgb *>(wave.scanLine(int(wh - j - 1)));
+        const uint *values = waveValues.data() + j;
+        switch (paintMode) {
+        case PaintMode_Green:
+            for (uint i = 0; i < ww; ++i) {
                 // Logarithmic scale. Needs fine tuning by hand, but looks great.
-                wave.setPixel(i, waveformSize.height() - j - 1,
-                              qRgba(CHOP255(52 * logf(0.1f * gain * float(waveValues[size_t(i)][size_t(j)]))),
-                                    CHOP255(52 * logf(gain * float(waveValues[size_t(i)][size_t(j)]))),
-                                    CHOP255(52 * logf(.25f * gain * float(waveValues[size_t(i)][size_t(j)]))),
-                                    CHOP255(64 * logf(gain * float(waveValues[size_t(i)][size_t(j)])))));
+                const float value = gain * float(values[i * wh]);
+                line[i] = qRgba(CHOP255(52 * logf(0.1f * value)), CHOP255(52 * logf(value)), CHOP255(52 * logf(.25f * value)), CHOP255(64 * logf(value)));
             }
-        }
-        break;
-    case PaintMode_Yellow:
-        for (int i = 0; i < waveformSize.width(); ++i) {
-            for (int j = 0; j < waveformSize.height(); ++j) {
-                wave.setPixel(i, waveformSize.height() - j - 1, qRgba(255, 242, 0, CHOP255(gain * float(waveValues[size_t(i)][size_t(j)]))));
+            break;
+        case PaintMode_Yellow:
+            for (uint i = 0; i < ww; ++i) {
+                line[i] = qRgba(255, 242, 0, CHOP255(gain * float(values[i * wh])));
             }
-        }
-        break;
-    default:
-        for (int i = 0; i < waveformSize.width(); ++i) {
-            for (int j = 0; j < waveformSize.height(); ++j) {
-                wave.setPixel(i, waveformSize.height() - j - 1, qRgba(255, 255, 255, CHOP255(2.f * gain * float(waveValues[size_t(i)][size_t(j)]))));
+            break;
+        default:
+            for (uint i = 0; i < ww; ++i) {
+                line[i] = qRgba(255, 255, 255, CHOP255(2.f * gain * float(values[i * wh])));
             }
+            break;
         }
-        break;
     }
 
     if (drawAxis) {
@@ -24,11 +24,14 @@
 #include "transitions/transitionsrepository.hpp"
 #include <QDebug>
 #include <QFileInfo>
+#include <QThread>
 #include <mlt++/MltField.h>
 #include <mlt++/MltProfile.h>
 #include <mlt++/MltTractor.h>
 #include <mlt++/MltTransition.h>
 
+#include <algorithm>
+
 #ifdef CRASH_AUTO_TEST
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-parameter"
@@ -48,6 +51,13 @@ RTTR_REGISTRATION
 TimelineItemModel::TimelineItemModel(const QUuid &uuid, std::weak_ptr<DocUndoStack> undo_stack)
     : TimelineModel(uuid, std::move(undo_stack))
 {
+    // Keep the role snapshots in sync with what the views are told. Changes emitted from another thread are queued to the model's thread.
+    connect(this, &QAbstractItemModel::dataChanged, this, &TimelineItemModel::invalidateRoleSnapshots);
+    auto clearSnapshots = [this]() { m_roleSnapshots.clear(); };
+    connect(this, &QAbstractItemModel::rowsInserted, this, clearSnapshots);
+    connect(this, &QAbstractItemModel::rowsRemoved, this, clearSnapshots);
+    connect(this, &QAbstractItemModel::rowsMoved, this, clearSnapshots);
+    connect(this, &QAbstractItemModel::modelReset, this, clearSnapshots);
 }
 
 void TimelineItemModel::finishConstruct(const std::shared_ptr<TimelineItemModel> &ptr)
@@ -302,8 +312,94 @@ QHash<int, QByteArray> TimelineItemModel::roleNames() const
     return roles;
 }
 
+bool TimelineItemModel::isSnapshotRole(int role)
+{
+    switch (role) {
+    case NameRole:
+    case Qt::DisplayRole:
+    case ResourceRole:
+    case ServiceRole:
+    case BinIdRole:
+    case TagRole:
+    case ClipThumbRole:
+    case EffectNamesRole:
+        return true;
+    default:
+        return false;
+    }
+}
+
+std::shared_ptr<const TimelineItemModel::RoleSnapshot> TimelineItemModel::buildRoleSnapshot(int itemId) const
+{
+    READ_LOCK();
+    if (!m_tractor) {
+        return nullptr;
+    }
+    auto snapshot = std::make_shared<RoleSnapshot>();
+    if (isClip(itemId)) {
+        std::shared_ptr<ClipModel> clip = m_allClips.at(itemId);
+        snapshot->name = clip->clipName();
+        snapshot->service = clip->getProperty("mlt_service");
+        QString resource = clip->getProperty("resource");
+        snapshot->resource = resource == QLatin1String("<producer>") ? snapshot->service : resource;
+        snapshot->binId = clip->binId();
+        snapshot->tag = clip->clipTag();
+        snapshot->thumb = clip->clipThumbPath();
+        snapshot->effectNames = clip->effectNames();
+    } else if (isComposition(itemId)) {
+        std::shared_ptr<CompositionModel> compo = m_allCompositions.at(itemId);
+        snapshot->name = snapshot->resource = snapshot->service = compo->displayName();
+        snapshot->binId = 5;
+    } else {
+        return nullptr;
+    }
+    return snapshot;
+}
+
+void TimelineItemModel::invalidateRoleSnapshots(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles)
+{
+    if (m_roleSnapshots.empty() || (!roles.isEmpty() && std::none_of(roles.cbegin(), roles.cend(), isSnapshotRole))) {
+        return;
+    }
+    if (topLeft == bottomRight && topLeft.isValid()) {
+        m_roleSnapshots.erase(int(topLeft.internalId()));
+    } else {
+        m_roleSnapshots.clear();
+    }
+}
+
 QVariant TimelineItemModel::data(const QModelIndex &index, int role) const
 {
+    if (index.isValid() && isSnapshotRole(role) && QThread::currentThread() == thread()) {
+        // Read the costly roles from the item's snapshot, without locking the model
+        const int id = int(index.internalId());
+        auto snapshot = m_roleSnapshots.find(id);
+        if (snapshot == m_roleSnapshots.end()) {
+            std::shared_ptr<const RoleSnapshot> built = buildRoleSnapshot(id);
+            if (built) {
+                snapshot = m_roleSnapshots.emplace(id, std::move(built)).first;
+            }
+        }
+        if (snapshot != m_roleSnapshots.end()) {
+            const RoleSnapshot &values = *snapshot->second;
+            switch (role) {
+            case ResourceRole:
+                return values.resource;
+            case ServiceRole:
+                return values.service;
+            case BinIdRole:
+                return values.binId;
+            case TagRole:
+                return values.tag;
+            case ClipThumbRole:
+                return values.thumb;
+            case EffectNamesRole:
+                return values.effectNames;
+            default:
+                return values.name;
+            }
+        }
+    }
     READ_LOCK();
     if (!m_tractor || !index.isValid()) {
         // qDebug() << "DATA abort. Index validity="<<index.isValid();
@@ -123,6 +123,29 @@ protected:
     /** @brief This is an helper function that finishes a construction of a freshly created TimelineItemModel */
     static void finishConstruct(const std::shared_ptr<TimelineItemModel> &ptr);
 
+    /** @brief Values of the roles that are costly to compute for a clip or composition.
+        A snapshot is never modified, it is replaced when the item's data changes */
+    struct RoleSnapshot
+    {
+        QVariant name;
+        QVariant resource;
+        QVariant service;
+        QVariant binId;
+        QVariant tag;
+        QVariant thumb;
+        QVariant effectNames;
+    };
+    /** @brief Returns true if the role is read from the item's snapshot */
+    static bool isSnapshotRole(int role);
+    /** @brief Computes the snapshot of an item, returns nullptr if the item is not a clip or composition */
+    std::shared_ptr<const RoleSnapshot> buildRoleSnapshot(int itemId) const;
+    /** @brief Drop the snapshots of the changed items */
+    void invalidateRoleSnapshots(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles);
+
+private:
+    /** @brief Role snapshots by item id. Only accessed from the model's thread, so reading them does not need to lock the model */
+    mutable std::unordered_map<int, std::shared_ptr<const RoleSnapshot>> m_roleSnapshots;
+
 Q_SIGNALS:
     /** @brief Triggered when a video track visibility changed */
     void trackVisibilityChanged();
@@ -105,6 +105,8 @@ TrackModel::~TrackModel()
         field->unblock();
         m_sameCompositions.clear();
         m_allClips.clear();
+        m_clipPos.clear();
+        m_clipRows.clear();
         m_allCompositions.clear();
         m_track->remove_track(1);
         m_track->remove_track(0);
@@ -191,8 +193,12 @@ Fun TrackModel::requestClipInsertion_lambda(int clipId, int position, bool updat
         if (auto ptr = m_parent.lock()) {
             std::shared_ptr<ClipModel> clip = ptr->getClipPtr(clipId);
             m_allClips[clip->getId()] = clip; // store clip
+            {
+                QMutexLocker lk(&m_clipRowsMutex);
+                m_clipRows.clear();
+            }
             // update clip position and track
-            clip->setPosition(position);
+            setClipPosition(clipId, position);
             if (finalMove) {
                 clip->setSubPlaylistIndex(subPlaylist, m_id);
             }
@@ -436,6 +442,7 @@ Fun TrackModel::requestClipDeletion_lambda(int clipId, bool updateView, bool fin
             m_playlists[target_track].consolidate_blanks();
             m_allClips[clipId]->setCurrentTrackId(-1);
             // m_allClips[clipId]->setSubPlaylistIndex(-1);
+            unindexClip(clipId, m_allClips[clipId]->getPosition());
             m_allClips.erase(clipId);
             delete prod;
             field->unblock();
@@ -706,7 +713,7 @@ Fun TrackModel::requestClipResize_lambda(int clipId, int in, int out, bool right
             // The second is parameter is delta - 1 because this function expects an out time, which is basically size - 1
             m_playlists[target_track].insert_blank(blank_index, delta - 1);
             if (!right) {
-                m_allClips[clipId]->setPosition(clip_position + delta);
+                setClipPosition(clipId, clip_position + delta);
                 // Because we inserted blank before, the index of our clip has increased
                 target_clip_mutable++;
             }
@@ -805,7 +812,7 @@ Fun TrackModel::requestClipResize_lambda(int clipId, int in, int out, bool right
                     // m_track->unblock();
                 }
                 if (!right && err == 0) {
-                    m_allClips[clipId]->setPosition(m_playlists[target_track].clip_start(target_clip_mutable));
+                    setClipPosition(clipId, m_playlists[target_track].clip_start(target_clip_mutable));
                 }
                 if (err == 0) {
                     update_snaps(m_allClips[clipId]->getPosition(), m_allClips[clipId]->getPosition() + out - in + 1);
@@ -842,17 +849,24 @@ int TrackModel::getClipByStartPosition(int position) const
 int TrackModel::getClipByPosition(int position, int playlist)
 {
     READ_LOCK();
-    QSharedPointer<Mlt::Producer> prod(nullptr);
-    if ((playlist == 0 || playlist == -1) && m_playlists[0].count() > 0) {
-        prod = QSharedPointer<Mlt::Producer>(m_playlists[0].get_clip_at(position));
+    // Find the clips covering position in each playlist
+    int found[2] = {-1, -1};
+    for (auto it = firstClipReaching(position); it != m_clipPos.end() && it->first <= position; ++it) {
+        const auto &clip = m_allClips.at(it->second);
+        if (it->first + clip->getPlaytime() > position) {
+            found[clip->getSubPlaylistIndex() == 1 ? 1 : 0] = it->second;
+        }
     }
-    if (playlist != 0 && (!prod || prod->is_blank()) && m_playlists[1].count() > 0) {
-        prod = QSharedPointer<Mlt::Producer>(m_playlists[1].get_clip_at(position));
+    int cid = -1;
+    if (playlist == 0 || playlist == -1) {
+        cid = found[0];
     }
-    if (!prod || prod->is_blank()) {
+    if (playlist != 0 && cid == -1) {
+        cid = found[1];
+    }
+    if (cid == -1) {
         return -1;
     }
-    int cid = prod->get_int("_kdenlive_cid");
     if (playlist == -1) {
         if (hasStartMix(cid)) {
             if (position < m_allClips[cid]->getPosition() + m_allClips[cid]->getMixCutPosition()) {
@@ -886,15 +900,17 @@ QSharedPointer<Mlt::Producer> TrackModel::getClipProducer(int clipId)
 int TrackModel::getCompositionByPosition(int position)
 {
     READ_LOCK();
-    for (const auto &comp : m_compoPos) {
-        if (comp.first == position) {
-            return comp.second;
-        } else if (comp.first < position) {
-            if (comp.first + m_allCompositions[comp.second]->getPlaytime() >= position) {
-                return comp.second;
-            }
+    // Compositions don't overlap, so only the previous one can cover position
+    auto it = m_compoPos.lower_bound(position);
+    if (it != m_compoPos.begin()) {
+        auto prev = std::prev(it);
+        if (prev->first + m_allCompositions[prev->second]->getPlaytime() >= position) {
+            return prev->second;
         }
     }
+    if (it != m_compoPos.end() && it->first == position) {
+        return it->second;
+    }
     return -1;
 }
 
@@ -913,14 +929,13 @@ std::unordered_set<int> TrackModel::getClipsInRange(int position, int end)
 {
     READ_LOCK();
     std::unordered_set<int> ids;
-    for (const auto &clp : m_allClips) {
-        int pos = clp.second->getPosition();
-        int length = clp.second->getPlaytime();
+    for (auto it = firstClipReaching(position); it != m_clipPos.end(); ++it) {
+        int pos = it->first;
         if (end > -1 && pos >= end) {
-            continue;
+            break;
         }
-        if (pos >= position || pos + length - 1 >= position) {
-            ids.insert(clp.first);
+        if (pos >= position || pos + m_allClips.at(it->second)->getPlaytime() - 1 >= position) {
+            ids.insert(it->second);
         }
     }
     return ids;
@@ -930,7 +945,63 @@ int TrackModel::getRowfromClip(int clipId) const
 {
     READ_LOCK();
     Q_ASSERT(m_allClips.count(clipId) > 0);
-    return int(std::distance(m_allClips.begin(), m_allClips.find(clipId)));
+    QMutexLocker lk(&m_clipRowsMutex);
+    if (m_clipRows.empty()) {
+        int row = 0;
+        for (const auto &clip : m_allClips) {
+            m_clipRows[clip.first] = row++;
+        }
+    }
+    auto it = m_clipRows.find(clipId);
+    if (it == m_clipRows.end()) {
+        return int(m_allClips.size());
+    }
+    return it->second;
+}
+
+void TrackModel::setClipPosition(int clipId, int position)
+{
+    const auto &clip = m_allClips.at(clipId);
+    unindexClip(clipId, clip->getPosition());
+    clip->setPosition(position);
+    m_clipPos.emplace(position, clipId);
+}
+
+void TrackModel::unindexClip(int clipId, int position)
+{
+    auto range = m_clipPos.equal_range(position);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == clipId) {
+            m_clipPos.erase(it);
+            break;
+        }
+    }
+    QMutexLocker lk(&m_clipRowsMutex);
+    m_clipRows.clear();
+}
+
+std::multimap<int, int>::const_iterator TrackModel::firstClipReaching(int position) const
+{
+    // Walk back from the clips starting at position. Clips of a same playlist don't overlap, so once we found a clip
+    // ending before position in a playlist, the previous clips of this playlist cannot reach it.
+    // A clip only overlaps its neighbours in a mix, so it cannot span over two following clips: once two successive clips
+    // end before position, the previous ones cannot reach it either, even if the other playlist has no clip
+    auto it = m_clipPos.lower_bound(position);
+    auto first = it;
+    bool done[2] = {false, false};
+    int misses = 0;
+    while (it != m_clipPos.begin() && !(done[0] && done[1]) && misses < 2) {
+        --it;
+        const auto &clip = m_allClips.at(it->second);
+        if (it->first + clip->getPlaytime() - 1 >= position) {
+            first = it;
+            misses = 0;
+        } else {
+            done[clip->getSubPlaylistIndex() == 1 ? 1 : 0] = true;
+            misses++;
+        }
+    }
+    return first;
 }
 
 std::unordered_set<int> TrackModel::getCompositionsInRange(int position, int end)
@@ -938,16 +1009,18 @@ std::unordered_set<int> TrackModel::getCompositionsInRange(int position, int end
     READ_LOCK();
     // TODO: this function doesn't take into accounts the fact that there are two tracks
     std::unordered_set<int> ids;
-    for (const auto &compo : m_allCompositions) {
-        int pos = compo.second->getPosition();
-        int length = compo.second->getPlaytime();
-        if (end > -1 && pos >= end) {
-            continue;
+    auto it = m_compoPos.lower_bound(position);
+    if (it != m_compoPos.begin()) {
+        auto prev = std::prev(it);
+        if (prev->first + m_allCompositions[prev->second]->getPlaytime() - 1 >= position) {
+            it = prev;
         }
-        if (pos >= position || pos + length - 1 >= position) {
-
-            ids.insert(compo.first);
+    }
+    for (; it != m_compoPos.end(); ++it) {
+        if (end > -1 && it->first >= end) {
+            break;
         }
+        ids.insert(it->second);
     }
     return ids;
 }
@@ -1102,6 +1175,14 @@ bool TrackModel::checkConsistency()
         return false;
     }
 
+    // Check the clips position index
+    std::vector<std::pair<int, int>> indexedClips(m_clipPos.begin(), m_clipPos.end());
+    std::sort(indexedClips.begin(), indexedClips.end());
+    if (indexedClips != clips) {
+        qDebug() << "Error: the clips position index doesn't match the clips";
+        return false;
+    }
+
     // We now check compositions positions
     if (m_allCompositions.size() != m_compoPos.size()) {
         qDebug() << "Error: the number of compositions position doesn't match number of compositions";
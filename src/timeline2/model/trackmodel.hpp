@@ -7,8 +7,10 @@
 
 #include "definitions.h"
 #include "undohelper.hpp"
+#include <QMutex>
 #include <QReadWriteLock>
 #include <QSharedPointer>
+#include <map>
 #include <memory>
 #include <mlt++/MltPlaylist.h>
 #include <mlt++/MltProfile.h>
@@ -369,8 +371,22 @@ private:
      */
     std::map<int, int> m_compoPos;
 
+    /** We store the start positions of the clips, ordered, so that position and range queries don't need to iterate over all clips.
+     *  Must be kept in sync with m_allClips, use setClipPosition() to move a clip.
+     */
+    std::multimap<int, int> m_clipPos;
+    /** @brief Cache of the clip rows (the index of the clip in m_allClips), cleared when a clip is inserted or removed */
+    mutable std::unordered_map<int, int> m_clipRows;
+    mutable QMutex m_clipRowsMutex;
+
     /// This is a lock that ensures safety in case of concurrent access
     mutable QReadWriteLock m_lock;
+    /** @brief Update the position of a clip and its entry in the position index */
+    void setClipPosition(int clipId, int position);
+    /** @brief Remove a clip from the position index and the rows cache */
+    void unindexClip(int clipId, int position);
+    /** @brief Returns the first entry of m_clipPos for which this clip or a following one can end at or after @param position */
+    std::multimap<int, int>::const_iterator firstClipReaching(int position) const;
     void reverseCompositionXml(const QString &composition, QDomElement xml);
     void updateCompositionDirection(Mlt::Transition &transition, bool reverse);
 
@@ -16,6 +16,7 @@
 #include "profiles/profilemodel.hpp"
 #include "timeline2/view/timelinecontroller.h"
 #include "timeline2/view/timelinewidget.h"
+#include "utils/cachemanager.hpp"
 #include "xml/xml.hpp"
 
 #include <KLocalizedString>
@@ -36,6 +37,9 @@ PreviewManager::PreviewManager(Mlt::Tractor *tractor, QUuid uuid, QObject *paren
     , m_warnOnCrash(true)
     , m_previewTrackIndex(-1)
     , m_initialized(false)
+    , m_pendingSyncs(0)
+    , m_sceneVersion(0)
+    , m_inputClosed(false)
 {
     m_previewGatherTimer.setSingleShot(true);
     m_previewGatherTimer.setInterval(200);
@@ -170,7 +174,10 @@ void PreviewManager::loadChunks(QVariantList previewChunks, QVariantList dirtyCh
         }
         int position = playlist.clip_start(i);
         if (previewChunks.contains(QString::number(position))) {
-            if (existingChuncks.contains(QString("%1.%2").arg(position).arg(m_extension))) {
+            const QString chunkName = QString("%1.%2").arg(position).arg(m_extension);
+            bool cached = existingChuncks.contains(chunkName);
+            CacheManager::get()->recordAccess(CachePreview, m_cacheDir.absoluteFilePath(chunkName), cached);
+            if (cached) {
                 clip.reset(playlist.get_clip(i));
                 m_renderedChunks << position;
                 m_previewTrack->insert_at(position, clip.get(), 1);
@@ -433,7 +440,9 @@ void PreviewManager::clearPreviewRange(bool resetZones)
     bool hasPreview = m_previewTrack != nullptr;
     QMutexLocker lock(&m_dirtyMutex);
     for (const auto &ix : qAsConst(m_renderedChunks)) {
-        m_cacheDir.remove(QStringLiteral("%1.%2").arg(ix.toInt()).arg(m_extension));
+        const QString chunkName = QStringLiteral("%1.%2").arg(ix.toInt()).arg(m_extension);
+        m_cacheDir.remove(chunkName);
+        CacheManager::get()->forget(m_cacheDir.absoluteFilePath(chunkName));
         if (!m_dirtyChunks.contains(ix)) {
             m_dirtyChunks << ix;
         }
@@ -495,7 +504,9 @@ void PreviewManager::addPreviewRange(const QPoint zone, bool add)
         m_tractor->lock();
         bool hasPreview = m_previewTrack != nullptr;
         for (int ix : qAsConst(toRemove)) {
-            m_cacheDir.remove(QStringLiteral("%1.%2").arg(ix).arg(m_extension));
+            const QString chunkName = QStringLiteral("%1.%2").arg(ix).arg(m_extension);
+            m_cacheDir.remove(chunkName);
+            CacheManager::get()->forget(m_cacheDir.absoluteFilePath(chunkName));
             if (!hasPreview) {
                 continue;
             }
@@ -543,12 +554,18 @@ void PreviewManager::startPreviewRender()
 {
     QMutexLocker lock(&m_previewMutex);
     if (!m_dirtyChunks.isEmpty()) {
-        // Abort any rendering
-        abortRendering();
-        m_waitingThumbs.clear();
-        // clear log
-        m_errorLog.clear();
-        const QString sceneList = m_cacheDir.absoluteFilePath(QStringLiteral("preview.mlt"));
+        // A running render process is sent the updated timeline instead of being restarted
+        bool updateRender = m_previewProcess.state() == QProcess::Running && !m_inputClosed;
+        if (!updateRender) {
+            // Abort any rendering
+            abortRendering();
+            m_waitingThumbs.clear();
+            // clear log
+            m_errorLog.clear();
+            m_sceneVersion = 0;
+        }
+        const QString sceneList =
+            m_cacheDir.absoluteFilePath(updateRender ? QStringLiteral("preview-%1.mlt").arg(++m_sceneVersion) : QStringLiteral("preview.mlt"));
         if (!KdenliveSettings::proxypreview() && pCore->currentDoc()->useProxy()) {
             const QString playlist =
                 pCore->projectItemModel()->sceneList(m_cacheDir.absolutePath(), QString(), pCore->currentDoc()->getTimeline(m_uuid)->tractor(), -1);
@@ -562,7 +579,11 @@ void PreviewManager::startPreviewRender()
             pCore->currentDoc()->getTimeline(m_uuid)->sceneList(m_cacheDir.absolutePath(), sceneList);
         }
         m_previewTimer.stop();
-        doPreviewRender(sceneList);
+        if (updateRender) {
+            updatePreviewRender(sceneList);
+        } else {
+            doPreviewRender(sceneList);
+        }
     }
 }
 
@@ -576,10 +597,24 @@ void PreviewManager::receivedStderr()
                 Q_EMIT workingPreviewChanged();
             }
         } else if (result.startsWith(QLatin1String("DONE:"))) {
-            int chunk = result.section(QLatin1String("DONE:"), 1).simplified().toInt();
+            int chunk = result.section(QLatin1Char(':'), 1, 1).toInt();
+            int version = result.section(QLatin1Char(':'), 2, 2).simplified().toInt();
+            if (m_staleChunks.contains(chunk) || version < m_invalidatedChunks.value(chunk, 0)) {
+                // Rendered from an outdated timeline, it will be rendered again
+                continue;
+            }
+            m_invalidatedChunks.remove(chunk);
             m_processedChunks++;
             QString fileName = QStringLiteral("%1.%2").arg(chunk).arg(m_extension);
             Q_EMIT previewRender(chunk, m_cacheDir.absoluteFilePath(fileName), 1000 * m_processedChunks / m_chunksToRender);
+        } else if (result == QLatin1String("SYNCED")) {
+            m_pendingSyncs = qMax(0, m_pendingSyncs - 1);
+        } else if (result == QLatin1String("IDLE")) {
+            // All chunks are rendered. If the renderer received all our updates, let it exit
+            if (m_pendingSyncs == 0 && !m_inputClosed) {
+                m_inputClosed = true;
+                m_previewProcess.closeWriteChannel();
+            }
         } else {
             m_errorLog.append(result);
         }
@@ -598,6 +633,10 @@ void PreviewManager::doPreviewRender(const QString &scene)
     const QStringList dirtyChunks = getCompressedList(m_dirtyChunks);
     m_chunksToRender = m_dirtyChunks.count();
     m_processedChunks = 0;
+    m_staleChunks.clear();
+    m_invalidatedChunks.clear();
+    m_pendingSyncs = 0;
+    m_inputClosed = false;
     int chunkSize = KdenliveSettings::timelinechunks();
     QStringList args{QStringLiteral("preview-chunks"),
                      scene,
@@ -606,7 +645,12 @@ void PreviewManager::doPreviewRender(const QString &scene)
                      QString::number(chunkSize - 1),
                      pCore->getCurrentProfilePath(),
                      m_extension,
-                     m_consumerParams.join(QLatin1Char(' '))};
+                     m_consumerParams.join(QLatin1Char(' ')),
+                     QStringLiteral("--workers"),
+                     QString::number(KdenliveSettings::previewworkers()),
+                     QStringLiteral("--playhead"),
+                     QString::number(pCore->getMonitorPosition()),
+                     QStringLiteral("--commands")};
     pCore->currentDoc()->previewProgress(0);
     m_previewProcess.start(KdenliveSettings::kdenliverendererpath(), args);
     if (m_previewProcess.waitForStarted()) {
@@ -614,17 +658,41 @@ void PreviewManager::doPreviewRender(const QString &scene)
     }
 }
 
+void PreviewManager::updatePreviewRender(const QString &scene)
+{
+    QMutexLocker lock(&m_dirtyMutex);
+    std::sort(m_dirtyChunks.begin(), m_dirtyChunks.end(), chunkSort);
+    m_chunksToRender = m_processedChunks + m_dirtyChunks.count();
+    QStringList commands{QStringLiteral("SCENE:%1").arg(scene), QStringLiteral("RENDER:%1").arg(getCompressedList(m_dirtyChunks).join(QLatin1Char(',')))};
+    if (!m_staleChunks.isEmpty()) {
+        std::sort(m_staleChunks.begin(), m_staleChunks.end(), chunkSort);
+        commands << QStringLiteral("INVALIDATE:%1").arg(getCompressedList(m_staleChunks).join(QLatin1Char(',')));
+        // Results for these chunks are ignored until they are rendered from this scene
+        for (const QVariant &chunk : qAsConst(m_staleChunks)) {
+            m_invalidatedChunks.insert(chunk.toInt(), m_sceneVersion);
+        }
+        m_staleChunks.clear();
+    }
+    commands << QStringLiteral("PLAYHEAD:%1").arg(pCore->getMonitorPosition()) << QStringLiteral("SYNC");
+    m_pendingSyncs++;
+    m_previewProcess.write(commands.join(QLatin1Char('\n')).append(QLatin1Char('\n')).toUtf8());
+}
+
 void PreviewManager::processEnded(int exitCode, QProcess::ExitStatus status)
 {
-    const QString sceneList = m_cacheDir.absoluteFilePath(QStringLiteral("preview.mlt"));
-    QFile::remove(sceneList);
+    const QStringList sceneLists = m_cacheDir.entryList({QStringLiteral("preview.mlt"), QStringLiteral("preview-*.mlt")}, QDir::Files);
+    for (const QString &sceneList : sceneLists) {
+        m_cacheDir.remove(sceneList);
+    }
+    m_staleChunks.clear();
+    m_invalidatedChunks.clear();
+    m_pendingSyncs = 0;
     if (pCore->window() && (status == QProcess::QProcess::CrashExit || exitCode != 0)) {
         Q_EMIT previewRender(0, m_errorLog, -1);
-        if (workingPreview >= 0) {
-            const QString fileName = QStringLiteral("%1.%2").arg(workingPreview).arg(m_extension);
-            if (m_cacheDir.exists(fileName)) {
-                m_cacheDir.remove(fileName);
-            }
+        // Chunks are rendered in temporary files, remove the ones left by the interrupted workers
+        const QStringList partFiles = m_cacheDir.entryList({QStringLiteral("*-part.%1").arg(m_extension)}, QDir::Files);
+        for (const QString &fileName : partFiles) {
+            m_cacheDir.remove(fileName);
         }
     } else {
         // Normal exit and exit code 0: everything okay
@@ -641,7 +709,10 @@ void PreviewManager::slotProcessDirtyChunks()
         return;
     }
     invalidatePreviews();
-    if (KdenliveSettings::autopreview()) {
+    if (m_previewProcess.state() == QProcess::Running) {
+        // Send the changes to the renderer right away
+        startPreviewRender();
+    } else if (KdenliveSettings::autopreview()) {
         m_previewTimer.start();
     }
 }
@@ -694,10 +765,15 @@ void PreviewManager::invalidatePreview(int startFrame, int endFrame)
             wasInDirtyZone = true;
         }
     }
-    if (alreadyRendered) {
-        if (previewWasRunning) {
-            abortRendering();
+    if (previewWasRunning && (alreadyRendered || wasInDirtyZone)) {
+        // Only the affected chunks will be rendered again, the render process is updated once the changes are gathered
+        for (int i = start; i <= end; i += chunkSize) {
+            if ((m_renderedChunks.contains(i) || m_dirtyChunks.contains(i)) && !m_staleChunks.contains(i)) {
+                m_staleChunks << i;
+            }
         }
+    }
+    if (alreadyRendered) {
         m_tractor->lock();
         bool chunksChanged = false;
         for (int i = start; i <= end; i += chunkSize) {
@@ -723,12 +799,7 @@ void PreviewManager::invalidatePreview(int startFrame, int endFrame)
             Q_EMIT renderedChunksChanged();
             Q_EMIT dirtyChunksChanged();
         }
-    } else if (wasInDirtyZone) {
-        // Abort rendering, playlist needs to be recreated
-        if (previewWasRunning) {
-            abortRendering();
-        }
-    } else {
+    } else if (!wasInDirtyZone) {
         // Invalidated zone outside our rendered zones
         return;
     }
@@ -787,6 +858,7 @@ void PreviewManager::gotPreviewRender(int frame, const QString &file, int progre
             m_dirtyChunks.removeAll(QVariant(frame));
             m_dirtyMutex.unlock();
             m_renderedChunks << frame;
+            CacheManager::get()->recordStore(CachePreview, file);
             Q_EMIT renderedChunksChanged();
             prod.set("mlt_service", "avformat-novalidate");
             m_tractor->lock();
@@ -814,6 +886,7 @@ void PreviewManager::corruptedChunk(int frame, const QString &fileName)
     }
     Q_EMIT previewRender(0, m_errorLog, -1);
     m_cacheDir.remove(fileName);
+    CacheManager::get()->forget(m_cacheDir.absoluteFilePath(fileName));
     if (!m_dirtyChunks.contains(frame)) {
         QMutexLocker lock(&m_dirtyMutex);
         m_dirtyChunks << frame;
@@ -10,6 +10,7 @@
 
 #include <QDir>
 #include <QFuture>
+#include <QMap>
 #include <QMutex>
 #include <QProcess>
 #include <QTimer>
@@ -109,6 +110,16 @@ private:
     int m_processedChunks;
     /** @brief: The render process output, useful in case of failure */
     QString m_errorLog;
+    /** @brief: Chunks invalidated while rendering, not yet sent to the render process */
+    QVariantList m_staleChunks;
+    /** @brief: Invalidated chunks sent to the render process, with the scene version they must be rendered from */
+    QMap<int, int> m_invalidatedChunks;
+    /** @brief: Number of updates sent to the render process and not yet confirmed */
+    int m_pendingSyncs;
+    /** @brief: Used to give a unique name to the scene files sent to a running render process */
+    int m_sceneVersion;
+    /** @brief: True once the render process input is closed, it then exits when its chunks are rendered and cannot be updated */
+    bool m_inputClosed;
     /** @brief: After an undo/redo, if we have preview history, use it. */
     void reloadChunks(const QVariantList &chunks);
     /** @brief: A chunk failed to render, abort. */
@@ -126,6 +137,8 @@ private Q_SLOTS:
     void doCleanupOldPreviews();
     /** @brief: Start the real rendering process. */
     void doPreviewRender(const QString &scene); // std::shared_ptr<Mlt::Producer> sourceProd);
+    /** @brief: Send the updated timeline @param scene and dirty chunks to the running render process */
+    void updatePreviewRender(const QString &scene);
     /** @brief: If user does an undo, then makes a new timeline operation, delete undo history of more recent stack . */
     void slotRemoveInvalidUndo(int ix);
     /** @brief: When the timer collecting invalid zones is done, process. */
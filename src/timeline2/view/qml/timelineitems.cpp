@@ -6,6 +6,7 @@
 */
 
 #include "assets/keyframes/model/keyframemodel.hpp"
+#include "audio/audioLevelsPyramid.h"
 #include "bin/projectitemmodel.h"
 #include "capture/mediacapture.h"
 #include "core.h"
@@ -163,6 +164,7 @@ public:
                 } else {
                     // Clip changed, reset levels
                     m_audioLevels.clear();
+                    m_audioPyramid.reset();
                 }
             }
         });
@@ -185,6 +187,10 @@ public:
             }
             m_audioMax = KdenliveSettings::normalizechannels() ? pCore->projectItemModel()->getAudioMaxLevel(m_binId, m_stream) : 0;
         }
+        if (m_audioPyramid == nullptr && m_stream >= 0) {
+            // Only available once the levels are complete
+            m_audioPyramid = pCore->projectItemModel()->getAudioPyramidByBinID(m_binId, m_stream);
+        }
 
         if (m_outPoint == m_inPoint) {
             return;
@@ -222,6 +228,16 @@ public:
             m_inPoint = qMin(m_inPoint, maxLength - m_channels);
         }
         int startPos = int(m_inPoint / indicesPrPixel);
+        // Number of frames covered by one drawing step, when zoomed out use the peak of all these frames
+        int span = qMax(1, qRound(increment * indicesPrPixel / m_channels));
+        bool usePyramid = span > 1 && m_audioPyramid && m_audioPyramid->channels() == m_channels;
+        auto sampleLevel = [&](int idx, int channel) -> int {
+            if (usePyramid) {
+                int frame = idx / m_channels;
+                return m_audioPyramid->peak(reverse ? frame - span + 1 : frame, span, channel);
+            }
+            return m_audioLevels.at(idx + channel);
+        };
         if (!KdenliveSettings::displayallchannels()) {
             // Draw merged channels
             double i = 0;
@@ -245,9 +261,9 @@ public:
                 if (idx + m_channels >= maxLength || idx < 0) {
                     break;
                 }
-                level = m_audioLevels.at(idx) / scaleFactor;
+                level = sampleLevel(idx, 0) / scaleFactor;
                 for (int k = 1; k < m_channels; k++) {
-                    level = qMax(level, m_audioLevels.at(idx + k) / scaleFactor);
+                    level = qMax(level, sampleLevel(idx, k) / scaleFactor);
                 }
                 if (pathDraw) {
                     double val = height() - level * height();
@@ -306,10 +322,10 @@ public:
                     idx += channel;
                     if (idx >= maxLength || idx < 0) break;
                     if (pathDraw) {
-                        level = m_audioLevels.at(idx) * scaleFactor;
+                        level = sampleLevel(idx - channel, channel) * scaleFactor;
                         path.lineTo(i, y - level);
                     } else {
-                        level = m_audioLevels.at(idx) * scaleFactor; // divide height by 510 (2*255) to get height
+                        level = sampleLevel(idx - channel, channel) * scaleFactor; // divide height by 510 (2*255) to get height
                         painter->drawLine(int(i), int(y - level), int(i), int(y + level));
                     }
                 }
@@ -336,6 +352,7 @@ Q_SIGNALS:
 
 private:
     QVector<uint8_t> m_audioLevels;
+    std::shared_ptr<const AudioLevelsPyramid> m_audioPyramid;
     int m_inPoint;
     int m_outPoint;
     QString m_binId;
@@ -11,10 +11,10 @@
 #include "core.h"
 #include "doc/kthumb.h"
 #include "utils/thumbnailcache.hpp"
+#include "utils/thumbnailproducerpool.hpp"
 
 #include <QCryptographicHash>
 #include <QDebug>
-#include <mlt++/MltFilter.h>
 #include <mlt++/MltProfile.h>
 
 ThumbnailProvider::ThumbnailProvider()
@@ -34,6 +34,8 @@ QImage ThumbnailProvider::requestImage(const QString &id, QSize *size, const QSi
     if (ok) {
         std::shared_ptr<ProjectClip> binClip = pCore->projectItemModel()->getClipByBinID(binId);
         if (binClip) {
+            // The clip is visible in timeline, process its pending tasks first
+            pCore->taskManager.boostClip(binId.toInt());
             int duration = binClip->frameDuration();
             if (frameNumber > duration) {
                 // for endless loopable clips, we rewrite the position
@@ -45,18 +47,9 @@ QImage ThumbnailProvider::requestImage(const QString &id, QSize *size, const QSi
                 *size = result.size();
                 return result;
             }
-            std::unique_ptr<Mlt::Producer> prod = binClip->getThumbProducer();
-            if (prod && prod->is_valid()) {
-                if (binClip->clipType() != ClipType::Timeline && binClip->clipType() != ClipType::Playlist) {
-                    Mlt::Profile *prodProfile = &pCore->thumbProfile();
-                    Mlt::Filter scaler(*prodProfile, "swscale");
-                    Mlt::Filter padder(*prodProfile, "resize");
-                    Mlt::Filter converter(*prodProfile, "avcolor_space");
-                    prod->attach(scaler);
-                    prod->attach(padder);
-                    prod->attach(converter);
-                }
-                result = makeThumbnail(std::move(prod), frameNumber, requestedSize);
+            ThumbnailProducerPool::Lease prod = ThumbnailProducerPool::get()->acquire(binClip);
+            if (prod.isValid()) {
+                result = makeThumbnail(prod, frameNumber, requestedSize);
                 ThumbnailCache::get()->storeThumbnail(binId, frameNumber, result, false);
             }
         }
@@ -65,20 +58,17 @@ QImage ThumbnailProvider::requestImage(const QString &id, QSize *size, const QSi
     return result;
 }
 
-QImage ThumbnailProvider::makeThumbnail(std::unique_ptr<Mlt::Producer> producer, int frameNumber, const QSize &requestedSize)
+QImage ThumbnailProvider::makeThumbnail(ThumbnailProducerPool::Lease &producer, int frameNumber, const QSize &requestedSize)
 {
     Q_UNUSED(requestedSize)
-    producer->seek(frameNumber);
-    std::unique_ptr<Mlt::Frame> frame(producer->get_frame());
-    if (frame == nullptr || !frame->is_valid()) {
-        return QImage();
-    }
-    // TODO: cache these values ?
-    frame->set("consumer.deinterlacer", "onefield");
-    frame->set("consumer.top_field_first", -1);
-    frame->set("consumer.rescale", "nearest");
     int imageHeight = pCore->thumbProfile().height();
     int imageWidth = pCore->thumbProfile().width();
     int fullWidth = qRound(imageHeight * pCore->getCurrentDar());
-    return KThumb::getFrame(frame.get(), imageWidth, imageHeight, fullWidth);
+    QImage result;
+    // Pooled producers keep their position, so requests for close frames of a clip decode forward instead of seeking
+    producer.extractBatch({frameNumber}, 0, imageWidth, imageHeight, fullWidth, [&result](int, const QImage &image) {
+        result = image;
+        return true;
+    });
+    return result;
 }
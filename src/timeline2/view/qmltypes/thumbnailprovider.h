@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include "utils/thumbnailproducerpool.hpp"
+
 #include <KImageCache>
 #include <QCache>
 #include <QQuickImageProvider>
@@ -23,5 +25,5 @@ public:
 
 private:
     Mlt::Profile m_profile;
-    QImage makeThumbnail(std::unique_ptr<Mlt::Producer> producer, int frameNumber, const QSize &requestedSize);
+    QImage makeThumbnail(ThumbnailProducerPool::Lease &producer, int frameNumber, const QSize &requestedSize);
 };
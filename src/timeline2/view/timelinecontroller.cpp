@@ -5146,6 +5146,7 @@ void TimelineController::exportSubtitle()
     if (!m_model->hasSubtitleModel()) {
         return;
     }
+    m_model->getSubtitleModel()->flushSubtitleFile();
     QString currentSub = m_model->getSubtitleModel()->getUrl();
     if (currentSub.isEmpty()) {
         pCore->displayMessage(i18n("No subtitles in current project"), ErrorMessage);
@@ -0,0 +1,384 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "cachemanager.hpp"
+#include "core.h"
+#include "kdenlive_debug.h"
+#include "kdenlivesettings.h"
+#include "mainwindow.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <algorithm>
+#include <vector>
+
+std::unique_ptr<CacheManager> CacheManager::instance;
+std::once_flag CacheManager::m_onceFlag;
+
+namespace {
+const quint32 indexMagic = 0x4b43494e;
+const quint32 indexVersion = 1;
+// The managed cache types, statistics are stored in this order
+const QVector<CacheType> managedTypes = {CachePreview, CacheProxy, CacheAudio, CacheThumbs};
+// Write the index to disk after this number of changes
+const int saveThreshold = 64;
+
+QString defaultIndexPath()
+{
+    const QString cacheRoot = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    return cacheRoot.isEmpty() ? QString() : QDir(cacheRoot).absoluteFilePath(QStringLiteral("cacheindex"));
+}
+} // namespace
+
+CacheManager::CacheManager()
+    : CacheManager(defaultIndexPath())
+{
+}
+
+CacheManager::CacheManager(const QString &indexPath)
+    : m_indexPath(indexPath)
+    , m_hits(managedTypes.size(), 0)
+    , m_misses(managedTypes.size(), 0)
+{
+    if (!m_indexPath.isEmpty()) {
+        load();
+    }
+}
+
+CacheManager::~CacheManager()
+{
+    save();
+}
+
+std::unique_ptr<CacheManager> &CacheManager::get()
+{
+    std::call_once(m_onceFlag, [] { instance.reset(new CacheManager()); });
+    return instance;
+}
+
+int CacheManager::statIndex(CacheType type) const
+{
+    return managedTypes.indexOf(type);
+}
+
+bool CacheManager::setDirty()
+{
+    return ++m_pendingChanges >= saveThreshold;
+}
+
+void CacheManager::recordStore(CacheType type, const QString &path)
+{
+    if (statIndex(type) < 0 || path.isEmpty()) {
+        return;
+    }
+    QFileInfo info(path);
+    if (!info.exists()) {
+        return;
+    }
+    QMutexLocker lock(&m_mutex);
+    auto it = m_entries.find(info.absoluteFilePath());
+    if (it != m_entries.end()) {
+        m_totalSize -= it->size;
+        it->type = type;
+        it->size = info.size();
+        it->lastAccess = QDateTime::currentMSecsSinceEpoch();
+    } else {
+        it = m_entries.insert(info.absoluteFilePath(), {type, info.size(), QDateTime::currentMSecsSinceEpoch()});
+    }
+    m_totalSize += it->size;
+    bool needsSave = setDirty();
+    bool evict = false;
+    if (!m_evictionPending && KdenliveSettings::cacheautoeviction() && KdenliveSettings::maxcachesize() > 0 &&
+        m_totalSize > qint64(1048576) * KdenliveSettings::maxcachesize()) {
+        m_evictionPending = true;
+        evict = true;
+    }
+    lock.unlock();
+    if (needsSave) {
+        save();
+    }
+    if (evict && pCore && pCore->window()) {
+        // Eviction needs to know which files are used by the current project, so it runs on the main thread
+        QMetaObject::invokeMethod(pCore->window(), "slotEnforceCacheBudget", Qt::QueuedConnection);
+    }
+}
+
+void CacheManager::recordAccess(CacheType type, const QString &path, bool hit)
+{
+    int ix = statIndex(type);
+    if (ix < 0) {
+        return;
+    }
+    QMutexLocker lock(&m_mutex);
+    if (!hit) {
+        m_misses[ix]++;
+        return;
+    }
+    m_hits[ix]++;
+    auto it = m_entries.find(path);
+    if (it != m_entries.end()) {
+        it->lastAccess = QDateTime::currentMSecsSinceEpoch();
+        bool needsSave = setDirty();
+        lock.unlock();
+        if (needsSave) {
+            save();
+        }
+        return;
+    }
+    // A file that was cached before the index existed
+    lock.unlock();
+    recordStore(type, path);
+}
+
+void CacheManager::forget(const QString &path)
+{
+    QMutexLocker lock(&m_mutex);
+    auto it = m_entries.find(path);
+    if (it != m_entries.end()) {
+        m_totalSize -= it->size;
+        m_entries.erase(it);
+        if (setDirty()) {
+            lock.unlock();
+            save();
+        }
+    }
+}
+
+void CacheManager::forgetFolder(const QString &folder)
+{
+    QString prefix = QDir::cleanPath(folder);
+    if (prefix.isEmpty()) {
+        return;
+    }
+    prefix.append(QLatin1Char('/'));
+    QMutexLocker lock(&m_mutex);
+    auto it = m_entries.begin();
+    while (it != m_entries.end()) {
+        if (it.key().startsWith(prefix)) {
+            m_totalSize -= it->size;
+            it = m_entries.erase(it);
+            m_pendingChanges++;
+        } else {
+            ++it;
+        }
+    }
+    lock.unlock();
+    save();
+}
+
+qint64 CacheManager::totalSize() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_totalSize;
+}
+
+CacheManager::Statistics CacheManager::statistics(CacheType type) const
+{
+    Statistics stats;
+    QMutexLocker lock(&m_mutex);
+    if (type == SystemCacheRoot) {
+        stats.size = m_totalSize;
+        stats.files = m_entries.size();
+        for (int i = 0; i < managedTypes.size(); ++i) {
+            stats.hits += m_hits.at(i);
+            stats.misses += m_misses.at(i);
+        }
+        return stats;
+    }
+    int ix = statIndex(type);
+    if (ix < 0) {
+        return stats;
+    }
+    stats.hits = m_hits.at(ix);
+    stats.misses = m_misses.at(ix);
+    for (const Entry &entry : qAsConst(m_entries)) {
+        if (entry.type == type) {
+            stats.size += entry.size;
+            stats.files++;
+        }
+    }
+    return stats;
+}
+
+bool CacheManager::isIndexed() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_indexed;
+}
+
+// static
+CacheType CacheManager::typeForPath(const QString &path)
+{
+    const QStringList parts = QDir::cleanPath(path).split(QLatin1Char('/'), Qt::SkipEmptyParts);
+    if (parts.size() < 2) {
+        return SystemCacheRoot;
+    }
+    const QString &parent = parts.at(parts.size() - 2);
+    if (parent == QLatin1String("proxy")) {
+        return CacheProxy;
+    }
+    if (parent == QLatin1String("audiothumbs")) {
+        return CacheAudio;
+    }
+    if (parent == QLatin1String("videothumbs")) {
+        return CacheThumbs;
+    }
+    // Preview chunks can be stored in preview/, preview/<sequence>/ or their undo subfolders
+    for (int i = parts.size() - 2; i >= qMax(0, parts.size() - 5); --i) {
+        if (parts.at(i) == QLatin1String("preview")) {
+            return CachePreview;
+        }
+    }
+    return SystemCacheRoot;
+}
+
+void CacheManager::indexFolder(const QDir &folder)
+{
+    QDirIterator it(folder.absolutePath(), QDir::Files | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+    QMutexLocker lock(&m_mutex);
+    while (it.hasNext()) {
+        const QString path = it.next();
+        CacheType type = typeForPath(path);
+        if (type == SystemCacheRoot || m_entries.contains(path)) {
+            continue;
+        }
+        const QFileInfo info = it.fileInfo();
+        const QDateTime lastAccess = info.lastRead().isValid() ? info.lastRead() : info.lastModified();
+        m_entries.insert(path, {type, info.size(), lastAccess.toMSecsSinceEpoch()});
+        m_totalSize += info.size();
+    }
+    m_indexed = true;
+    m_pendingChanges = saveThreshold;
+    lock.unlock();
+    save();
+}
+
+qint64 CacheManager::enforceBudget(qint64 budget, const std::function<bool(CacheType, const QString &)> &isInUse)
+{
+    struct Candidate
+    {
+        qint64 lastAccess;
+        QString path;
+        CacheType type;
+        qint64 size;
+    };
+    std::vector<Candidate> candidates;
+    qint64 excess;
+    {
+        QMutexLocker lock(&m_mutex);
+        m_evictionPending = false;
+        if (m_totalSize <= budget) {
+            return 0;
+        }
+        excess = m_totalSize - budget;
+        candidates.reserve(size_t(m_entries.size()));
+        for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) {
+            candidates.push_back({it->lastAccess, it.key(), it->type, it->size});
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate &a, const Candidate &b) { return a.lastAccess < b.lastAccess; });
+    // Delete the files without holding the lock, so that the tasks storing cached data are not blocked
+    qint64 freed = 0;
+    qint64 reduced = 0;
+    QStringList removed;
+    for (const Candidate &candidate : candidates) {
+        if (reduced >= excess) {
+            break;
+        }
+        if (!QFile::exists(candidate.path)) {
+            // File was removed outside of Kdenlive
+            reduced += candidate.size;
+            removed << candidate.path;
+            continue;
+        }
+        if (isInUse && isInUse(candidate.type, candidate.path)) {
+            continue;
+        }
+        if (QFile::remove(candidate.path)) {
+            freed += candidate.size;
+            reduced += candidate.size;
+            removed << candidate.path;
+        }
+    }
+    QMutexLocker lock(&m_mutex);
+    for (const QString &path : qAsConst(removed)) {
+        auto it = m_entries.find(path);
+        if (it != m_entries.end()) {
+            m_totalSize -= it->size;
+            m_entries.erase(it);
+        }
+    }
+    qCDebug(KDENLIVE_LOG) << "Cache eviction freed" << freed << "bytes, cache size is now" << m_totalSize;
+    m_pendingChanges = saveThreshold;
+    lock.unlock();
+    save();
+    return freed;
+}
+
+void CacheManager::load()
+{
+    QFile file(m_indexPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_15);
+    quint32 magic, version;
+    in >> magic >> version;
+    if (magic != indexMagic || version != indexVersion) {
+        return;
+    }
+    QVector<quint64> hits, misses;
+    qint32 count;
+    in >> hits >> misses >> count;
+    if (hits.size() == managedTypes.size() && misses.size() == managedTypes.size()) {
+        m_hits = hits;
+        m_misses = misses;
+    }
+    for (int i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QString path;
+        qint32 type;
+        Entry entry;
+        in >> path >> type >> entry.size >> entry.lastAccess;
+        entry.type = CacheType(type);
+        m_entries.insert(path, entry);
+        m_totalSize += entry.size;
+    }
+    if (in.status() != QDataStream::Ok) {
+        qCWarning(KDENLIVE_LOG) << "Corrupted cache index" << m_indexPath;
+        m_entries.clear();
+        m_totalSize = 0;
+        return;
+    }
+    m_indexed = true;
+}
+
+void CacheManager::save()
+{
+    QMutexLocker lock(&m_mutex);
+    if (m_pendingChanges == 0 || m_indexPath.isEmpty()) {
+        return;
+    }
+    QSaveFile file(m_indexPath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(KDENLIVE_LOG) << "Cannot write cache index" << m_indexPath;
+        return;
+    }
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_15);
+    out << indexMagic << indexVersion << m_hits << m_misses << qint32(m_entries.size());
+    for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) {
+        out << it.key() << qint32(it->type) << it->size << it->lastAccess;
+    }
+    if (file.commit()) {
+        m_pendingChanges = 0;
+    }
+}
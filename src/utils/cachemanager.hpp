@@ -0,0 +1,117 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include "definitions.h"
+#include <QDir>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+/** @class CacheManager
+    @brief This class keeps a persistent index of the files Kdenlive stores in its caches
+    (proxy clips, timeline preview chunks, audio and video thumbnails), with their size and last access time.
+    This allows to know the size of the cached data and to enforce the maxcachesize budget by removing
+    the least recently used files of all cache types, without walking the cache folders.
+    It also counts the cache hits and misses for each cache type.
+ * Note that this class is a Singleton
+ */
+class CacheManager
+{
+
+public:
+    struct Statistics
+    {
+        qint64 size = 0;
+        int files = 0;
+        quint64 hits = 0;
+        quint64 misses = 0;
+    };
+
+    ~CacheManager();
+
+    // Returns the instance of the Singleton
+    static std::unique_ptr<CacheManager> &get();
+
+    /** @brief Register a file that was just written to the cache, or update its size
+       @param type is the cache the file belongs to
+       @param path is the absolute path of the file
+     */
+    void recordStore(CacheType type, const QString &path);
+
+    /** @brief Record a cache lookup
+       @param type is the cache that was queried
+       @param path is the absolute path of the cached file
+       @param hit true if the cached file was found and used. The file last access time is then updated
+     */
+    void recordAccess(CacheType type, const QString &path, bool hit);
+
+    /** @brief Remove a file from the index, to call when Kdenlive deletes a cached file */
+    void forget(const QString &path);
+    /** @brief Remove all files in a folder from the index */
+    void forgetFolder(const QString &folder);
+
+    /** @brief Returns the total size of the indexed files, in bytes */
+    qint64 totalSize() const;
+    /** @brief Returns the statistics of a cache type, or for all types if @param type is SystemCacheRoot */
+    Statistics statistics(CacheType type = SystemCacheRoot) const;
+
+    /** @brief Returns true if the index was loaded from disk or built by indexFolder() */
+    bool isIndexed() const;
+    /** @brief Add all the cached files found in @param folder to the index.
+       The type of each file is deduced from its parent folders. This walks the folder, so it is only meant to build the initial index.
+     */
+    void indexFolder(const QDir &folder);
+
+    /** @brief Delete the least recently used files until the indexed data fits in @param budget bytes
+       @param isInUse is called for each candidate and should return true if the file cannot be removed
+       @returns the number of bytes that were freed
+     */
+    qint64 enforceBudget(qint64 budget, const std::function<bool(CacheType, const QString &)> &isInUse);
+
+    /** @brief Write the index to disk if it was modified */
+    void save();
+
+    /** @brief Returns the cache type of a file, deduced from the folder it is stored in, or SystemCacheRoot if it is not a managed file */
+    static CacheType typeForPath(const QString &path);
+
+protected:
+    // Constructor is protected because class is a Singleton
+    CacheManager();
+    /** @brief Build a manager storing its index in @param indexPath, used by the tests to not touch the user cache */
+    explicit CacheManager(const QString &indexPath);
+
+    struct Entry
+    {
+        CacheType type;
+        qint64 size;
+        qint64 lastAccess;
+    };
+
+    static std::unique_ptr<CacheManager> instance;
+    static std::once_flag m_onceFlag; // flag to create the manager only once;
+
+    void load();
+    // Count a change of the index, returns true if it should be saved
+    bool setDirty();
+    int statIndex(CacheType type) const;
+
+    mutable QMutex m_mutex;
+    QString m_indexPath;
+    QHash<QString, Entry> m_entries;
+    qint64 m_totalSize{0};
+    // Hits and misses per cache type, indexed by statIndex()
+    QVector<quint64> m_hits;
+    QVector<quint64> m_misses;
+    bool m_indexed{false};
+    // True when an eviction was requested on the main thread
+    bool m_evictionPending{false};
+    int m_pendingChanges{0};
+};
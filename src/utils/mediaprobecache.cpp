@@ -0,0 +1,224 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "mediaprobecache.hpp"
+#include "kdenlive_debug.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <algorithm>
+#include <vector>
+
+#ifdef Q_OS_UNIX
+// on Unix systems the inode allows to detect a file replaced by another one with the same size and date
+#include "sys/stat.h"
+#endif
+
+std::unique_ptr<MediaProbeCache> MediaProbeCache::instance;
+std::once_flag MediaProbeCache::m_onceFlag;
+
+namespace {
+const quint32 databaseMagic = 0x4b50524f;
+const quint32 databaseVersion = 2;
+// Write the database to disk after this number of changes
+const int saveThreshold = 64;
+// Maximum number of files in the database, the least recently used ones are dropped
+const int maxEntries = 20000;
+
+QString defaultPath()
+{
+    const QString cacheRoot = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    return cacheRoot.isEmpty() ? QString() : QDir(cacheRoot).absoluteFilePath(QStringLiteral("probecache"));
+}
+} // namespace
+
+MediaProbeCache::MediaProbeCache()
+    : MediaProbeCache(defaultPath())
+{
+}
+
+MediaProbeCache::MediaProbeCache(const QString &path)
+    : m_path(path)
+{
+    if (!m_path.isEmpty()) {
+        load();
+    }
+}
+
+MediaProbeCache::~MediaProbeCache()
+{
+    save();
+}
+
+std::unique_ptr<MediaProbeCache> &MediaProbeCache::get()
+{
+    std::call_once(m_onceFlag, [] { instance.reset(new MediaProbeCache()); });
+    return instance;
+}
+
+// static
+MediaProbeCache::Signature MediaProbeCache::signature(const QString &path)
+{
+    Signature sig;
+    const QFileInfo info(path);
+    if (!info.isFile()) {
+        return sig;
+    }
+    sig.size = info.size();
+    sig.modified = info.lastModified().toMSecsSinceEpoch();
+#ifdef Q_OS_UNIX
+    struct stat status;
+    if (::stat(QFile::encodeName(path).constData(), &status) == 0) {
+        sig.inode = quint64(status.st_ino);
+    }
+#endif
+    return sig;
+}
+
+// static
+bool MediaProbeCache::isProbeProperty(const QByteArray &name)
+{
+    return name.startsWith("meta.") || name == "length" || name == "seekable" || name == "video_index" || name == "audio_index" ||
+           name == "set.test_image" || name == "creation_time";
+}
+
+bool MediaProbeCache::setDirty()
+{
+    return ++m_pendingChanges >= saveThreshold;
+}
+
+MediaProbeCache::Entry *MediaProbeCache::validEntry(const QString &path, const Signature &sig)
+{
+    auto it = m_entries.find(path);
+    if (it == m_entries.end() || sig.size < 0 || !(it->signature == sig)) {
+        return nullptr;
+    }
+    it->lastUse = QDateTime::currentSecsSinceEpoch();
+    return &it.value();
+}
+
+MediaProbeCache::Entry &MediaProbeCache::updatedEntry(const QString &path, const Signature &sig)
+{
+    Entry &entry = m_entries[path];
+    if (!(entry.signature == sig)) {
+        // The file changed, previous data is obsolete
+        entry = Entry();
+        entry.signature = sig;
+    }
+    entry.lastUse = QDateTime::currentSecsSinceEpoch();
+    return entry;
+}
+
+MediaProbeCache::Properties MediaProbeCache::properties(const QString &path, const QByteArray &frameRate)
+{
+    const Signature sig = signature(path);
+    QMutexLocker lock(&m_mutex);
+    Entry *entry = validEntry(path, sig);
+    return (entry && entry->frameRate == frameRate) ? entry->properties : Properties();
+}
+
+void MediaProbeCache::storeProperties(const QString &path, const QByteArray &frameRate, const Properties &properties)
+{
+    const Signature sig = signature(path);
+    if (sig.size < 0 || frameRate.isEmpty() || properties.isEmpty()) {
+        return;
+    }
+    QMutexLocker lock(&m_mutex);
+    Entry &entry = updatedEntry(path, sig);
+    entry.frameRate = frameRate;
+    entry.properties = properties;
+    if (setDirty()) {
+        lock.unlock();
+        save();
+    }
+}
+
+QByteArray MediaProbeCache::fileHash(const QString &path)
+{
+    const Signature sig = signature(path);
+    QMutexLocker lock(&m_mutex);
+    Entry *entry = validEntry(path, sig);
+    return entry ? entry->hash : QByteArray();
+}
+
+void MediaProbeCache::storeFileHash(const QString &path, const QByteArray &hash)
+{
+    const Signature sig = signature(path);
+    if (sig.size < 0 || hash.isEmpty()) {
+        return;
+    }
+    QMutexLocker lock(&m_mutex);
+    updatedEntry(path, sig).hash = hash;
+    if (setDirty()) {
+        lock.unlock();
+        save();
+    }
+}
+
+void MediaProbeCache::load()
+{
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_15);
+    quint32 magic, version;
+    qint32 count;
+    in >> magic >> version;
+    if (magic != databaseMagic || version != databaseVersion) {
+        return;
+    }
+    in >> count;
+    for (int i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QString path;
+        Entry entry;
+        in >> path >> entry.signature.size >> entry.signature.modified >> entry.signature.inode >> entry.hash >> entry.frameRate >> entry.properties >> entry.lastUse;
+        m_entries.insert(path, entry);
+    }
+    if (in.status() != QDataStream::Ok) {
+        qCWarning(KDENLIVE_LOG) << "Corrupted media probe cache" << m_path;
+        m_entries.clear();
+    }
+}
+
+void MediaProbeCache::save()
+{
+    QMutexLocker lock(&m_mutex);
+    if (m_pendingChanges == 0 || m_path.isEmpty()) {
+        return;
+    }
+    if (m_entries.size() > maxEntries) {
+        std::vector<std::pair<qint64, QString>> usage;
+        usage.reserve(size_t(m_entries.size()));
+        for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) {
+            usage.emplace_back(it->lastUse, it.key());
+        }
+        std::sort(usage.begin(), usage.end());
+        for (size_t i = 0; i < usage.size() - maxEntries; ++i) {
+            m_entries.remove(usage.at(i).second);
+        }
+    }
+    QSaveFile file(m_path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(KDENLIVE_LOG) << "Cannot write media probe cache" << m_path;
+        return;
+    }
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_15);
+    out << databaseMagic << databaseVersion << qint32(m_entries.size());
+    for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) {
+        out << it.key() << it->signature.size << it->signature.modified << it->signature.inode << it->hash << it->frameRate << it->properties << it->lastUse;
+    }
+    if (file.commit()) {
+        m_pendingChanges = 0;
+    }
+}
@@ -0,0 +1,96 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QPair>
+#include <QString>
+#include <memory>
+#include <mutex>
+
+/** @class MediaProbeCache
+    @brief This class keeps a persistent database of the information read from the media files:
+    the properties found when probing the file with avformat and the file hash.
+    Entries are keyed by the file path and only used if the size, modification time and inode of the file did not change,
+    so that reopening a project does not need to read unchanged media files again.
+    Some probed properties like the length are counted in frames of the project profile, so the probe properties are only
+    used with the frame rate they were read with.
+ * Note that this class is a Singleton
+ */
+class MediaProbeCache
+{
+
+public:
+    /** @brief A list of producer property names and values */
+    using Properties = QList<QPair<QByteArray, QByteArray>>;
+
+    ~MediaProbeCache();
+
+    // Returns the instance of the Singleton
+    static std::unique_ptr<MediaProbeCache> &get();
+
+    /** @brief Returns the cached probe properties of a file, or an empty list if the file was never probed with
+     *  the project @param frameRate or changed since */
+    Properties properties(const QString &path, const QByteArray &frameRate);
+    /** @brief Store the probe properties of a file, read with the project @param frameRate */
+    void storeProperties(const QString &path, const QByteArray &frameRate, const Properties &properties);
+
+    /** @brief Returns the cached hash of a file, or an empty array if the file was never hashed or changed since */
+    QByteArray fileHash(const QString &path);
+    /** @brief Store the hash of a file */
+    void storeFileHash(const QString &path, const QByteArray &hash);
+
+    /** @brief Returns true if @param name is a producer property filled by probing the file */
+    static bool isProbeProperty(const QByteArray &name);
+
+    /** @brief Write the database to disk if it was modified */
+    void save();
+
+protected:
+    // Constructor is protected because class is a Singleton
+    MediaProbeCache();
+    /** @brief Build a cache stored in @param path, used by the tests to not touch the user cache */
+    explicit MediaProbeCache(const QString &path);
+
+    struct Signature
+    {
+        qint64 size = -1;
+        qint64 modified = 0;
+        quint64 inode = 0;
+        bool operator==(const Signature &other) const { return size == other.size && modified == other.modified && inode == other.inode; }
+    };
+
+    struct Entry
+    {
+        Signature signature;
+        QByteArray hash;
+        // The project frame rate of the probe properties, as num/den
+        QByteArray frameRate;
+        Properties properties;
+        qint64 lastUse = 0;
+    };
+
+    static std::unique_ptr<MediaProbeCache> instance;
+    static std::once_flag m_onceFlag; // flag to create the cache only once;
+
+    /** @brief Returns the size, modification time and inode of a file, without reading it */
+    static Signature signature(const QString &path);
+    /** @brief Returns the entry of an unchanged file, or nullptr. Must be called with the mutex locked */
+    Entry *validEntry(const QString &path, const Signature &sig);
+    /** @brief Returns the entry of a file, reset if the file changed. Must be called with the mutex locked */
+    Entry &updatedEntry(const QString &path, const Signature &sig);
+    void load();
+    // Count a change of the database, returns true if it should be saved
+    bool setDirty();
+
+    QMutex m_mutex;
+    QString m_path;
+    QHash<QString, Entry> m_entries;
+    int m_pendingChanges{0};
+};
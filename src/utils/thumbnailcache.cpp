@@ -6,6 +6,7 @@
 #include "thumbnailcache.hpp"
 #include "bin/projectclip.h"
 #include "bin/projectitemmodel.h"
+#include "cachemanager.hpp"
 #include "core.h"
 #include "doc/kdenlivedoc.h"
 #include "project/projectmanager.h"
@@ -186,9 +187,11 @@ QImage ThumbnailCache::getThumbnail(QString hash, const QString &binId, int pos,
             m_storedOnDisk[binId].push_back(pos);
         }
         locker.unlock();
+        CacheManager::get()->recordAccess(CacheThumbs, thumbFolder.absoluteFilePath(hash), true);
         return QImage(thumbFolder.absoluteFilePath(hash));
     }
     locker.unlock();
+    CacheManager::get()->recordAccess(CacheThumbs, QString(), false);
     return QImage();
 }
 
@@ -210,8 +213,11 @@ QImage ThumbnailCache::getThumbnail(const QString &binId, int pos, bool volatile
             m_storedOnDisk[binId].push_back(pos);
         }
         locker.unlock();
+        CacheManager::get()->recordAccess(CacheThumbs, thumbFolder.absoluteFilePath(key), true);
         return QImage(thumbFolder.absoluteFilePath(key));
     }
+    locker.unlock();
+    CacheManager::get()->recordAccess(CacheThumbs, QString(), false);
     return QImage();
 }
 
@@ -243,6 +249,8 @@ void ThumbnailCache::storeThumbnail(const QString &binId, int pos, const QImage
             locker.unlock();
             if (!img.save(thumbFolder.absoluteFilePath(key))) {
                 qDebug() << ".............\n!!!!!!!! ERROR SAVING THUMB in: " << thumbFolder.absoluteFilePath(key);
+            } else {
+                CacheManager::get()->recordStore(CacheThumbs, thumbFolder.absoluteFilePath(key));
             }
         }
     }
@@ -277,6 +285,7 @@ void ThumbnailCache::saveCachedThumbs(const std::unordered_map<QString, std::vec
                         break;
                     } else {
                         m_storedOnDisk[key.first].push_back(pos);
+                        CacheManager::get()->recordStore(CacheThumbs, thumbFolder.absoluteFilePath(thumbKey));
                     }
                 }
             }
@@ -318,7 +327,9 @@ void ThumbnailCache::invalidateThumbsForClip(const QString &binId)
         QDir thumbFolder = getDir(false, &ok);
         if (ok) {
             while (!files.isEmpty()) {
-                thumbFolder.remove(files.takeFirst());
+                const QString file = files.takeFirst();
+                thumbFolder.remove(file);
+                CacheManager::get()->forget(thumbFolder.absoluteFilePath(file));
             }
         }
     }
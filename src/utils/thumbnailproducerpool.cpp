@@ -0,0 +1,285 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "thumbnailproducerpool.hpp"
+#include "bin/projectclip.h"
+#include "core.h"
+#include "doc/kthumb.h"
+#include "kdenlive_debug.h"
+
+#include <QMutexLocker>
+#include <QThread>
+#include <algorithm>
+#include <mlt++/MltFilter.h>
+#include <mlt++/MltProfile.h>
+
+std::unique_ptr<ThumbnailProducerPool> ThumbnailProducerPool::instance;
+std::once_flag ThumbnailProducerPool::m_onceFlag;
+
+ThumbnailProducerPool::Lease::Lease(Lease &&other) noexcept
+    : m_binId(std::move(other.m_binId))
+    , m_generation(other.m_generation)
+    , m_producer(std::move(other.m_producer))
+    , m_pooled(other.m_pooled)
+{
+}
+
+ThumbnailProducerPool::Lease &ThumbnailProducerPool::Lease::operator=(Lease &&other) noexcept
+{
+    if (this != &other) {
+        release();
+        m_binId = std::move(other.m_binId);
+        m_generation = other.m_generation;
+        m_producer = std::move(other.m_producer);
+        m_pooled = other.m_pooled;
+    }
+    return *this;
+}
+
+ThumbnailProducerPool::Lease::~Lease()
+{
+    release();
+}
+
+void ThumbnailProducerPool::Lease::release()
+{
+    if (m_producer == nullptr) {
+        return;
+    }
+    if (m_pooled) {
+        ThumbnailProducerPool::get()->release(*this);
+    }
+    m_producer.reset();
+}
+
+bool ThumbnailProducerPool::Lease::isValid() const
+{
+    return m_producer != nullptr && m_producer->is_valid();
+}
+
+Mlt::Producer *ThumbnailProducerPool::Lease::producer() const
+{
+    return m_producer.get();
+}
+
+std::unique_ptr<Mlt::Frame> ThumbnailProducerPool::Lease::getFrame(int pos)
+{
+    auto &pool = ThumbnailProducerPool::get();
+    if (m_producer->position() != pos) {
+        m_producer->seek(pos);
+        pool->m_seeks.fetchAndAddRelaxed(1);
+    }
+    std::unique_ptr<Mlt::Frame> frame(m_producer->get_frame());
+    pool->m_decodes.fetchAndAddRelaxed(1);
+    return frame;
+}
+
+void ThumbnailProducerPool::Lease::extractBatch(std::vector<int> positions, int tolerance, int width, int height, int displayWidth,
+                                                const std::function<bool(int, const QImage &)> &callback)
+{
+    auto &pool = ThumbnailProducerPool::get();
+    std::sort(positions.begin(), positions.end());
+    positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+    // Beyond this distance, seeking to the previous keyframe is cheaper than decoding all frames up to the position
+    const int forwardWindow = qMax(1, qRound(2 * m_producer->get_fps()));
+    size_t ix = 0;
+    while (ix < positions.size()) {
+        const int target = positions.at(ix);
+        int current = m_producer->position();
+        if (current > target + tolerance || target - current > forwardWindow) {
+            m_producer->seek(target);
+            pool->m_seeks.fetchAndAddRelaxed(1);
+            current = target;
+        }
+        std::unique_ptr<Mlt::Frame> frame(m_producer->get_frame());
+        pool->m_decodes.fetchAndAddRelaxed(1);
+        if (m_producer->position() == current) {
+            // Producer with a null speed, move forward ourselves
+            m_producer->seek(current + 1);
+        }
+        if (frame == nullptr || !frame->is_valid()) {
+            if (!callback(target, QImage())) {
+                return;
+            }
+            ix++;
+            continue;
+        }
+        frame->set("consumer.deinterlacer", "onefield");
+        frame->set("consumer.top_field_first", -1);
+        frame->set("consumer.rescale", "nearest");
+        if (current < target) {
+            // Decode the frame so that the decoder keeps moving forward, but skip the rgb conversion
+            mlt_image_format format = mlt_image_yuv420p;
+            int w = width;
+            int h = height;
+            frame->get_image(format, w, h);
+            continue;
+        }
+        const QImage result = KThumb::getFrame(frame.get(), width, height, displayWidth);
+        // Use this frame for all requested positions it is close enough to
+        while (ix < positions.size() && positions.at(ix) <= current) {
+            if (!callback(positions.at(ix), result)) {
+                return;
+            }
+            ix++;
+        }
+    }
+}
+
+ThumbnailProducerPool::ThumbnailProducerPool()
+    : m_openHandles(0)
+    , m_maxHandles(qMax(8, 2 * QThread::idealThreadCount()))
+    , m_hits(0)
+    , m_opens(0)
+    , m_evictions(0)
+    , m_seeks(0)
+    , m_decodes(0)
+{
+}
+
+std::unique_ptr<ThumbnailProducerPool> &ThumbnailProducerPool::get()
+{
+    std::call_once(m_onceFlag, [] { instance.reset(new ThumbnailProducerPool()); });
+    return instance;
+}
+
+ThumbnailProducerPool::Lease ThumbnailProducerPool::acquire(const std::shared_ptr<ProjectClip> &binClip)
+{
+    Lease lease;
+    ClipType::ProducerType type = binClip->clipType();
+    if (type == ClipType::Timeline || type == ClipType::Playlist) {
+        // These thumb producers are built on the master producer, don't keep them
+        lease.m_producer = binClip->getThumbProducer();
+        return lease;
+    }
+    const QString binId = binClip->clipId();
+    // Declared before the lock so that evicted producers are closed outside of it
+    std::list<Entry> evicted;
+    QMutexLocker lk(&m_mutex);
+    quint64 generation = 0;
+    while (true) {
+        generation = m_generations[binId];
+        for (auto it = m_idle.begin(); it != m_idle.end(); ++it) {
+            if (it->binId == binId && it->generation == generation) {
+                lease.m_binId = binId;
+                lease.m_generation = generation;
+                lease.m_producer = std::move(it->producer);
+                lease.m_pooled = true;
+                m_idle.erase(it);
+                m_hits.fetchAndAddRelaxed(1);
+                return lease;
+            }
+        }
+        if (m_openHandles < m_maxHandles) {
+            break;
+        }
+        if (!m_idle.empty()) {
+            // Close the least recently used idle producer to make room for ours
+            evicted.splice(evicted.end(), m_idle, std::prev(m_idle.end()));
+            m_openHandles--;
+            m_evictions.fetchAndAddRelaxed(1);
+        } else {
+            // All producers are borrowed, wait until one is returned
+            m_available.wait(&m_mutex);
+        }
+    }
+    // Reserve the handle before opening the producer, so that concurrent requests cannot exceed the limit
+    m_openHandles++;
+    lk.unlock();
+    std::unique_ptr<Mlt::Producer> prod = binClip->getThumbProducer();
+    if (prod == nullptr || !prod->is_valid()) {
+        lk.relock();
+        m_openHandles--;
+        m_available.wakeOne();
+        return lease;
+    }
+    Mlt::Profile *prodProfile = &pCore->thumbProfile();
+    Mlt::Filter scaler(*prodProfile, "swscale");
+    Mlt::Filter padder(*prodProfile, "resize");
+    Mlt::Filter converter(*prodProfile, "avcolor_space");
+    prod->attach(scaler);
+    prod->attach(padder);
+    prod->attach(converter);
+    lease.m_binId = binId;
+    lease.m_generation = generation;
+    lease.m_producer = std::move(prod);
+    lease.m_pooled = true;
+    m_opens.fetchAndAddRelaxed(1);
+    return lease;
+}
+
+void ThumbnailProducerPool::release(Lease &lease)
+{
+    std::list<Entry> evicted;
+    QMutexLocker lk(&m_mutex);
+    auto gen = m_generations.find(lease.m_binId);
+    if (gen == m_generations.end() || gen->second != lease.m_generation) {
+        // Clip was invalidated while the producer was borrowed
+        m_openHandles--;
+        m_available.wakeOne();
+        lk.unlock();
+        lease.m_producer.reset();
+        return;
+    }
+    m_idle.push_front({lease.m_binId, lease.m_generation, std::move(lease.m_producer)});
+    evict(evicted);
+    m_available.wakeOne();
+}
+
+void ThumbnailProducerPool::evict(std::list<Entry> &evicted)
+{
+    while (m_openHandles > m_maxHandles && !m_idle.empty()) {
+        evicted.splice(evicted.end(), m_idle, std::prev(m_idle.end()));
+        m_openHandles--;
+        m_evictions.fetchAndAddRelaxed(1);
+    }
+}
+
+void ThumbnailProducerPool::invalidate(const QString &binId)
+{
+    std::list<Entry> evicted;
+    QMutexLocker lk(&m_mutex);
+    m_generations[binId]++;
+    for (auto it = m_idle.begin(); it != m_idle.end();) {
+        if (it->binId == binId) {
+            auto next = std::next(it);
+            evicted.splice(evicted.end(), m_idle, it);
+            m_openHandles--;
+            it = next;
+        } else {
+            ++it;
+        }
+    }
+    m_available.wakeAll();
+}
+
+void ThumbnailProducerPool::clear()
+{
+    std::list<Entry> evicted;
+    QMutexLocker lk(&m_mutex);
+    m_openHandles -= int(m_idle.size());
+    evicted.swap(m_idle);
+    // Borrowed producers will be closed when returned
+    for (auto &gen : m_generations) {
+        gen.second++;
+    }
+    m_available.wakeAll();
+    qCDebug(KDENLIVE_LOG) << "Thumbnail producer pool, hits:" << m_hits.loadRelaxed() << ", opens:" << m_opens.loadRelaxed()
+                          << ", evictions:" << m_evictions.loadRelaxed() << ", seeks:" << m_seeks.loadRelaxed() << ", decodes:" << m_decodes.loadRelaxed();
+}
+
+void ThumbnailProducerPool::setMaxHandles(int max)
+{
+    std::list<Entry> evicted;
+    QMutexLocker lk(&m_mutex);
+    m_maxHandles = qMax(1, max);
+    evict(evicted);
+    m_available.wakeAll();
+}
+
+ThumbnailProducerPool::Statistics ThumbnailProducerPool::statistics() const
+{
+    return {m_hits.loadRelaxed(), m_opens.loadRelaxed(), m_evictions.loadRelaxed(), m_seeks.loadRelaxed(), m_decodes.loadRelaxed()};
+}
@@ -0,0 +1,137 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QAtomicInteger>
+#include <QImage>
+#include <QMutex>
+#include <QString>
+#include <QWaitCondition>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <mlt++/MltFrame.h>
+#include <mlt++/MltProducer.h>
+
+class ProjectClip;
+
+/** @class ThumbnailProducerPool
+    @brief This class keeps a bounded pool of opened thumbnail producers so that thumbnail requests
+    for a clip don't need to open a new decoder each time.
+    A producer is borrowed through a Lease and returned to the pool when the Lease is destroyed.
+    The number of opened producers, idle or borrowed, never exceeds the limit: idle producers are closed
+    in least recently used order to open new ones, and when all producers are borrowed, acquire() waits
+    until one is returned. Each caller only holds one Lease at a time, so this cannot deadlock.
+    Sequence and playlist producers are not pooled and not counted.
+ * Note that this class is a Singleton
+ */
+class ThumbnailProducerPool
+{
+
+public:
+    /** @brief Counters used to measure the pool efficiency */
+    struct Statistics
+    {
+        quint64 hits;
+        quint64 opens;
+        quint64 evictions;
+        quint64 seeks;
+        quint64 decodes;
+    };
+
+    /** @class Lease
+        @brief Exclusive access to a thumbnail producer, returned to the pool on destruction.
+     */
+    class Lease
+    {
+    public:
+        Lease() = default;
+        Lease(Lease &&other) noexcept;
+        Lease &operator=(Lease &&other) noexcept;
+        Lease(const Lease &) = delete;
+        Lease &operator=(const Lease &) = delete;
+        ~Lease();
+        bool isValid() const;
+        Mlt::Producer *producer() const;
+        /** @brief Returns the frame at @param pos, only seeking when the producer is not already at this position */
+        std::unique_ptr<Mlt::Frame> getFrame(int pos);
+        /** @brief Extract thumbnails for several positions, decoding forward instead of seeking when possible.
+         *  Positions are sorted, and the frames between two close positions are decoded in sequence so that the decoder
+         *  doesn't seek. We only seek backwards or to reach a position more than 2 seconds ahead.
+         *  A frame up to @param tolerance frames after a requested position is used for it, so that a position that
+         *  the producer just passed doesn't need a backwards seek.
+         *  @param callback is called with each requested position and its image, return false to abort the extraction
+         */
+        void extractBatch(std::vector<int> positions, int tolerance, int width, int height, int displayWidth,
+                          const std::function<bool(int, const QImage &)> &callback);
+
+    private:
+        friend class ThumbnailProducerPool;
+        QString m_binId;
+        quint64 m_generation{0};
+        std::unique_ptr<Mlt::Producer> m_producer;
+        /** @brief False for producers that must not be reused (sequence and playlist clips) */
+        bool m_pooled{false};
+        void release();
+    };
+
+    // Returns the instance of the Singleton
+    static std::unique_ptr<ThumbnailProducerPool> &get();
+
+    /** @brief Borrow a thumbnail producer for a clip, reusing an idle one if possible. Blocks while all producers are borrowed.
+     *  The returned Lease is invalid if no producer is available. Don't call it while holding another Lease */
+    Lease acquire(const std::shared_ptr<ProjectClip> &binClip);
+
+    /** @brief Close the idle producers of a clip and ensure borrowed ones are not reused, to be called when the clip producer changes */
+    void invalidate(const QString &binId);
+
+    /** @brief Close all idle producers */
+    void clear();
+
+    /** @brief Set the maximum number of opened producers */
+    void setMaxHandles(int max);
+
+    /** @brief Returns the pool counters */
+    Statistics statistics() const;
+
+protected:
+    // Constructor is protected because class is a Singleton
+    ThumbnailProducerPool();
+
+    static std::unique_ptr<ThumbnailProducerPool> instance;
+    static std::once_flag m_onceFlag; // flag to create the pool only once;
+
+private:
+    struct Entry
+    {
+        QString binId;
+        quint64 generation;
+        std::unique_ptr<Mlt::Producer> producer;
+    };
+    /** @brief Return a borrowed producer to the pool */
+    void release(Lease &lease);
+    /** @brief Move the least recently used idle producers out of the pool until we are within the limit. Must be called with m_mutex locked */
+    void evict(std::list<Entry> &evicted);
+
+    mutable QMutex m_mutex;
+    /** @brief Signaled when a handle may be available */
+    QWaitCondition m_available;
+    /** @brief Idle producers, most recently used first */
+    std::list<Entry> m_idle;
+    std::unordered_map<QString, quint64> m_generations;
+    /** @brief Number of opened producers, idle or borrowed */
+    int m_openHandles;
+    int m_maxHandles;
+    QAtomicInteger<quint64> m_hits;
+    QAtomicInteger<quint64> m_opens;
+    QAtomicInteger<quint64> m_evictions;
+    QAtomicInteger<quint64> m_seeks;
+    QAtomicInteger<quint64> m_decodes;
+};
@@ -8,6 +8,7 @@
 // test specific headers
 #include "doc/docundostack.hpp"
 #include "doc/kdenlivedoc.h"
+#include <QTemporaryDir>
 #include <cmath>
 #include <iostream>
 #include <tuple>
@@ -15,6 +16,10 @@
 
 #include "core.h"
 #include "definitions.h"
+#include "lib/audio/audioLevelsCache.h"
+#include "lib/audio/audioLevelsPyramid.h"
+#include "utils/cachemanager.hpp"
+#include "utils/mediaprobecache.hpp"
 #include "utils/thumbnailcache.hpp"
 
 TEST_CASE("Cache insert-remove", "[Cache]")
@@ -94,3 +99,144 @@ TEST_CASE("getAudioKey() should dereference `ok` param", "ThumbnailCache") {
     }
     pCore->projectManager()->closeCurrentDocument(false, false);
 }
+
+TEST_CASE("Audio levels cache", "[Cache]")
+{
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("levels"));
+    QVector<uint8_t> levels;
+    for (int i = 0; i < 1000; i++) {
+        levels << uint8_t(i % 256);
+    }
+    REQUIRE(AudioLevelsCache::write(path, levels, 2, 25., 1, 255));
+
+    SECTION("Read back levels")
+    {
+        QVector<uint8_t> result;
+        AudioLevelsCache::Header header;
+        REQUIRE(AudioLevelsCache::read(path, 2, 25., result, &header));
+        REQUIRE(result == levels);
+        REQUIRE(header.version == AudioLevelsCache::formatVersion);
+        REQUIRE(header.channels == 2);
+        REQUIRE(header.stream == 1);
+        REQUIRE(header.maxLevel == 255);
+    }
+
+    SECTION("Reject mismatching layout")
+    {
+        QVector<uint8_t> result;
+        REQUIRE_FALSE(AudioLevelsCache::read(path, 6, 25., result));
+        REQUIRE_FALSE(AudioLevelsCache::read(path, 2, 30., result));
+        REQUIRE(result.isEmpty());
+    }
+}
+
+TEST_CASE("Audio levels pyramid", "[Cache]")
+{
+    // 2 channels, 100 frames with a single transient on each channel
+    QVector<uint8_t> levels(200, 10);
+    levels[2 * 37] = 200;
+    levels[2 * 81 + 1] = 150;
+    AudioLevelsPyramid pyramid(levels, 2);
+    REQUIRE(pyramid.frames() == 100);
+    REQUIRE(pyramid.levelCount() == 8);
+    REQUIRE(pyramid.level(0) == levels);
+    // Transients are kept whatever the span
+    for (int span : {1, 3, 8, 16, 50}) {
+        int start = 37 - (37 % span);
+        REQUIRE(pyramid.peak(start, span, 0) == 200);
+        REQUIRE(pyramid.peak(start, span, 1) == 10);
+    }
+    REQUIRE(pyramid.peak(0, 100, 1) == 150);
+    REQUIRE(pyramid.peak(0, 30, 0) == 10);
+}
+
+TEST_CASE("Cache manager eviction", "[Cache]")
+{
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    QDir proxyDir(dir.path());
+    REQUIRE(proxyDir.mkdir(QStringLiteral("proxy")));
+    REQUIRE(proxyDir.cd(QStringLiteral("proxy")));
+    QStringList files;
+    for (const QString &name : {QStringLiteral("a.mkv"), QStringLiteral("b.mkv"), QStringLiteral("c.mkv")}) {
+        QFile file(proxyDir.absoluteFilePath(name));
+        REQUIRE(file.open(QIODevice::WriteOnly));
+        file.write(QByteArray(1000, 'x'));
+        file.close();
+        files << proxyDir.absoluteFilePath(name);
+    }
+    REQUIRE(CacheManager::typeForPath(files.first()) == CacheProxy);
+    // Use a separate index, the tests must not touch the user cache
+    CacheManager manager(dir.filePath(QStringLiteral("cacheindex")));
+    REQUIRE(manager.statistics(CacheProxy).files == 0);
+    for (const QString &file : qAsConst(files)) {
+        manager.recordStore(CacheProxy, file);
+    }
+    // b.mkv was used before c.mkv, and using a.mkv makes it the most recently used file
+    manager.m_entries[files.at(1)].lastAccess = 1;
+    manager.m_entries[files.at(2)].lastAccess = 2;
+    manager.recordAccess(CacheProxy, files.at(0), true);
+    manager.recordAccess(CacheProxy, QString(), false);
+    const CacheManager::Statistics stats = manager.statistics(CacheProxy);
+    REQUIRE(stats.files == 3);
+    REQUIRE(stats.size == 3000);
+    REQUIRE(stats.hits == 1);
+    REQUIRE(stats.misses == 1);
+
+    // Only our files can be removed
+    auto isInUse = [&dir](CacheType, const QString &path) { return !path.startsWith(dir.path()); };
+    REQUIRE(manager.enforceBudget(1500, isInUse) == 2000);
+    REQUIRE(QFile::exists(files.at(0)));
+    REQUIRE_FALSE(QFile::exists(files.at(1)));
+    REQUIRE_FALSE(QFile::exists(files.at(2)));
+    REQUIRE(manager.totalSize() == 1000);
+
+    manager.forgetFolder(proxyDir.absolutePath());
+    REQUIRE(manager.statistics(CacheProxy).files == 0);
+}
+
+TEST_CASE("Media probe cache", "[Cache]")
+{
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString path = QDir(dir.path()).absoluteFilePath(QStringLiteral("clip.mp4"));
+    QFile file(path);
+    REQUIRE(file.open(QIODevice::WriteOnly));
+    file.write(QByteArray(1000, 'x'));
+    file.close();
+
+    // Use a separate database, the tests must not touch the user cache
+    MediaProbeCache cache(dir.filePath(QStringLiteral("probecache")));
+    REQUIRE(cache.properties(path, "25/1").isEmpty());
+    REQUIRE(cache.fileHash(path).isEmpty());
+
+    const MediaProbeCache::Properties properties = {{"length", "250"}, {"meta.media.nb_streams", "2"}};
+    cache.storeProperties(path, "25/1", properties);
+    cache.storeFileHash(path, QByteArray("hash"));
+    REQUIRE(cache.properties(path, "25/1") == properties);
+    REQUIRE(cache.fileHash(path) == QByteArray("hash"));
+    // The length depends on the project frame rate
+    REQUIRE(cache.properties(path, "30000/1001").isEmpty());
+    REQUIRE(cache.fileHash(path) == QByteArray("hash"));
+    REQUIRE(MediaProbeCache::isProbeProperty("meta.media.width"));
+    REQUIRE_FALSE(MediaProbeCache::isProbeProperty("kdenlive:id"));
+    // The database is written and read back
+    cache.save();
+    MediaProbeCache reloaded(dir.filePath(QStringLiteral("probecache")));
+    REQUIRE(reloaded.properties(path, "25/1") == properties);
+    REQUIRE(reloaded.fileHash(path) == QByteArray("hash"));
+
+    // A modified file must be probed again
+    REQUIRE(file.open(QIODevice::Append));
+    file.write(QByteArray(10, 'y'));
+    file.close();
+    REQUIRE(cache.properties(path, "25/1").isEmpty());
+    REQUIRE(cache.fileHash(path).isEmpty());
+
+    // Unknown files are not stored
+    const QString missing = QDir(dir.path()).absoluteFilePath(QStringLiteral("missing.mp4"));
+    cache.storeFileHash(missing, QByteArray("hash"));
+    REQUIRE(cache.fileHash(missing).isEmpty());
+}
@@ -80,3 +80,47 @@ TEST_CASE("Colorscope RGB/BGR handling")
         CHECK(rgbScope == bgrScope);
     }
 }
+
+// The scopes are computed in parallel on bands of lines, check that
+// all the lines are counted at the expected place
+TEST_CASE("Colorscope values")
+{
+    QImage inputImage(640, 480, QImage::Format_RGB32);
+    inputImage.fill(QColor(128, 128, 128));
+    QSize scopeSize{256, 256};
+
+    SECTION("Waveform of a uniform image is a single line")
+    {
+        WaveformGenerator waveform{};
+        QImage scope = waveform.calculateWaveform(scopeSize, inputImage, WaveformGenerator::PaintMode::PaintMode_White, false, ITURec::Rec_709, 1);
+        REQUIRE(scope.size() == scopeSize);
+        for (int y = 0; y < scope.height(); ++y) {
+            int alpha = qAlpha(scope.pixel(100, y));
+            if (y == scope.height() - 1 - 128) {
+                CHECK(alpha == 255);
+            } else {
+                CHECK(alpha == 0);
+            }
+        }
+    }
+
+    SECTION("Vectorscope of a gray image is a point at the center")
+    {
+        VectorscopeGenerator vectorscope{};
+        QImage scope = vectorscope.calculateVectorscope(scopeSize, inputImage, 1, VectorscopeGenerator::PaintMode::PaintMode_Black,
+                                                        VectorscopeGenerator::ColorSpace::ColorSpace_YUV, false, 1);
+        QPoint center = vectorscope.mapToCircle(scopeSize, QPointF(0, 0));
+        int hitPixels = 0;
+        for (int y = 0; y < scope.height(); ++y) {
+            for (int x = 0; x < scope.width(); ++x) {
+                if (qAlpha(scope.pixel(x, y)) > 0) {
+                    hitPixels++;
+                    CHECK(QPoint(x, y) == center);
+                }
+            }
+        }
+        CHECK(hitPixels == 1);
+        // The Black mode saturates after enough hits
+        CHECK(qAlpha(scope.pixel(center)) > 200);
+    }
+}
@@ -6,6 +6,7 @@
 #include "test_utils.hpp"
 // test specific headers
 #include "doc/documentchecker.h"
+#include "doc/documentindex.h"
 
 TEST_CASE("Basic tests of the document checker parts", "[DocumentChecker]")
 {
@@ -60,3 +61,29 @@ TEST_CASE("Missing project items", "[DocumentChecker]")
         CHECK(results.value(DocumentChecker::MissingType::Proxy) == 1);
     }
 }
+
+TEST_CASE("Document index", "[DocumentChecker]")
+{
+    QString path = sourcesPath + "/dataset/test-mix.kdenlive";
+    QDomDocument doc;
+    Xml::docContentFromFile(doc, path, false);
+    DocumentIndex index(doc);
+    CHECK_FALSE(index.isEmpty());
+
+    // The index lists the same elements as the document, in the same order
+    const QStringList tags = {QStringLiteral("mlt"),   QStringLiteral("producer"), QStringLiteral("chain"),  QStringLiteral("playlist"),
+                              QStringLiteral("entry"), QStringLiteral("tractor"),  QStringLiteral("filter"), QStringLiteral("transition")};
+    for (const QString &tag : tags) {
+        QDomNodeList nodes = doc.elementsByTagName(tag);
+        const QVector<QDomElement> &elements = index.elements(tag);
+        REQUIRE(elements.count() == nodes.count());
+        for (int i = 0; i < nodes.count(); ++i) {
+            CHECK(elements.at(i) == nodes.at(i).toElement());
+        }
+    }
+    CHECK(index.elements(QStringLiteral("property")).isEmpty());
+    CHECK(index.elements(QStringLiteral("unknown")).isEmpty());
+    CHECK(index.elementById(QStringLiteral("playlist"), QStringLiteral("main_bin")) == doc.documentElement().firstChildElement(QStringLiteral("playlist")));
+    CHECK(index.elementById(QStringLiteral("playlist"), QStringLiteral("unknown")).isNull());
+    CHECK(DocumentChecker::getAssetsServiceIds(index.elements(QStringLiteral("filter"))) == DocumentChecker::getAssetsServiceIds(doc, QStringLiteral("filter")));
+}
@@ -14,6 +14,7 @@
 
 #include "core.h"
 #include "definitions.h"
+#include "assets/model/assetparametermodel.hpp"
 #include "effects/effectsrepository.hpp"
 #include "effects/effectstack/model/effectitemmodel.hpp"
 #include "effects/effectstack/model/effectstackmodel.hpp"
@@ -105,6 +106,34 @@ TEST_CASE("Effects stack", "[Effects]")
         REQUIRE(clipModel->rowCount() == 0);
         REQUIRE(splitModel->rowCount() == 1);
     }
+
+    SECTION("Merge live parameter changes")
+    {
+        auto clipModel = timeline->getClipPtr(cid1)->m_effectStack;
+        REQUIRE(clipModel->appendEffect(anEffect));
+        std::shared_ptr<AssetParameterModel> effectModel = clipModel->getAssetModelById(anEffect);
+        QModelIndex ix = effectModel->getParamIndexFromName(QStringLiteral("u"));
+        const QString initial = effectModel->getParam(QStringLiteral("u"));
+
+        // Live values are only applied on the next frame, only the last one is used
+        effectModel->setLiveParameter(QStringLiteral("u"), QStringLiteral("100"), ix);
+        effectModel->setLiveParameter(QStringLiteral("u"), QStringLiteral("110"), ix);
+        REQUIRE(effectModel->m_liveTimer.isActive());
+        REQUIRE(effectModel->getParam(QStringLiteral("u")) == initial);
+        effectModel->applyLiveParameters();
+        REQUIRE(effectModel->getParam(QStringLiteral("u")) == QStringLiteral("110"));
+        REQUIRE(effectModel->m_liveValues.isEmpty());
+        // The timeline preview invalidation waits for the end of the drag
+        REQUIRE(effectModel->m_invalidateTimer.isActive());
+
+        // A final value discards the pending live values and invalidates immediately
+        effectModel->setLiveParameter(QStringLiteral("u"), QStringLiteral("120"), ix);
+        effectModel->setParameter(QStringLiteral("u"), QStringLiteral("130"), true, ix);
+        REQUIRE(effectModel->m_liveValues.isEmpty());
+        REQUIRE_FALSE(effectModel->m_invalidateTimer.isActive());
+        effectModel->applyLiveParameters();
+        REQUIRE(effectModel->getParam(QStringLiteral("u")) == QStringLiteral("130"));
+    }
     timeline.reset();
     clip.reset();
     pCore->projectManager()->closeCurrentDocument(false, false);
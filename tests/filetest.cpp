@@ -7,9 +7,13 @@
 // test specific headers
 #include "bin/binplaylist.hpp"
 #include "doc/kdenlivedoc.h"
+#include "project/archivewriter.h"
 #include "timeline2/model/builders/meltBuilder.hpp"
 #include "xml/xml.hpp"
 
+#include <KArchiveDirectory>
+#include <KTar>
+#include <QTemporaryDir>
 #include <QTemporaryFile>
 #include <QUndoGroup>
 
@@ -472,3 +476,125 @@ TEST_CASE("Opening File With Keyframes", "[OPENKFRS]")
         pCore->projectManager()->closeCurrentDocument(false, false);
     }
 }
+
+TEST_CASE("Bin clip effects", "[BINFX]")
+{
+    auto binModel = pCore->projectItemModel();
+    binModel->clean();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+
+    QTemporaryFile saveFile(QDir::temp().filePath("kdenlive_test_XXXXXX.kdenlive"));
+    REQUIRE(saveFile.open());
+    saveFile.close();
+
+    SECTION("Save and reload a bin effect used on two tracks")
+    {
+        {
+            KdenliveDoc document(undoStack);
+            pCore->projectManager()->m_project = &document;
+            QDateTime documentDate = QDateTime::currentDateTime();
+            pCore->projectManager()->updateTimeline(false, QString(), QString(), documentDate, 0);
+            auto timeline = document.getTimeline(document.uuid());
+            pCore->projectManager()->testSetActiveDocument(&document, timeline);
+
+            QString binId = createProducerWithSound(pCore->getProjectProfile(), binModel);
+            std::shared_ptr<ProjectClip> clip = binModel->getClipByBinID(binId);
+            REQUIRE(clip->m_effectStack->appendEffect(QStringLiteral("sepia")));
+            auto effect = std::static_pointer_cast<EffectItemModel>(clip->m_effectStack->getEffectStackRow(0));
+            effect->setParameter(QStringLiteral("u"), QStringLiteral("140"));
+
+            // Each video track gets its own track producer for the clip
+            int tid1 = timeline->getTrackIndexFromPosition(2);
+            int tid2 = timeline->getTrackIndexFromPosition(3);
+            int cid1 = -1;
+            int cid2 = -1;
+            REQUIRE(timeline->requestClipInsertion(binId, tid1, 0, cid1, true, true, false));
+            REQUIRE(timeline->requestClipInsertion(binId, tid2, 0, cid2, true, true, false));
+            REQUIRE(clip->m_videoProducers.size() == 2);
+            pCore->projectManager()->testSaveFileAs(saveFile.fileName());
+            pCore->projectManager()->closeCurrentDocument(false, false);
+        }
+        binModel->clean();
+
+        QUrl openURL = QUrl::fromLocalFile(saveFile.fileName());
+        QUndoGroup *undoGroup = new QUndoGroup();
+        undoGroup->addStack(undoStack.get());
+        DocOpenResult openResults = KdenliveDoc::Open(openURL, QDir::temp().path(), undoGroup, false, nullptr);
+        REQUIRE(openResults.isSuccessful() == true);
+        std::unique_ptr<KdenliveDoc> openedDoc = openResults.getDocument();
+
+        pCore->projectManager()->m_project = openedDoc.get();
+        const QUuid uuid = openedDoc->uuid();
+        QDateTime documentDate = QFileInfo(openURL.toLocalFile()).lastModified();
+        pCore->projectManager()->updateTimeline(false, QString(), QString(), documentDate, 0);
+        pCore->projectManager()->testSetActiveDocument(openedDoc.get());
+        auto timeline = pCore->projectManager()->m_project->getTimeline(uuid);
+        REQUIRE(timeline->checkConsistency());
+
+        int tid1 = timeline->getTrackIndexFromPosition(2);
+        int tid2 = timeline->getTrackIndexFromPosition(3);
+        int cid1 = timeline->getClipByStartPosition(tid1, 0);
+        int cid2 = timeline->getClipByStartPosition(tid2, 0);
+        REQUIRE(cid1 > -1);
+        REQUIRE(cid2 > -1);
+        std::shared_ptr<ProjectClip> clip = binModel->getClipByBinID(timeline->getClipBinId(cid1));
+        REQUIRE(clip->m_effectStack->rowCount() == 1);
+
+        // The effect must be back on the track producers of both tracks, with its parameters
+        REQUIRE(clip->m_videoProducers.size() == 2);
+        for (const auto &producer : clip->m_videoProducers) {
+            int found = 0;
+            for (int i = 0; i < producer.second->filter_count(); i++) {
+                std::unique_ptr<Mlt::Filter> filt(producer.second->filter(i));
+                if (QString(filt->get("kdenlive_id")) == QLatin1String("sepia")) {
+                    CHECK(filt->get_int("u") == 140);
+                    found++;
+                }
+            }
+            CHECK(found == 1);
+        }
+        pCore->projectManager()->closeCurrentDocument(false, false);
+    }
+}
+
+TEST_CASE("Archive writer", "[ARCHIVE]")
+{
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    QList<ArchiveWriter::Entry> entries;
+    const QList<QPair<QString, QByteArray>> files = {{QStringLiteral("a.txt"), QByteArray(100000, 'a')},
+                                                     {QStringLiteral("b.txt"), QByteArray(100000, 'a')},
+                                                     {QStringLiteral("c.txt"), QByteArray(100000, 'c')}};
+    for (const auto &f : files) {
+        QFile file(dir.filePath(f.first));
+        REQUIRE(file.open(QIODevice::WriteOnly));
+        file.write(f.second);
+        file.close();
+        entries.append({file.fileName(), QStringLiteral("clips/") + f.first});
+    }
+    const QString archivePath = dir.filePath(QStringLiteral("archive.tar.gz"));
+    KTar tar(archivePath, QStringLiteral("application/x-gzip"));
+    REQUIRE(tar.open(QIODevice::WriteOnly));
+    REQUIRE(tar.writeDir(QStringLiteral("clips"), QString(), QString()));
+    ArchiveWriter writer(&tar, QString(), QString());
+    writer.setDeduplicate(true);
+    int progress = 0;
+    REQUIRE(writer.addFiles(
+        entries, []() { return false; }, [&progress](int p) { progress = p; }));
+    REQUIRE(tar.close());
+    REQUIRE(progress == 100);
+    // b.txt has the same content as a.txt
+    REQUIRE(writer.duplicateCount() == 1);
+    REQUIRE(writer.checksums().count() == 3);
+
+    KTar reader(archivePath, QStringLiteral("application/x-gzip"));
+    REQUIRE(reader.open(QIODevice::ReadOnly));
+    QString error;
+    REQUIRE(ArchiveWriter::verify(&reader, writer.checksums(), &error));
+    REQUIRE(reader.directory()->entry(QStringLiteral("clips/b.txt"))->symLinkTarget() == QStringLiteral("a.txt"));
+    REQUIRE(reader.directory()->entry(QStringLiteral("clips/c.txt"))->isFile());
+
+    QMap<QString, QByteArray> corrupted = writer.checksums();
+    corrupted[QStringLiteral("clips/c.txt")] = ArchiveWriter::fileChecksum(entries.at(0).source);
+    REQUIRE_FALSE(ArchiveWriter::verify(&reader, corrupted, &error));
+}
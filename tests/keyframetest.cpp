@@ -268,6 +268,21 @@ TEST_CASE("Keyframe model", "[KeyframeModel]")
         undoStack->undo();
         state1(6.1);
     }
+    SECTION("Interpolated values")
+    {
+        REQUIRE(model->addKeyframe(GenTime(50, 25), KeyframeType::Linear, 42));
+        const QVector<QVariant> values = model->getInterpolatedValues(0, 60);
+        REQUIRE(values.size() == 61);
+        for (int frame = 0; frame <= 60; ++frame) {
+            REQUIRE(values.at(frame) == model->getInterpolatedValue(frame));
+        }
+        double midValue = model->getInterpolatedValue(25).toDouble();
+        // Changing a keyframe must invalidate the parsed curve
+        REQUIRE(model->updateKeyframe(GenTime(50, 25), 84));
+        REQUIRE(model->getInterpolatedValue(25).toDouble() > midValue);
+        REQUIRE(model->getInterpolatedValues(25, 25).first() == model->getInterpolatedValue(25));
+        REQUIRE(model->getInterpolatedValues(10, 5).isEmpty());
+    }
     clip.reset();
     timeline.reset();
     pCore->projectManager()->closeCurrentDocument(false, false);
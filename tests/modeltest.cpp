@@ -1123,6 +1123,27 @@ TEST_CASE("Clip manipulation", "[ClipModel]")
         REQUIRE(timeline->m_allClips[cid6]->binId() == timeline->m_allClips[newId]->binId());
         // TODO check effects
     }
+
+    SECTION("Position queries don't walk back further than needed")
+    {
+        REQUIRE(timeline->requestItemResize(cid5, 300, true) == 300);
+        REQUIRE(timeline->requestClipMove(cid1, tid1, 10));
+        REQUIRE(timeline->requestClipMove(cid2, tid1, 40));
+        REQUIRE(timeline->requestClipMove(cid3, tid1, 70));
+        REQUIRE(timeline->requestClipMove(cid5, tid1, 200));
+        REQUIRE(timeline->checkConsistency());
+        auto track = timeline->getTrackById(tid1);
+        REQUIRE(track->getClipsInRange(75, 80) == std::unordered_set<int>({cid3}));
+        REQUIRE(track->getClipByPosition(75) == cid3);
+
+        // Add a stale index entry before the other clips. On a track without mixes, the lookup
+        // stops after two clips ending before the position, so this entry is never reached
+        auto stale = track->m_clipPos.emplace(0, cid5);
+        CHECK(track->getClipsInRange(75, 80) == std::unordered_set<int>({cid3}));
+        CHECK(track->getClipByPosition(75) == cid3);
+        track->m_clipPos.erase(stale);
+        REQUIRE(timeline->checkConsistency());
+    }
     pCore->projectManager()->closeCurrentDocument(false, false);
 }
 
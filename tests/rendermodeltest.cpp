@@ -5,6 +5,7 @@
 #include "test_utils.hpp"
 // test specific headers
 #include "doc/kdenlivedoc.h"
+#include "kdenlivesettings.h"
 #include "render/renderrequest.h"
 #include "renderpresets/renderpresetmodel.hpp"
 #include "renderpresets/renderpresetrepository.hpp"
@@ -293,3 +294,67 @@ TEST_CASE("Tests of the render functions to use guides for sections", "[RenderRe
         CHECK(sections.at(2).out == out);
     }
 }
+
+TEST_CASE("Split the render range in segments", "[RenderRequestSegments]")
+{
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    std::shared_ptr<MarkerListModel> markerModel(new MarkerListModel(QString(), undoStack));
+    markerModel->loadCategories(KdenliveDoc::getDefaultGuideCategories());
+
+    RenderRequest *r = new RenderRequest();
+    r->m_presetParams.insert(QStringLiteral("g"), QStringLiteral("50"));
+    r->setGuideParams(markerModel, false, 1);
+    const QString ffmpegPath = KdenliveSettings::ffmpegpath();
+    KdenliveSettings::setFfmpegpath(QStringLiteral("ffmpeg"));
+
+    SECTION("Segmented rendering disabled")
+    {
+        r->setSegments(1);
+        CHECK(r->segmentBounds(0, 29999).isEmpty());
+    }
+
+    SECTION("No segments without FFmpeg to join them")
+    {
+        r->setSegments(4);
+        KdenliveSettings::setFfmpegpath(QString());
+        CHECK(r->segmentBounds(0, 29999).isEmpty());
+    }
+
+    SECTION("Audio only output is not split")
+    {
+        r->setSegments(4);
+        r->m_presetParams.insert(QStringLiteral("vn"), QStringLiteral("1"));
+        CHECK(r->segmentBounds(0, 29999).isEmpty());
+    }
+
+    SECTION("Range too short to be split")
+    {
+        r->setSegments(4);
+        CHECK(r->segmentBounds(0, 2000).isEmpty());
+    }
+
+    SECTION("Bounds are aligned on the GOP size")
+    {
+        r->setSegments(4);
+        QList<int> bounds = r->segmentBounds(0, 29999);
+        CHECK(bounds == QList<int>({7500, 15000, 22500}));
+        // Bounds are relative to the range start
+        bounds = r->segmentBounds(10, 30009);
+        CHECK(bounds == QList<int>({7510, 15010, 22510}));
+        for (int bound : qAsConst(bounds)) {
+            CHECK((bound - 10) % 50 == 0);
+        }
+    }
+
+    SECTION("Bounds snap to a close guide")
+    {
+        r->setSegments(4);
+        markerModel->addMarker(GenTime(7620, pCore->getCurrentFps()), QStringLiteral("scene"), 1);
+        // Too far from any bound
+        markerModel->addMarker(GenTime(11000, pCore->getCurrentFps()), QStringLiteral("scene"), 1);
+        QList<int> bounds = r->segmentBounds(0, 29999);
+        CHECK(bounds == QList<int>({7620, 15000, 22500}));
+    }
+    KdenliveSettings::setFfmpegpath(ffmpegPath);
+    delete r;
+}
@@ -216,6 +216,46 @@ TEST_CASE("Read subtitle file", "[Subtitles]")
         REQUIRE(subtitleModel->rowCount() == 0);
     }
 
+    SECTION("Only format the edited subtitles when writing the work file")
+    {
+        int subId = TimelineModel::getNextId();
+        int subId2 = TimelineModel::getNextId();
+        double fps = pCore->getCurrentFps();
+        auto readWorkFile = [subtitleModel]() {
+            QFile file(subtitleModel->getUrl());
+            file.open(QIODevice::ReadOnly);
+            return QString::fromUtf8(file.readAll());
+        };
+        REQUIRE(subtitleModel->addSubtitle(subId, GenTime(50, fps), GenTime(70, fps), QStringLiteral("Hello"), false, true));
+        REQUIRE(subtitleModel->addSubtitle(subId2, GenTime(100, fps), GenTime(140, fps), QStringLiteral("Second"), false, true));
+        // Both changes are written at once
+        REQUIRE(subtitleModel->m_fileDirty);
+        REQUIRE(subtitleModel->flushSubtitleFile());
+        REQUIRE_FALSE(subtitleModel->flushSubtitleFile());
+        QString content = readWorkFile();
+        CHECK(content.count(QStringLiteral(" --> ")) == 2);
+        CHECK(content.contains(QStringLiteral("\nHello\n")));
+        CHECK(content.contains(QStringLiteral("\nSecond\n")));
+
+        // Editing a subtitle doesn't format the other ones again
+        const QChar *unchanged = subtitleModel->m_formattedEntries.at(GenTime(100, fps)).block.constData();
+        REQUIRE(subtitleModel->editSubtitle(subId, QStringLiteral("Hello world")));
+        REQUIRE(subtitleModel->flushSubtitleFile());
+        CHECK(subtitleModel->m_formattedEntries.at(GenTime(100, fps)).block.constData() == unchanged);
+        content = readWorkFile();
+        CHECK(content.contains(QStringLiteral("\nHello world\n")));
+
+        // Removed subtitles are dropped and the others renumbered
+        REQUIRE(subtitleModel->removeSubtitle(subId));
+        REQUIRE(subtitleModel->flushSubtitleFile());
+        CHECK(subtitleModel->m_formattedEntries.size() == 1);
+        content = readWorkFile();
+        CHECK(content.startsWith(QStringLiteral("1\n")));
+        CHECK_FALSE(content.contains(QStringLiteral("Hello")));
+        subtitleModel->removeAllSubtitles();
+        REQUIRE(subtitleModel->rowCount() == 0);
+    }
+
     binModel->clean();
     pCore->m_projectManager = nullptr;
 }